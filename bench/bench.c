@@ -0,0 +1,184 @@
+#include "bench.h"
+
+#include "allocator.h"
+#include "array.h"
+#include "cpu_dispatch.h"
+
+#include <SDL2/SDL.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Calibration stops growing the iteration count past this.
+static const uint64_t MAX_ITERATIONS = 1ull << 32;
+
+typedef struct bench_result_t bench_result_t;
+
+struct bench_result_t
+{
+    char name[64];
+    uint64_t items;
+    uint32_t threads;
+    uint64_t iterations;
+    double median_ns;
+    double min_ns;
+};
+
+struct bench_o
+{
+    bench_settings_t settings;
+    /* array */ bench_result_t* results;
+    /* array */ double* samples;
+    double ticks_to_ns;
+};
+
+struct bench_o* bench_create(bench_settings_t settings)
+{
+    assert(settings.repetitions > 0);
+
+    struct bench_o* bench = mem_alloc(MEMORY_TAG_MISC, sizeof(struct bench_o));
+    bench->settings = settings;
+    bench->results = NULL;
+    bench->samples = NULL;
+    bench->ticks_to_ns = 1e9 / (double)SDL_GetPerformanceFrequency();
+    return bench;
+}
+
+void bench_destroy(struct bench_o* bench)
+{
+    assert(bench);
+    array_free(bench->results);
+    array_free(bench->samples);
+    mem_free(bench);
+}
+
+static double time_ns(const struct bench_o* bench, bench_desc_t desc, uint64_t iterations)
+{
+    const uint64_t start = SDL_GetPerformanceCounter();
+    desc.fn(desc.user, iterations);
+    return (double)(SDL_GetPerformanceCounter() - start) * bench->ticks_to_ns;
+}
+
+static int compare_doubles(const void* a, const void* b)
+{
+    const double x = *(const double*)a;
+    const double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+void bench_run(struct bench_o* bench, bench_desc_t desc)
+{
+    assert(bench && desc.name && desc.fn);
+
+    if (bench->settings.filter && !strstr(desc.name, bench->settings.filter))
+    {
+        return;
+    }
+
+    if (desc.setup)
+    {
+        const uint64_t items = desc.setup(desc.user);
+        desc.items = items > 0 ? items : desc.items;
+    }
+
+    // Double the iterations until a repetition is long enough for the timer to be meaningful.
+    const double min_ns = bench->settings.min_repetition_ms * 1e6;
+    uint64_t iterations = 1;
+    while (time_ns(bench, desc, iterations) < min_ns && iterations < MAX_ITERATIONS)
+    {
+        iterations *= 2;
+    }
+
+    for (uint32_t i = 0; i < bench->settings.warmup_repetitions; ++i)
+    {
+        time_ns(bench, desc, iterations);
+    }
+
+    array_clear(bench->samples);
+    for (uint32_t i = 0; i < bench->settings.repetitions; ++i)
+    {
+        array_push(bench->samples, time_ns(bench, desc, iterations) / (double)iterations);
+    }
+
+    const uint32_t n = array_size(bench->samples);
+    qsort(bench->samples, n, sizeof(double), compare_doubles);
+
+    if (desc.teardown)
+    {
+        desc.teardown(desc.user);
+    }
+
+    bench_result_t result = {
+        .items = desc.items,
+        .threads = desc.threads > 1 ? desc.threads : 1,
+        .iterations = iterations,
+        .median_ns = n % 2 ? bench->samples[n / 2] : 0.5 * (bench->samples[n/2 - 1] + bench->samples[n / 2]),
+        .min_ns = bench->samples[0],
+    };
+    snprintf(result.name, sizeof(result.name), "%s", desc.name);
+    array_push(bench->results, result);
+
+    printf("%-52s %14.1f ns %14.1f ns", result.name, result.median_ns, result.min_ns);
+    if (result.items > 0)
+    {
+        printf(" %12.2f M/s", (double)result.items / result.median_ns * 1e3);
+        if (result.threads > 1)
+        {
+            printf(" (%.2f M/s per thread)", (double)result.items / result.median_ns * 1e3 / result.threads);
+        }
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+void bench_write_json(const struct bench_o* bench, FILE* file)
+{
+    assert(bench && file);
+
+#ifdef NDEBUG
+    const char* build = "release";
+#else
+    const char* build = "debug";
+#endif
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"build\": \"%s\",\n", build);
+    fprintf(file, "  \"simd\": \"%s\",\n", cpu_dispatch_level_name(cpu_dispatch_level()));
+    fprintf(file, "  \"timestamp\": %lld,\n", (long long)time(NULL));
+    fprintf(file, "  \"repetitions\": %u,\n", bench->settings.repetitions);
+    fprintf(file, "  \"benchmarks\": [\n");
+
+    for (uint32_t i = 0; i < array_size(bench->results); ++i)
+    {
+        const bench_result_t* r = &bench->results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"iterations\": %llu, \"median_ns\": %.3f, \"min_ns\": %.3f",
+            r->name, (unsigned long long)r->iterations, r->median_ns, r->min_ns);
+        if (r->items > 0)
+        {
+            fprintf(file, ", \"items\": %llu, \"items_per_second\": %.1f",
+                (unsigned long long)r->items, (double)r->items / r->median_ns * 1e9);
+        }
+        if (r->items > 0 && r->threads > 1)
+        {
+            fprintf(file, ", \"threads\": %u, \"items_per_second_per_thread\": %.1f",
+                r->threads, (double)r->items / r->median_ns * 1e9 / r->threads);
+        }
+        fprintf(file, "}%s\n", i + 1 < array_size(bench->results) ? "," : "");
+    }
+
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+}
+
+void bench_use(const void* data)
+{
+    // An empty asm statement taking the pointer is opaque to the optimizer.
+#if defined(__GNUC__)
+    __asm__ volatile("" : : "r"(data) : "memory");
+#else
+    static const void* volatile sink;
+    sink = data;
+#endif
+}
@@ -0,0 +1,71 @@
+#ifndef BENCH_H_
+#define BENCH_H_
+
+// Microbenchmark harness.
+//
+// A benchmark is a function performing the measured operation a given number of times. The
+// harness first finds how many iterations make a repetition last at least the minimum time, runs
+// a few warm-up repetitions and then the measured ones. The median and the minimum time per
+// iteration over the repetitions are reported, the median being the number to compare between
+// builds and the minimum the best the machine can do.
+//
+// Results are printed as they come and can be written as JSON at the end, so two builds can be
+// compared by diffing their files.
+
+#include <stdint.h>
+#include <stdio.h>
+
+struct bench_o;
+
+// Performs the measured operation `iterations` times.
+typedef void (*bench_fn_t)(void* user, uint64_t iterations);
+
+typedef struct bench_desc_t bench_desc_t;
+
+struct bench_desc_t
+{
+    // `group/case`, used by the filter.
+    const char* name;
+    bench_fn_t fn;
+    void* user;
+    // Elements processed by one iteration (vectors, neutrons, voices...) to report a throughput.
+    uint64_t items;
+    // Threads sharing the work when more than one, the throughput is then also reported per
+    // thread.
+    uint32_t threads;
+    // Optional, only called when the benchmark passes the filter so expensive setups can be
+    // skipped. `setup` returns the elements processed per iteration when they are only known once
+    // set up, or 0 to keep `items`.
+    uint64_t (*setup)(void* user);
+    void (*teardown)(void* user);
+};
+
+typedef struct bench_settings_t bench_settings_t;
+
+struct bench_settings_t
+{
+    // Only the benchmarks whose name contains this string are run, all of them when NULL.
+    const char* filter;
+    uint32_t warmup_repetitions;
+    uint32_t repetitions;
+    double min_repetition_ms;
+};
+
+struct bench_o* bench_create(bench_settings_t);
+void bench_destroy(struct bench_o*);
+void bench_run(struct bench_o*, bench_desc_t);
+void bench_write_json(const struct bench_o*, FILE*);
+
+// Makes the compiler believe `data` is read so the computation producing it isn't removed.
+void bench_use(const void* data);
+
+// Benchmark groups, see `bench_*.c`.
+void bench_array(struct bench_o*);
+void bench_linalg(struct bench_o*);
+void bench_atom(struct bench_o*);
+void bench_render(struct bench_o*);
+void bench_image(struct bench_o*);
+void bench_audio(struct bench_o*);
+void bench_env(struct bench_o*);
+
+#endif // BENCH_H_
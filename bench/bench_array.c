@@ -0,0 +1,93 @@
+#include "bench.h"
+
+#include "array.h"
+
+#include <stdlib.h>
+
+// Elements handled by one iteration.
+enum { ARRAY_ELEMENTS = 4096 };
+
+typedef struct array_bench_t array_bench_t;
+
+struct array_bench_t
+{
+    /* array */ uint32_t* values;
+    // Random indices valid for an array shrinking from `ARRAY_ELEMENTS` to 0.
+    uint32_t remove_indices[ARRAY_ELEMENTS];
+};
+
+// Grows from an empty array every time, allocations included.
+static void push_grow(void* user, uint64_t iterations)
+{
+    (void)user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        uint32_t* values = NULL;
+        for (uint32_t i = 0; i < ARRAY_ELEMENTS; ++i)
+        {
+            array_push(values, i);
+        }
+        bench_use(values);
+        array_free(values);
+    }
+}
+
+static void push_reserved(void* user, uint64_t iterations)
+{
+    array_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        array_clear(b->values);
+        for (uint32_t i = 0; i < ARRAY_ELEMENTS; ++i)
+        {
+            array_push(b->values, i);
+        }
+        bench_use(b->values);
+    }
+}
+
+static void reserve(void* user, uint64_t iterations)
+{
+    (void)user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        uint32_t* values = NULL;
+        array_reserve(values, ARRAY_ELEMENTS);
+        bench_use(values);
+        array_free(values);
+    }
+}
+
+// Fills the array then empties it from random positions, the refill is part of the measure.
+static void remove_fast(void* user, uint64_t iterations)
+{
+    array_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        array_resize(b->values, ARRAY_ELEMENTS);
+        for (uint32_t i = 0; i < ARRAY_ELEMENTS; ++i)
+        {
+            array_remove_fast(b->values, b->remove_indices[i]);
+        }
+        bench_use(b->values);
+    }
+}
+
+void bench_array(struct bench_o* bench)
+{
+    static array_bench_t b = {0};
+
+    srand(49);
+    for (uint32_t i = 0; i < ARRAY_ELEMENTS; ++i)
+    {
+        b.remove_indices[i] = rand() % (ARRAY_ELEMENTS - i);
+    }
+    array_reserve(b.values, ARRAY_ELEMENTS);
+
+    bench_run(bench, (bench_desc_t){.name = "array/push_grow/4096", .fn = push_grow, .items = ARRAY_ELEMENTS});
+    bench_run(bench, (bench_desc_t){.name = "array/push_reserved/4096", .fn = push_reserved, .user = &b, .items = ARRAY_ELEMENTS});
+    bench_run(bench, (bench_desc_t){.name = "array/reserve/4096", .fn = reserve});
+    bench_run(bench, (bench_desc_t){.name = "array/remove_fast/4096", .fn = remove_fast, .user = &b, .items = ARRAY_ELEMENTS});
+
+    array_free(b.values);
+}
@@ -0,0 +1,173 @@
+#include "bench.h"
+
+#include "atom.h"
+#include "player.h"
+#include "tuning.h"
+#include "world.h"
+
+#include <stdio.h>
+
+// Chunks crossed by `stream_move` before going back to the start.
+static const uint32_t STREAM_MOVE_CHUNKS = 4096;
+
+typedef struct atom_bench_t atom_bench_t;
+
+struct atom_bench_t
+{
+    char name[64];
+    struct atom_system_o* atoms;
+    struct player_o* player;
+    world_t world;
+    chain_reaction_t chain;
+    uint32_t step;
+    float update_step_ms;
+};
+
+static uint64_t setup_systems(void* user)
+{
+    atom_bench_t* b = user;
+    b->atoms = atom_system_create();
+    b->player = player_create();
+    b->step = 0;
+    atom_system_reset(b->atoms, b->world);
+    atom_system_set_chain_reaction(b->atoms, b->chain);
+    atom_system_stream(b->atoms, (vec2_t){0, 0});
+    return 0;
+}
+
+static void teardown_systems(void* user)
+{
+    atom_bench_t* b = user;
+    atom_system_destroy(b->atoms);
+    player_destroy(b->player);
+}
+
+// Every active chunk generated from scratch, what a new game costs.
+static void stream(void* user, uint64_t iterations)
+{
+    atom_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        atom_system_reset(b->atoms, b->world);
+        atom_system_stream(b->atoms, (vec2_t){0, 0});
+    }
+}
+
+// The camera crossing a chunk border: a column is evicted and another one generated.
+static void stream_move(void* user, uint64_t iterations)
+{
+    atom_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        b->step = (b->step + 1) % STREAM_MOVE_CHUNKS;
+        atom_system_stream(b->atoms, (vec2_t){(b->step + 0.5f) * b->world.chunk_size, 0});
+    }
+}
+
+// Starts the neutron emission, the update is then measured with the neutrons of the first emission
+// flying away. They are slow enough for their number to barely change during the measure.
+static uint64_t setup_update(void* user)
+{
+    atom_bench_t* b = user;
+    setup_systems(b);
+    // Nothing is emitted during the preparation, the first emission happens on the update after.
+    for (float time_ms = 0; time_ms <= tuning_default().preparation_ms; time_ms += b->update_step_ms)
+    {
+        atom_system_update(b->atoms, b->player, b->update_step_ms);
+    }
+
+    const uint32_t num_neutrons = atom_system_num_neutrons(b->atoms);
+    printf("(%u chunks, %u atoms emitted %u neutrons)\n",
+        atom_system_num_active_chunks(b->atoms), atom_system_num_atoms(b->atoms), num_neutrons);
+    return num_neutrons;
+}
+
+static void update(void* user, uint64_t iterations)
+{
+    atom_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        atom_system_update(b->atoms, b->player, b->update_step_ms);
+    }
+}
+
+static void teardown_chain(void* user)
+{
+    atom_bench_t* b = user;
+    const atom_metrics_t metrics = atom_system_metrics(b->atoms);
+    printf("(%llu fissions, largest cascade %u, deepest %u, last update: %u tests, %u neutrons looked at)\n",
+        (unsigned long long)metrics.total_fissions, metrics.largest_cascade, metrics.deepest_cascade,
+        metrics.interaction_tests, metrics.neutron_events);
+    teardown_systems(user);
+}
+
+void bench_atom(struct bench_o* bench)
+{
+    // The game uses a radius of 1, larger ones stand for bigger screens or more atoms per area.
+    // Items are chunks generated per iteration.
+    static const int32_t stream_radii[] = {1, 4, 16};
+    // About 2.5 atoms per chunk and 4.5 neutrons per atom: half of them emit one neutron at a time,
+    // the other half eight.
+    static const int32_t update_radii[] = {2, 6, 20};
+    // The game runs at 60 UPS, collisions are swept so that slower machines can go down to 20.
+    static const uint32_t update_rates[] = {60, 20};
+    // About 10k atoms. Smaller worlds are all stable before the end of the measure.
+    static const int32_t chain_radii[] = {32};
+
+    for (uint32_t i = 0; i < sizeof(stream_radii) / sizeof(stream_radii[0]); ++i)
+    {
+        const int32_t radius = stream_radii[i];
+        atom_bench_t b = {.world = {.seed = 49, .chunk_size = 1024, .active_radius = radius}};
+
+        snprintf(b.name, sizeof(b.name), "atom/stream/radius_%d", radius);
+        bench_run(bench, (bench_desc_t){
+            .name = b.name, .fn = stream, .user = &b, .items = (2*radius + 1) * (2*radius + 1),
+            .setup = setup_systems, .teardown = teardown_systems});
+
+        snprintf(b.name, sizeof(b.name), "atom/stream_move/radius_%d", radius);
+        bench_run(bench, (bench_desc_t){
+            .name = b.name, .fn = stream_move, .user = &b, .items = 2*radius + 1,
+            .setup = setup_systems, .teardown = teardown_systems});
+    }
+
+    for (uint32_t r = 0; r < sizeof(update_rates) / sizeof(update_rates[0]); ++r)
+    {
+        for (uint32_t i = 0; i < sizeof(update_radii) / sizeof(update_radii[0]); ++i)
+        {
+            atom_bench_t b = {
+                .world = {.seed = 49, .chunk_size = 1024, .active_radius = update_radii[i]},
+                .update_step_ms = 1000.0f / update_rates[r],
+            };
+            if (update_rates[r] == 60)
+            {
+                snprintf(b.name, sizeof(b.name), "atom/update/radius_%d", update_radii[i]);
+            }
+            else
+            {
+                snprintf(b.name, sizeof(b.name), "atom/update_%uups/radius_%d", update_rates[r], update_radii[i]);
+            }
+            bench_run(bench, (bench_desc_t){
+                .name = b.name, .fn = update, .user = &b,
+                .setup = setup_update, .teardown = teardown_systems});
+        }
+    }
+
+    for (uint32_t i = 0; i < sizeof(chain_radii) / sizeof(chain_radii[0]); ++i)
+    {
+        atom_bench_t b = {
+            .world = {.seed = 49, .chunk_size = 1024, .active_radius = chain_radii[i]},
+            .chain = {
+                .enabled = true,
+                .cross_section = 120,
+                .fission_neutrons = 3,
+                .max_cascade_fissions = 64,
+                .max_cascade_depth = 8,
+            },
+            .update_step_ms = 1000.0f / 60,
+        };
+        snprintf(b.name, sizeof(b.name), "atom/update_chain/radius_%d", chain_radii[i]);
+        bench_run(bench, (bench_desc_t){
+            .name = b.name, .fn = update, .user = &b,
+            .setup = setup_update, .teardown = teardown_chain});
+    }
+}
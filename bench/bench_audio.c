@@ -0,0 +1,264 @@
+#include "bench.h"
+
+#include "audio_mix.h"
+#include "audio_stream.h"
+#include "cpu_dispatch.h"
+
+#include <SDL2/SDL.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// What the audio callback mixes for one buffer when every voice is playing.
+enum { AUDIO_VOICES = 64, AUDIO_FRAMES = 256 };
+
+typedef struct audio_bench_t audio_bench_t;
+
+struct audio_bench_t
+{
+    float f32_frames[AUDIO_VOICES][AUDIO_FRAMES * 2];
+    int16_t s16_frames[AUDIO_VOICES][AUDIO_FRAMES * 2];
+    audio_gain_ramp_t ramps[AUDIO_VOICES];
+    float bus[AUDIO_FRAMES * 2];
+    int16_t out[AUDIO_FRAMES * 2];
+};
+
+// Same steps as the callback in `audio.c`: clear, mix every voice, limit and convert for 16-bit
+// devices. The limiter always has something to do since 64 voices are well over the ceiling.
+static void limit_bus(audio_bench_t* b)
+{
+    const float peak = audio_mix_peak(b->bus, AUDIO_FRAMES);
+    audio_mix_limit(b->bus, AUDIO_FRAMES, 1.0f / peak, 0.0f, 0.8f);
+}
+
+static void mix_f32(void* user, uint64_t iterations)
+{
+    audio_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        memset(b->bus, 0, sizeof(b->bus));
+        for (uint32_t v = 0; v < AUDIO_VOICES; ++v)
+        {
+            audio_mix_f32(b->bus, b->f32_frames[v], AUDIO_FRAMES, b->ramps[v]);
+        }
+        limit_bus(b);
+        bench_use(b->bus);
+    }
+}
+
+static void mix_s16(void* user, uint64_t iterations)
+{
+    audio_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        memset(b->bus, 0, sizeof(b->bus));
+        for (uint32_t v = 0; v < AUDIO_VOICES; ++v)
+        {
+            audio_mix_s16(b->bus, b->s16_frames[v], AUDIO_FRAMES, b->ramps[v]);
+        }
+        limit_bus(b);
+        audio_mix_to_s16(b->out, b->bus, AUDIO_FRAMES);
+        bench_use(b->out);
+    }
+}
+
+// Streaming a WAV whose frames count themselves, with an intro, a `smpl` loop and frames after the
+// loop that must never play. The lengths are odd so that the wrap falls anywhere in the chunks and
+// in the read blocks of the stream.
+enum
+{
+    STREAM_FREQUENCY = 48000,
+    STREAM_INTRO_FRAMES = 1009,
+    STREAM_LOOP_FRAMES = 5003,
+    STREAM_TAIL_FRAMES = 211,
+    // About 2 s of audio, the loop wraps 19 times.
+    STREAM_CHECK_BUFFERS = 375,
+};
+
+static const char* STREAM_FILE = "bench_stream.wav";
+
+typedef struct stream_bench_t stream_bench_t;
+
+struct stream_bench_t
+{
+    float bus[AUDIO_FRAMES * 2];
+};
+
+static bool write_stream_file(void)
+{
+    SDL_RWops* file = SDL_RWFromFile(STREAM_FILE, "wb");
+    if (!file)
+    {
+        return false;
+    }
+
+    const uint32_t num_frames = STREAM_INTRO_FRAMES + STREAM_LOOP_FRAMES + STREAM_TAIL_FRAMES;
+    const uint32_t data_size = num_frames * 4;
+    const uint32_t fmt_size = 16;
+    const uint32_t smpl_size = 36 + 24;
+
+    SDL_RWwrite(file, "RIFF", 1, 4);
+    SDL_WriteLE32(file, 4 + (8 + fmt_size) + (8 + data_size) + (8 + smpl_size));
+    SDL_RWwrite(file, "WAVE", 1, 4);
+
+    SDL_RWwrite(file, "fmt ", 1, 4);
+    SDL_WriteLE32(file, fmt_size);
+    SDL_WriteLE16(file, 1); // PCM.
+    SDL_WriteLE16(file, 2);
+    SDL_WriteLE32(file, STREAM_FREQUENCY);
+    SDL_WriteLE32(file, STREAM_FREQUENCY * 4);
+    SDL_WriteLE16(file, 4);
+    SDL_WriteLE16(file, 16);
+
+    SDL_RWwrite(file, "data", 1, 4);
+    SDL_WriteLE32(file, data_size);
+    for (uint32_t i = 0; i < num_frames; ++i)
+    {
+        SDL_WriteLE16(file, (Uint16)(int16_t)i);
+        SDL_WriteLE16(file, (Uint16)(int16_t)-(int32_t)i);
+    }
+
+    // Sampler header then one loop, whose end is inclusive.
+    SDL_RWwrite(file, "smpl", 1, 4);
+    SDL_WriteLE32(file, smpl_size);
+    for (uint32_t i = 0; i < 7; ++i)
+    {
+        SDL_WriteLE32(file, 0);
+    }
+    SDL_WriteLE32(file, 1);
+    SDL_WriteLE32(file, 0);
+    SDL_WriteLE32(file, 0);
+    SDL_WriteLE32(file, 0);
+    SDL_WriteLE32(file, STREAM_INTRO_FRAMES);
+    SDL_WriteLE32(file, STREAM_INTRO_FRAMES + STREAM_LOOP_FRAMES - 1);
+    SDL_WriteLE32(file, 0);
+    SDL_WriteLE32(file, 0);
+
+    return SDL_RWclose(file) == 0;
+}
+
+// Plays the stream like the callback would, about 5 times faster than real time, and checks every
+// frame: the intro plays once, then the loop forever without a gap at the wrap.
+static void check_stream(stream_bench_t* b)
+{
+    struct audio_stream_o* stream = audio_stream_open(STREAM_FILE, STREAM_FREQUENCY);
+    if (!stream)
+    {
+        return;
+    }
+
+    const audio_gain_ramp_t unity = audio_gain_ramp(1.0f, 1.0f, 1.0f, 1.0f, AUDIO_FRAMES);
+    uint32_t position = 0;
+    uint32_t wrong_frames = 0;
+    for (uint32_t buffer = 0; buffer < STREAM_CHECK_BUFFERS; ++buffer)
+    {
+        memset(b->bus, 0, sizeof(b->bus));
+        audio_stream_mix(stream, b->bus, AUDIO_FRAMES, unity);
+
+        for (uint32_t i = 0; i < AUDIO_FRAMES; ++i, ++position)
+        {
+            const uint32_t frame = position < STREAM_INTRO_FRAMES
+                ? position
+                : STREAM_INTRO_FRAMES + (position - STREAM_INTRO_FRAMES) % STREAM_LOOP_FRAMES;
+            const float expected = (float)frame / 32768;
+            wrong_frames += b->bus[2*i] != expected || b->bus[2*i + 1] != -expected;
+        }
+
+        SDL_Delay(1);
+    }
+
+    const uint32_t underruns = audio_stream_underruns(stream);
+    audio_stream_close(stream);
+
+    printf("(loop wrapped %u times, %u wrong frames, %u underruns)\n",
+        (position - STREAM_INTRO_FRAMES) / STREAM_LOOP_FRAMES, wrong_frames, underruns);
+    if (wrong_frames > 0 || underruns > 0)
+    {
+        printf("Streaming '%s' doesn't play back what it contains.\n", STREAM_FILE);
+    }
+}
+
+static uint64_t setup_stream(void* user)
+{
+    if (!write_stream_file())
+    {
+        printf("Couldn't write '%s': %s\n", STREAM_FILE, SDL_GetError());
+        return 0;
+    }
+
+    check_stream(user);
+    return 0;
+}
+
+static void teardown_stream(void* user)
+{
+    (void)user;
+    // The file stays open until the threads of the closed streams are done with it.
+    audio_stream_wait_all_closed();
+    remove(STREAM_FILE);
+}
+
+// What starting a music costs the loading thread: parsing the file, prefilling every chunk and
+// starting the streaming thread, which the close lets go.
+static void stream_open(void* user, uint64_t iterations)
+{
+    (void)user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        struct audio_stream_o* stream = audio_stream_open(STREAM_FILE, STREAM_FREQUENCY);
+        bench_use(stream);
+        if (stream)
+        {
+            audio_stream_close(stream);
+        }
+    }
+}
+
+void bench_audio(struct bench_o* bench)
+{
+    static audio_bench_t b;
+
+    srand(49);
+    for (uint32_t v = 0; v < AUDIO_VOICES; ++v)
+    {
+        for (uint32_t i = 0; i < AUDIO_FRAMES * 2; ++i)
+        {
+            b.s16_frames[v][i] = (int16_t)(rand() % 65536 - 32768);
+            b.f32_frames[v][i] = b.s16_frames[v][i] / 32768.0f;
+        }
+        const float gain = (float)(v + 1) / AUDIO_VOICES;
+        b.ramps[v] = audio_gain_ramp(gain, 1.0f - gain, 1.0f - gain, gain, AUDIO_FRAMES);
+    }
+
+    // Items are voices so the throughput reads in voices per microsecond. Levels without their own
+    // mixing kernels use the ones of the level below, those are only measured once.
+    const char* previous_kernels = NULL;
+    for (enum SimdLevel level = 0; level < _SIMD_LEVEL_COUNT; ++level)
+    {
+        if (!cpu_dispatch_supported(level))
+        {
+            continue;
+        }
+        audio_mix_select(level);
+        if (previous_kernels && strcmp(previous_kernels, audio_mix_name()) == 0)
+        {
+            continue;
+        }
+        previous_kernels = audio_mix_name();
+
+        char f32_name[64];
+        char s16_name[64];
+        snprintf(f32_name, sizeof(f32_name), "audio/mix_f32/64x256/%s", audio_mix_name());
+        snprintf(s16_name, sizeof(s16_name), "audio/mix_s16/64x256/%s", audio_mix_name());
+
+        bench_run(bench, (bench_desc_t){.name = f32_name, .fn = mix_f32, .user = &b, .items = AUDIO_VOICES});
+        bench_run(bench, (bench_desc_t){.name = s16_name, .fn = mix_s16, .user = &b, .items = AUDIO_VOICES});
+    }
+    audio_mix_select(cpu_dispatch_level());
+
+    static stream_bench_t stream;
+    bench_run(bench, (bench_desc_t){
+        .name = "audio/stream_open/16bit_stereo", .fn = stream_open, .user = &stream,
+        .setup = setup_stream, .teardown = teardown_stream});
+}
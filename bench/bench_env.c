@@ -0,0 +1,106 @@
+#include "bench.h"
+
+#include "allocator.h"
+#include "batch_env.h"
+
+#include <SDL2/SDL.h>
+
+#include <math.h>
+#include <stdio.h>
+
+typedef struct env_bench_t env_bench_t;
+
+struct env_bench_t
+{
+    char name[64];
+    batch_env_config_t config;
+    struct batch_env_o* env;
+    float* cursor_x;
+    float* cursor_y;
+    uint8_t* button;
+};
+
+// Every bot holds the button with the cursor at a fixed place around the screen center, the camera
+// follows so it keeps heading the same way through new chunks until it dies.
+static uint64_t setup_env(void* user)
+{
+    env_bench_t* b = user;
+    const uint32_t n = b->config.num_instances;
+
+    b->env = batch_env_create(b->config);
+    b->cursor_x = mem_alloc(MEMORY_TAG_MISC, n * sizeof(float));
+    b->cursor_y = mem_alloc(MEMORY_TAG_MISC, n * sizeof(float));
+    b->button = mem_alloc(MEMORY_TAG_MISC, n * sizeof(uint8_t));
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        const float angle = 2.399963f * i; // Golden angle.
+        b->cursor_x[i] = b->config.viewport.x / 2 + 300 * cosf(angle);
+        b->cursor_y[i] = b->config.viewport.y / 2 + 300 * sinf(angle);
+        b->button[i] = 1;
+    }
+
+    // Neutrons are only emitted after the preparation, the measure starts once they fly.
+    const batch_env_actions_t actions = {b->cursor_x, b->cursor_y, b->button};
+    for (float time_ms = 0; time_ms <= b->config.tuning.preparation_ms; time_ms += b->config.step_ms)
+    {
+        batch_env_step(b->env, actions);
+    }
+
+    printf("(%u instances on %u threads)\n", n, batch_env_num_threads(b->env));
+    return 0;
+}
+
+static void teardown_env(void* user)
+{
+    env_bench_t* b = user;
+    const batch_env_stats_t stats = batch_env_stats(b->env);
+    printf("(%llu steps, %llu episodes: %llu deaths, %llu wins, %llu timeouts)\n",
+        (unsigned long long)stats.steps, (unsigned long long)stats.episodes,
+        (unsigned long long)stats.deaths, (unsigned long long)stats.wins,
+        (unsigned long long)stats.timeouts);
+
+    batch_env_destroy(b->env);
+    mem_free(b->cursor_x);
+    mem_free(b->cursor_y);
+    mem_free(b->button);
+}
+
+static void step(void* user, uint64_t iterations)
+{
+    env_bench_t* b = user;
+    const batch_env_actions_t actions = {b->cursor_x, b->cursor_y, b->button};
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        const batch_env_results_t results = batch_env_step(b->env, actions);
+        bench_use(results.observations);
+    }
+}
+
+void bench_env(struct bench_o* bench)
+{
+    // Items are instance steps, the throughput per thread is the one to compare between machines.
+    static const uint32_t num_instances = 1024;
+    const uint32_t num_cpus = SDL_GetCPUCount() > 1 ? (uint32_t)SDL_GetCPUCount() : 1;
+    const uint32_t thread_counts[] = {1, num_cpus};
+    const uint32_t num_thread_counts = num_cpus > 1 ? 2 : 1;
+
+    for (uint32_t i = 0; i < num_thread_counts; ++i)
+    {
+        // Same world, chain reactions and rules as the game.
+        env_bench_t b = {
+            .config = {
+                .num_instances = num_instances,
+                .num_workers = thread_counts[i] - 1,
+                .seed = 49,
+                .tuning = tuning_default(),
+                .viewport = {1280, 720},
+                .step_ms = 1000.0f / 60,
+                .max_episode_steps = 60 * 60,
+            },
+        };
+        snprintf(b.name, sizeof(b.name), "env/step/instances_%u_threads_%u", num_instances, thread_counts[i]);
+        bench_run(bench, (bench_desc_t){
+            .name = b.name, .fn = step, .user = &b, .items = num_instances, .threads = thread_counts[i],
+            .setup = setup_env, .teardown = teardown_env});
+    }
+}
@@ -0,0 +1,127 @@
+#include "bench.h"
+
+#include "allocator.h"
+#include "qoi.h"
+
+#include <SDL2/SDL.h>
+
+#include <stdio.h>
+#include <string.h>
+
+// Real assets, run the benchmark from the root of the repository. A photo-like background and a
+// flat button, the two kinds of images the game has.
+static const char* IMAGE_FILES[] = {
+    "assets/images/background.bmp",
+    "assets/images/play_button.bmp",
+};
+
+enum { NUM_IMAGE_FILES = sizeof(IMAGE_FILES) / sizeof(IMAGE_FILES[0]) };
+
+typedef struct image_bench_t image_bench_t;
+
+struct image_bench_t
+{
+    const char* file;
+    char bmp_name[64];
+    char qoi_name[64];
+
+    // Files in memory so that only the decoding is measured, the QOI is encoded from the BMP.
+    void* bmp;
+    size_t bmp_size;
+    void* qoi;
+    size_t qoi_size;
+
+    // Decoded pixels, `ARGB8888` for both formats.
+    uint32_t* pixels;
+    uint32_t width;
+    uint32_t height;
+};
+
+static uint64_t setup_image(void* user)
+{
+    image_bench_t* b = user;
+
+    SDL_RWops* rw = SDL_RWFromFile(b->file, "rb");
+    b->bmp_size = (size_t)SDL_RWsize(rw);
+    b->bmp = mem_alloc(MEMORY_TAG_MISC, b->bmp_size);
+    SDL_RWread(rw, b->bmp, b->bmp_size, 1);
+    SDL_RWclose(rw);
+
+    SDL_Surface* loaded = SDL_LoadBMP_RW(SDL_RWFromConstMem(b->bmp, (int)b->bmp_size), 1);
+    SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(loaded);
+
+    b->width = (uint32_t)surface->w;
+    b->height = (uint32_t)surface->h;
+    b->pixels = mem_alloc(MEMORY_TAG_MISC, (size_t)b->width * b->height * sizeof(uint32_t));
+    // Opaque images encode the same either way, only the header differs.
+    const qoi_desc_t desc = {.width = b->width, .height = b->height, .channels = 4, .colorspace = 0};
+    b->qoi = qoi_encode(surface->pixels, (uint32_t)surface->pitch, desc, &b->qoi_size);
+    SDL_FreeSurface(surface);
+
+    printf("(%ux%u, %zu bytes as BMP, %zu as QOI)\n", b->width, b->height, b->bmp_size, b->qoi_size);
+    return (uint64_t)b->width * b->height;
+}
+
+static void teardown_image(void* user)
+{
+    image_bench_t* b = user;
+    mem_free(b->bmp);
+    mem_free(b->qoi);
+    mem_free(b->pixels);
+}
+
+// What the game did before: the BMP is loaded in its own layout, converted before the upload by
+// `SDL_CreateTextureFromSurface`.
+static void decode_bmp(void* user, uint64_t iterations)
+{
+    image_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        SDL_Surface* loaded = SDL_LoadBMP_RW(SDL_RWFromConstMem(b->bmp, (int)b->bmp_size), 1);
+        SDL_ConvertPixels(
+            loaded->w, loaded->h, loaded->format->format, loaded->pixels, loaded->pitch,
+            SDL_PIXELFORMAT_ARGB8888, b->pixels, (int)b->width * 4);
+        SDL_FreeSurface(loaded);
+        bench_use(b->pixels);
+    }
+}
+
+static void decode_qoi(void* user, uint64_t iterations)
+{
+    image_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        qoi_decode(b->qoi, b->qoi_size, b->pixels, b->width * 4);
+        bench_use(b->pixels);
+    }
+}
+
+void bench_image(struct bench_o* bench)
+{
+    // Items are pixels, the throughput reads in megapixels per second.
+    static image_bench_t benches[NUM_IMAGE_FILES];
+
+    for (uint32_t i = 0; i < NUM_IMAGE_FILES; ++i)
+    {
+        image_bench_t* b = &benches[i];
+        b->file = IMAGE_FILES[i];
+
+        SDL_RWops* rw = SDL_RWFromFile(b->file, "rb");
+        if (!rw)
+        {
+            printf("Skipping '%s', run from the root of the repository.\n", b->file);
+            continue;
+        }
+        SDL_RWclose(rw);
+
+        const char* name = strrchr(b->file, '/') + 1;
+        snprintf(b->bmp_name, sizeof(b->bmp_name), "image/decode_bmp/%.*s", (int)(strlen(name) - 4), name);
+        snprintf(b->qoi_name, sizeof(b->qoi_name), "image/decode_qoi/%.*s", (int)(strlen(name) - 4), name);
+
+        bench_run(bench, (bench_desc_t){
+            .name = b->bmp_name, .fn = decode_bmp, .user = b, .setup = setup_image, .teardown = teardown_image});
+        bench_run(bench, (bench_desc_t){
+            .name = b->qoi_name, .fn = decode_qoi, .user = b, .setup = setup_image, .teardown = teardown_image});
+    }
+}
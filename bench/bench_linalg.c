@@ -0,0 +1,169 @@
+#include "bench.h"
+
+#include "linalg.h"
+
+#include <stdlib.h>
+
+// Elements handled by one iteration.
+enum { LINALG_ELEMENTS = 1024 };
+
+typedef struct linalg_bench_t linalg_bench_t;
+
+struct linalg_bench_t
+{
+    vec2_t a[LINALG_ELEMENTS];
+    vec2_t b[LINALG_ELEMENTS];
+    vec2_t out[LINALG_ELEMENTS];
+    float angles[LINALG_ELEMENTS];
+    float sines[LINALG_ELEMENTS];
+    float cosines[LINALG_ELEMENTS];
+    mat3_t matrices[LINALG_ELEMENTS];
+    mat3_t out_matrices[LINALG_ELEMENTS];
+};
+
+static float random_float(float min, float max)
+{
+    return min + (max - min) * ((float)rand() / RAND_MAX);
+}
+
+static void vec2_add_bench(void* user, uint64_t iterations)
+{
+    linalg_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        for (uint32_t i = 0; i < LINALG_ELEMENTS; ++i) b->out[i] = vec2_add(b->a[i], b->b[i]);
+        bench_use(b->out);
+    }
+}
+
+static void vec2_normalize_bench(void* user, uint64_t iterations)
+{
+    linalg_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        for (uint32_t i = 0; i < LINALG_ELEMENTS; ++i) b->out[i] = vec2_normalize(b->a[i]);
+        bench_use(b->out);
+    }
+}
+
+static void vec2_dist_bench(void* user, uint64_t iterations)
+{
+    linalg_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        for (uint32_t i = 0; i < LINALG_ELEMENTS; ++i) b->sines[i] = vec2_dist(b->a[i], b->b[i]);
+        bench_use(b->sines);
+    }
+}
+
+static void vec2_rotate_bench(void* user, uint64_t iterations)
+{
+    linalg_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        for (uint32_t i = 0; i < LINALG_ELEMENTS; ++i) b->out[i] = vec2_rotate(b->a[i], b->angles[i]);
+        bench_use(b->out);
+    }
+}
+
+static void vec2_rotate_fast_bench(void* user, uint64_t iterations)
+{
+    linalg_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        for (uint32_t i = 0; i < LINALG_ELEMENTS; ++i) b->out[i] = vec2_rotate_fast(b->a[i], b->angles[i]);
+        bench_use(b->out);
+    }
+}
+
+static void fast_sincosf_bench(void* user, uint64_t iterations)
+{
+    linalg_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        for (uint32_t i = 0; i < LINALG_ELEMENTS; ++i) fast_sincosf(b->angles[i], &b->sines[i], &b->cosines[i]);
+        bench_use(b->sines);
+        bench_use(b->cosines);
+    }
+}
+
+static void approx_sincosf_bench(void* user, uint64_t iterations)
+{
+    linalg_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        for (uint32_t i = 0; i < LINALG_ELEMENTS; ++i) approx_sincosf(b->angles[i], &b->sines[i], &b->cosines[i]);
+        bench_use(b->sines);
+        bench_use(b->cosines);
+    }
+}
+
+static void mat3_mul_vec_bench(void* user, uint64_t iterations)
+{
+    linalg_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        for (uint32_t i = 0; i < LINALG_ELEMENTS; ++i)
+        {
+            b->out[i] = vec3_xy(mat3_mul_vec(b->matrices[i], (vec3_t){b->a[i].x, b->a[i].y, 1}));
+        }
+        bench_use(b->out);
+    }
+}
+
+static void mat3_mul_bench(void* user, uint64_t iterations)
+{
+    linalg_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        for (uint32_t i = 0; i < LINALG_ELEMENTS; ++i)
+        {
+            b->out_matrices[i] = mat3_mul(b->matrices[i], b->matrices[LINALG_ELEMENTS - 1 - i]);
+        }
+        bench_use(b->out_matrices);
+    }
+}
+
+static void mat3_inverse_bench(void* user, uint64_t iterations)
+{
+    linalg_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        for (uint32_t i = 0; i < LINALG_ELEMENTS; ++i) b->out_matrices[i] = mat3_inverse(b->matrices[i]);
+        bench_use(b->out_matrices);
+    }
+}
+
+void bench_linalg(struct bench_o* bench)
+{
+    static linalg_bench_t b;
+
+    srand(49);
+    for (uint32_t i = 0; i < LINALG_ELEMENTS; ++i)
+    {
+        b.a[i] = (vec2_t){random_float(-1000, 1000), random_float(-1000, 1000)};
+        b.b[i] = (vec2_t){random_float(-1000, 1000), random_float(-1000, 1000)};
+        b.angles[i] = random_float(-2*PI_f, 2*PI_f);
+        b.matrices[i] = mat3_mul(
+            mat3_translation(random_float(-1000, 1000), random_float(-1000, 1000)),
+            mat3_mul(mat3_rotation(b.angles[i]), mat3_scaling(random_float(0.5f, 2.0f))));
+    }
+
+    const struct { const char* name; bench_fn_t fn; } cases[] = {
+        {"linalg/vec2_add/1024", vec2_add_bench},
+        {"linalg/vec2_normalize/1024", vec2_normalize_bench},
+        {"linalg/vec2_dist/1024", vec2_dist_bench},
+        {"linalg/vec2_rotate/1024", vec2_rotate_bench},
+        {"linalg/vec2_rotate_fast/1024", vec2_rotate_fast_bench},
+        {"linalg/fast_sincosf/1024", fast_sincosf_bench},
+        {"linalg/approx_sincosf/1024", approx_sincosf_bench},
+        {"linalg/mat3_mul_vec/1024", mat3_mul_vec_bench},
+        {"linalg/mat3_mul/1024", mat3_mul_bench},
+        {"linalg/mat3_inverse/1024", mat3_inverse_bench},
+    };
+
+    for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        bench_run(bench, (bench_desc_t){.name = cases[i].name, .fn = cases[i].fn, .user = &b, .items = LINALG_ELEMENTS});
+    }
+}
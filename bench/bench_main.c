@@ -0,0 +1,102 @@
+#include "bench.h"
+
+#include "cpu_dispatch.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void print_usage(const char* program)
+{
+    printf(
+        "Usage: %s [options]\n"
+        "\n"
+        "  --filter <string>    only run the benchmarks whose name contains the string\n"
+        "  --json <file>        write the results to a JSON file\n"
+        "  --repetitions <n>    measured repetitions per benchmark (default 15)\n"
+        "  --warmup <n>         warm-up repetitions per benchmark (default 3)\n"
+        "  --min-time-ms <ms>   minimum duration of a repetition (default 20)\n",
+        program);
+}
+
+int main(int argc, char* argv[])
+{
+    bench_settings_t settings = {
+        .filter = NULL,
+        .warmup_repetitions = 3,
+        .repetitions = 15,
+        .min_repetition_ms = 20.0,
+    };
+    const char* json_path = NULL;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--filter") == 0 && has_value)
+        {
+            settings.filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--json") == 0 && has_value)
+        {
+            json_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--repetitions") == 0 && has_value)
+        {
+            settings.repetitions = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--warmup") == 0 && has_value)
+        {
+            settings.warmup_repetitions = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--min-time-ms") == 0 && has_value)
+        {
+            settings.min_repetition_ms = strtod(argv[++i], NULL);
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    if (settings.repetitions == 0)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // The simulation doesn't need the SDL to be initialized, only the timer of the harness is used.
+    cpu_dispatch_init();
+
+    struct bench_o* bench = bench_create(settings);
+
+    printf("%-52s %17s %17s %14s\n", "benchmark", "median", "min", "throughput");
+    bench_array(bench);
+    bench_linalg(bench);
+    bench_atom(bench);
+    bench_render(bench);
+    bench_image(bench);
+    bench_audio(bench);
+    bench_env(bench);
+
+    int result = 0;
+    if (json_path)
+    {
+        FILE* file = fopen(json_path, "w");
+        if (file)
+        {
+            bench_write_json(bench, file);
+            fclose(file);
+        }
+        else
+        {
+            printf("Error opening '%s' for writing.\n", json_path);
+            result = 1;
+        }
+    }
+
+    bench_destroy(bench);
+
+    return result;
+}
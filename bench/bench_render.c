@@ -0,0 +1,90 @@
+#include "bench.h"
+
+#include "camera.h"
+#include "linalg.h"
+#include "linalg_batch.h"
+#include "render.h"
+
+#include <stdlib.h>
+
+// Rects built by one iteration, about the number of sprites of a busy level.
+enum { RENDER_RECTS = 1024 };
+
+typedef struct render_bench_t render_bench_t;
+
+struct render_bench_t
+{
+    struct camera_o* camera;
+    vec2_t positions[RENDER_RECTS];
+    float x[RENDER_RECTS];
+    float y[RENDER_RECTS];
+    float screen_x[RENDER_RECTS];
+    float screen_y[RENDER_RECTS];
+    SDL_Rect rects[RENDER_RECTS];
+};
+
+static void rect_from_pos_and_size(void* user, uint64_t iterations)
+{
+    render_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        for (uint32_t i = 0; i < RENDER_RECTS; ++i)
+        {
+            b->rects[i] = sdl_rect_from_pos_and_size(b->camera, b->positions[i], (vec2_t){8, 8});
+        }
+        bench_use(b->rects);
+    }
+}
+
+static void rect_from_pos_and_size_with_scale(void* user, uint64_t iterations)
+{
+    render_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        for (uint32_t i = 0; i < RENDER_RECTS; ++i)
+        {
+            b->rects[i] = sdl_rect_from_pos_and_size_with_scale(b->camera, b->positions[i], (vec2_t){100, 100}, 1.2f);
+        }
+        bench_use(b->rects);
+    }
+}
+
+// What the presentation does for neutrons: one batch transform then the rects from the centers.
+static void rect_batch_transform(void* user, uint64_t iterations)
+{
+    render_bench_t* b = user;
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        batch_transform(b->screen_x, b->screen_y, b->x, b->y, camera_world_to_screen_matrix(b->camera), RENDER_RECTS);
+        for (uint32_t i = 0; i < RENDER_RECTS; ++i)
+        {
+            b->rects[i] = (SDL_Rect){.x = b->screen_x[i] - 8, .y = b->screen_y[i] - 8, .w = 16, .h = 16};
+        }
+        bench_use(b->rects);
+    }
+}
+
+void bench_render(struct bench_o* bench)
+{
+    static render_bench_t b;
+
+    b.camera = camera_create((vec2_t){100, -50}, (vec2_t){1280, 720});
+
+    srand(49);
+    for (uint32_t i = 0; i < RENDER_RECTS; ++i)
+    {
+        b.positions[i] = (vec2_t){(float)(rand() % 1600 - 800), (float)(rand() % 1200 - 600)};
+        b.x[i] = b.positions[i].x;
+        b.y[i] = b.positions[i].y;
+    }
+
+    bench_run(bench, (bench_desc_t){
+        .name = "render/sdl_rect_from_pos_and_size/1024", .fn = rect_from_pos_and_size, .user = &b, .items = RENDER_RECTS});
+    bench_run(bench, (bench_desc_t){
+        .name = "render/sdl_rect_from_pos_and_size_with_scale/1024", .fn = rect_from_pos_and_size_with_scale,
+        .user = &b, .items = RENDER_RECTS});
+    bench_run(bench, (bench_desc_t){
+        .name = "render/batch_transform_rects/1024", .fn = rect_batch_transform, .user = &b, .items = RENDER_RECTS});
+
+    camera_destroy(b.camera);
+}
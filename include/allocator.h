@@ -0,0 +1,62 @@
+#ifndef ALLOCATOR_H_
+#define ALLOCATOR_H_
+
+// Instrumented heap allocation.
+//
+// Every allocation is tagged with the subsystem owning it so that live, peak and total bytes can
+// be tracked per subsystem. `array.h` allocates with the tag on top of the current thread tag
+// stack (see `mem_push_tag`), the `*_create` functions allocate with their own tag.
+//
+// In debug builds, a no-allocation scope can be opened with `mem_forbid_begin`. Any allocation
+// performed on the same thread before the matching `mem_forbid_end` asserts. It is used to enforce
+// that the per-tick hot path never allocates once the game is warmed up. In release builds these
+// two functions do nothing.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// @Note: the enum values must be sequential starting at 0 because they map to an array.
+enum MemoryTag
+{
+    MEMORY_TAG_MISC = 0,
+    MEMORY_TAG_ATOM,
+    MEMORY_TAG_PLAYER,
+    MEMORY_TAG_CAMERA,
+    MEMORY_TAG_AUDIO,
+    MEMORY_TAG_DISPLAY,
+
+    _MEMORY_TAG_COUNT, // This *MUST* appear last in the enum.
+};
+
+typedef struct mem_stats_t mem_stats_t;
+
+struct mem_stats_t
+{
+    size_t live_bytes;
+    size_t peak_bytes;
+    size_t total_bytes; // Cumulated bytes ever allocated.
+    uint64_t num_allocs; // Includes reallocations.
+    uint64_t num_frees;
+};
+
+void* mem_alloc(enum MemoryTag, size_t size);
+// Reallocations keep the tag of the original allocation. The tag is only used when `ptr` is NULL.
+void* mem_realloc(enum MemoryTag, void* ptr, size_t size);
+void mem_free(void* ptr);
+
+// Thread local stack of tags used by allocations which don't specify one (`array.h`).
+void mem_push_tag(enum MemoryTag);
+void mem_pop_tag(void);
+enum MemoryTag mem_current_tag(void);
+
+mem_stats_t mem_stats(enum MemoryTag);
+mem_stats_t mem_stats_total(void);
+const char* mem_tag_name(enum MemoryTag);
+void mem_report(FILE*);
+
+// No-allocation scopes can be nested. `name` is reported when the assertion fires.
+void mem_forbid_begin(const char* name);
+void mem_forbid_end(void);
+
+#endif // ALLOCATOR_H_
@@ -57,6 +57,11 @@
 // Returns pointer the the first element past the end of the array. It can be used
 // to easily iterate over the array element in a for..each manner.
 //
+// == Memory ==
+//
+// Storage is allocated through `allocator.h`. A new array is tagged with the current thread tag
+// (see `mem_push_tag`) and keeps that tag when it grows.
+//
 // == Usage example ==
 //
 // ```c
@@ -78,8 +83,11 @@
 #ifndef ARRAY_H_
 #define ARRAY_H_
 
+#include "allocator.h"
+
 #include <assert.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 // Public API.
@@ -89,7 +97,7 @@
 #define array_capacity(B) ((B) ? _array_header(B)->_capacity : 0)
 #define array_push(B, X) (_array_fit(B), (B)[_array_header(B)->_size++] = (X))
 #define array_pop(B) (array_size(B) > 0 ? _array_header(B)->_size-- : 0)
-#define array_free(B) ((B) ? free(_array_header(B)), (B) = NULL : 0)
+#define array_free(B) ((B) ? mem_free(_array_header(B)), (B) = NULL : 0)
 #define array_reserve(B, N) ((B) = _array_reserve(B, N, sizeof(*(B))))
 #define array_resize(B, N) ((B) = _array_reserve(B, N, sizeof(*(B))), _array_header(B)->_size = (N))
 #define array_clear(B) ((B) ? _array_header(B)->_size = 0 : 0)
@@ -101,10 +109,10 @@
         (B)[(I)]
     #define array_remove_fast(B, I)                                         \
         assert((uint32_t)(I) < array_size(B) && "Array out of bounds.");  \
-          (B)[I] = (B)[_array_header(B)->_size--]
+          (B)[I] = (B)[--_array_header(B)->_size]
 #else
     #define array_at(B, I) ((B)[(I)])
-    #define array_remove_fast(B, I) ((B) ? (B)[(I)] = (B)[_array_header(B)->_size--] : 0)
+    #define array_remove_fast(B, I) ((B) ? (void)((B)[(I)] = (B)[--_array_header(B)->_size]) : (void)0)
 #endif
 
 // -----------------------------------------------------------------------------
@@ -138,7 +146,7 @@ static inline void* _array_reserve(void* b, size_t capacity, size_t size)
     // Ensure at least 1 element is allocated. We don't want any problems when 0 elements are asked.
     const size_t new_capacity = capacity == 0 ? 1 : capacity;
     const size_t alloc_size = new_capacity * size + sizeof(struct _array_header_t);
-    header = realloc(header, alloc_size);
+    header = mem_realloc(mem_current_tag(), header, alloc_size);
 
     if (header)
     {
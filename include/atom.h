@@ -4,28 +4,115 @@
 #include "linalg.h"
 #include "world.h"
 
+#include <stdbool.h>
 #include <stdint.h>
 
-struct audio_system_o;
-struct camera_o;
 struct player_o;
-struct SDL_Renderer;
+struct tuning_t;
 
 struct atom_system_o;
 
-struct atom_system_o* atom_system_create(struct SDL_Renderer*);
-void atom_system_destroy(struct atom_system_o*);
+// @Note: the enum values must be sequential starting at 0 because they map to an array.
+enum AtomEventType
+{
+    ATOM_EVENT_EMIT_NEUTRON = 0,
+    ATOM_EVENT_STABLE,
+    ATOM_EVENT_FISSION,
 
-void atom_system_generate_atoms(struct atom_system_o*, struct player_o*, world_t, uint32_t n);
-void atom_system_draw(struct atom_system_o*, struct camera_o*, struct SDL_Renderer*);
-void atom_system_update(
-    struct atom_system_o*,
-    struct audio_system_o*,
-    struct player_o*,
-    world_t,
-    float dt);
-bool atom_system_all_stable(const struct atom_system_o*);
+    _ATOM_EVENT_TYPE_COUNT, // This *MUST* appear last in the enum.
+};
 
-#endif // ATOM_H_
+typedef struct atom_event_t atom_event_t;
+
+// Something that happened during the last update and that the presentation may want to play.
+struct atom_event_t
+{
+    enum AtomEventType type;
+    vec2_t pos;
+};
+
+typedef struct atom_info_t atom_info_t;
+
+struct atom_info_t
+{
+    vec2_t pos;
+    // Half extent.
+    float size;
+    // Neutrons the atom still has to emit before being stable, out of `num_exceeding_neutrons`.
+    uint32_t num_left;
+    uint32_t num_exceeding_neutrons;
+};
+
+typedef struct chain_reaction_t chain_reaction_t;
+
+// Neutrons reaching an unstable atom other than the one they come from are absorbed by it, and the
+// atom splits at once into a burst of neutrons unless a limit is reached. A cascade is everything
+// set off by one spontaneous emission.
+struct chain_reaction_t
+{
+    bool enabled;
+    // Capture radius around the atom centers, at most the atom bounding radius of the current
+    // game.
+    float cross_section;
+    // Neutrons of a fission burst. An atom can't have more than 8 neutrons alive at once, it
+    // doesn't split when the burst would go over.
+    uint32_t fission_neutrons;
+    uint32_t max_cascade_fissions;
+    // Fissions set off by a fission set off by ... by a spontaneous emission.
+    uint32_t max_cascade_depth;
+};
 
+typedef struct atom_metrics_t atom_metrics_t;
 
+struct atom_metrics_t
+{
+    // Since the previous update, streaming included.
+    uint32_t interaction_tests; // Neutron-atom tests.
+    // During the last update.
+    uint32_t neutron_events; // Neutrons looked at, the others didn't need to be.
+    uint32_t fissions;
+    // Since the last reset.
+    uint32_t largest_cascade; // In fissions.
+    uint32_t deepest_cascade;
+    uint64_t total_fissions;
+};
+
+struct atom_system_o* atom_system_create(void);
+void atom_system_destroy(struct atom_system_o*);
+
+// Starts a new game in `world`, every atom and neutron is discarded. The chunk size must be over
+// 2.83 times the atom size of the tuning.
+void atom_system_reset(struct atom_system_o*, world_t);
+// Copies the tuning, `tuning_default` until then. The atom size and neutrons take effect at the
+// next reset so that all the atoms of a game are alike, the rest at the next update.
+void atom_system_set_tuning(struct atom_system_o*, const struct tuning_t*);
+// Disabled by default, takes effect for the neutrons emitted afterwards.
+void atom_system_set_chain_reaction(struct atom_system_o*, chain_reaction_t);
+// Activates the chunks within `active_radius` chunks of the one containing `center`, generating
+// them or restoring them from their dormant state, and evicts the chunks further away than
+// `active_radius + 1`. It only does something when the center moves to another chunk.
+// Evicting a chunk may allocate its dormant state, unlike `atom_system_update` this isn't meant to
+// be called in a no-allocation scope.
+void atom_system_stream(struct atom_system_o*, vec2_t center);
+void atom_system_update(struct atom_system_o*, struct player_o*, float dt);
+// Atoms stabilized since the last reset.
+uint32_t atom_system_num_stabilized(const struct atom_system_o*);
+uint32_t atom_system_num_active_chunks(const struct atom_system_o*);
+uint32_t atom_system_num_dormant_chunks(const struct atom_system_o*);
+atom_metrics_t atom_system_metrics(const struct atom_system_o*);
+
+// Read-only state, valid until the next update or generation.
+uint32_t atom_system_num_atoms(const struct atom_system_o*);
+atom_info_t atom_system_atom(const struct atom_system_o*, uint32_t index);
+uint32_t atom_system_num_neutrons(const struct atom_system_o*);
+// Neutrons only store their trajectory, this computes their current centers into `x` and `y` of
+// `atom_system_num_neutrons` elements.
+void atom_system_neutron_positions(const struct atom_system_o*, float* x, float* y);
+// Velocities in units per ms, in the same order as the positions.
+void atom_system_neutron_velocities(const struct atom_system_o*, float* x, float* y);
+// Angle of the wobbling of unstable atoms, in radians.
+float atom_system_wobble_angle(const struct atom_system_o*);
+// Events of the last update, in the order they happened.
+const atom_event_t* atom_system_events(const struct atom_system_o*, uint32_t* num_events);
+
+#endif // ATOM_H_
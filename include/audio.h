@@ -1,10 +1,38 @@
 #ifndef AUDIO_H_
 #define AUDIO_H_
 
-// @Todo: can we find a way to determine a WAV file duration programatically and loop background
-// musics ?
+// Software mixer playing every sound through a single output device.
+//
+// Samples are loaded and converted to stereo at the mixer frequency once at startup, as float or
+// 16-bit frames (see `audio_sample.h`), and mixed straight from their memory by the audio callback
+// with SIMD kernels (see `audio_mix.h`).
+// Gain changes and stops are ramped over one audio buffer so they don't click, and the mix goes
+// through a limiter instead of clipping when many loud sounds play at once.
+// Every `audio_system_play` starts a new voice so the same sound can overlap itself, up to
+// `AUDIO_MAX_VOICES` voices at once. Each sound has a priority, a maximum number of instances and a
+// coalescing window (see `sound_descs` in `audio.c`):
+// - triggers of a sound closer than its window to the start of a playing instance are merged into
+//   that instance,
+// - a sound over its instance limit steals the oldest or quietest of its own instances,
+// - when all voices are busy the oldest or quietest voice of a lower or equal priority sound is
+//   stolen, otherwise the new sound is dropped.
+//
+// Positional sounds are panned and attenuated relatively to the listener, usually the camera.
+//
+// Musics are streamed from disk instead of being loaded (see `audio_stream.h`) and loop until
+// they are stopped.
+//
+// None of the functions block nor lock the audio device, they are safe to call many times per
+// tick. Commands are queued and applied by the callback at the start of the next audio buffer.
+// The only exception is `audio_system_replace_sound`, used by the hot reload of debug builds.
+
+#include "linalg.h"
+
+#include <stdbool.h>
+#include <stdint.h>
 
 struct audio_system_o;
+struct audio_sample_t;
 
 // @Note: the enum values must be sequential starting at 0 because they map to an array. This makes
 // things quicker for me as it avoids creating an id to sound mapping.
@@ -12,14 +40,59 @@ enum AudioEntry
 {
     AUDIO_ENTRY_EMIT_NEUTRON = 0,
     AUDIO_ENTRY_ATOM_STABLE,
+    AUDIO_ENTRY_FISSION,
 
     _AUDIO_ENTRY_COUNT, // This *MUST* appear last in the enum.
 };
 
+enum { AUDIO_MAX_VOICES = 64 };
+
+// Identifies a playing sound. It becomes stale when the sound ends or is stopped and using a stale
+// voice is a no-op. 0 is never a valid voice.
+typedef uint32_t audio_voice_t;
+
+#define AUDIO_VOICE_NULL ((audio_voice_t)0)
+
+typedef struct audio_mix_stats_t audio_mix_stats_t;
+
+// Measured by the audio callback, for profiling.
+struct audio_mix_stats_t
+{
+    // Average number of voices mixed.
+    float voices;
+    // Voices mixed per millisecond spent in the callback, a voice being one audio buffer
+    // (`MIX_BUFFER_FRAMES` in `audio.c`).
+    float voices_per_ms;
+    // Time spent in the callback relatively to the duration of the audio, 1 is a whole core.
+    float load;
+};
+
 struct audio_system_o* audio_system_create(void);
 void audio_system_destroy(struct audio_system_o*);
-void audio_system_play_sound(const struct audio_system_o*, enum AudioEntry);
-
-#endif // AUDIO_H_
+// Plays the sound at full gain in the center.
+void audio_system_play_sound(struct audio_system_o*, enum AudioEntry);
+// `gain` is linear (1 keeps the sample untouched) and `pan` goes from -1 (left) to 1 (right).
+// Returns `AUDIO_VOICE_NULL` when no voice is available.
+audio_voice_t audio_system_play(struct audio_system_o*, enum AudioEntry, float gain, float pan);
+// Opens and starts streaming `filename`, it loops until stopped. Returns `AUDIO_VOICE_NULL` when
+// the file can't be streamed or no voice is available.
+audio_voice_t audio_system_play_music(struct audio_system_o*, const char* filename, float gain);
+// Plays the sound panned and attenuated according to `position` relatively to the listener. Sounds
+// too far away aren't played at all.
+audio_voice_t audio_system_play_at(struct audio_system_o*, enum AudioEntry, vec2_t position);
+// Sounds within `range` of `position` are played at full gain. A range of 0 disables positional
+// sounds, they are all played at full gain in the center.
+void audio_system_set_listener(struct audio_system_o*, vec2_t position, float range);
+void audio_system_stop(struct audio_system_o*, audio_voice_t);
+void audio_system_set_gain_pan(struct audio_system_o*, audio_voice_t, float gain, float pan);
+// Statistics of the callback since the previous call.
+audio_mix_stats_t audio_system_mix_stats(struct audio_system_o*);
 
+// Hot reload, see `hot_reload.h`. Loads `filename` in the mixer format from any thread, false when
+// it isn't the file of a sound or can't be loaded.
+bool audio_system_load_sound(const char* filename, struct audio_sample_t*);
+// Makes the sounds of `filename` play `sample` and takes ownership of it. Locks the audio device
+// for the swap, voices playing the previous frames go on from the same position in the new ones.
+void audio_system_replace_sound(struct audio_system_o*, const char* filename, struct audio_sample_t*);
 
+#endif // AUDIO_H_
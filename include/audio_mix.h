@@ -0,0 +1,92 @@
+#ifndef AUDIO_MIX_H_
+#define AUDIO_MIX_H_
+
+// Mixing kernels of the audio callback.
+//
+// Voices are accumulated into a bus of interleaved float stereo frames, which gives them all the
+// headroom they need. The bus then goes through the limiter and, when the device wants 16-bit
+// samples, is converted with saturation. Sources can be float or 16-bit stereo frames.
+//
+// Gains are given as linear ramps over the frames being mixed so that changing the gain of a voice
+// never makes a click.
+//
+// Each kernel has a scalar, an SSE2 and an AVX2 implementation giving identical results. The one
+// matching the CPU is selected by `audio_system_create` from the level picked by
+// `cpu_dispatch_init()` (see `cpu_dispatch.h`). Until then the scalar implementation is used.
+
+#include "cpu_dispatch.h"
+
+#include <stdint.h>
+
+typedef struct audio_gain_ramp_t audio_gain_ramp_t;
+
+// The gain of frame `i` is `left + i * step_left` on the left channel, same on the right.
+struct audio_gain_ramp_t
+{
+    float left;
+    float right;
+    float step_left;
+    float step_right;
+};
+
+// Ramp going from the `from` gains to the `to` gains over `num_frames` frames. The `to` gains are
+// reached on the frame following the last one.
+static inline audio_gain_ramp_t audio_gain_ramp(
+    float from_left, float from_right, float to_left, float to_right, uint32_t num_frames)
+{
+    return (audio_gain_ramp_t){
+        .left = from_left,
+        .right = from_right,
+        .step_left = (to_left - from_left) / (float)num_frames,
+        .step_right = (to_right - from_right) / (float)num_frames,
+    };
+}
+
+// The same ramp starting `num_frames` frames later.
+static inline audio_gain_ramp_t audio_gain_ramp_skip(audio_gain_ramp_t ramp, uint32_t num_frames)
+{
+    ramp.left += (float)num_frames * ramp.step_left;
+    ramp.right += (float)num_frames * ramp.step_right;
+    return ramp;
+}
+
+const char* audio_mix_name(void);
+
+// bus += frames * ramp
+void audio_mix_f32(float* bus, const float* frames, uint32_t num_frames, audio_gain_ramp_t ramp);
+// bus += (frames / 32768) * ramp
+void audio_mix_s16(float* bus, const int16_t* frames, uint32_t num_frames, audio_gain_ramp_t ramp);
+// Largest absolute value of the bus.
+float audio_mix_peak(const float* bus, uint32_t num_frames);
+// Scales the bus by a gain going linearly from `gain` by `step` per frame, then bends the samples
+// louder than `knee` so that they never reach 1. The curve is continuous and smooth at the knee.
+void audio_mix_limit(float* bus, uint32_t num_frames, float gain, float step, float knee);
+// out = bus * 32767, rounded to nearest and saturated.
+void audio_mix_to_s16(int16_t* out, const float* bus, uint32_t num_frames);
+
+// -----------------------------------------------------------------------------
+// Implementation details.
+// -----------------------------------------------------------------------------
+
+typedef struct audio_mix_kernels_t audio_mix_kernels_t;
+
+struct audio_mix_kernels_t
+{
+    const char* name;
+    void (*mix_f32)(float*, const float*, uint32_t, audio_gain_ramp_t);
+    void (*mix_s16)(float*, const int16_t*, uint32_t, audio_gain_ramp_t);
+    float (*peak)(const float*, uint32_t);
+    void (*limit)(float*, uint32_t, float, float, float);
+    void (*to_s16)(int16_t*, const float*, uint32_t);
+};
+
+// Each ISA lives in its own translation unit compiled with the matching target flags. They return
+// NULL when the ISA isn't available for the target the game is compiled for.
+const audio_mix_kernels_t* audio_mix_scalar_kernels(void);
+const audio_mix_kernels_t* audio_mix_sse2_kernels(void);
+const audio_mix_kernels_t* audio_mix_avx2_kernels(void);
+
+// Selects the widest kernels up to `level`, which *MUST* be supported by the CPU.
+void audio_mix_select(enum SimdLevel level);
+
+#endif // AUDIO_MIX_H_
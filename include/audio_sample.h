@@ -0,0 +1,42 @@
+#ifndef AUDIO_SAMPLE_H_
+#define AUDIO_SAMPLE_H_
+
+// Sound effects converted once at load time to the mixer format: interleaved stereo frames at the
+// mixer frequency. The mixer then only has to add frames together, nothing is resampled nor
+// remixed in the audio callback.
+//
+// Assets with 8-bit or 16-bit samples are kept as 16-bit frames, which loses nothing and halves
+// the memory and bandwidth they take. Other assets are kept as float frames. The 16-bit frames are
+// widened to float by the mixing kernels in the same pass as the gain, with SSE2 and AVX2 that is
+// cheaper than reading twice as many bytes of float frames (see `audio/mix_*` in the benchmarks).
+//
+// Converting can take a while for long sounds so the converted frames can be persisted next to the
+// asset (`<filename>.pcm`) and are loaded from there as long as the asset doesn't change.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum AudioSampleFormat
+{
+    AUDIO_SAMPLE_F32 = 0,
+    AUDIO_SAMPLE_S16,
+
+    _AUDIO_SAMPLE_FORMAT_COUNT, // This *MUST* appear last in the enum.
+};
+
+typedef struct audio_sample_t audio_sample_t;
+
+struct audio_sample_t
+{
+    // `num_frames` stereo frames of `format`, NULL when the sample couldn't be loaded.
+    void* frames;
+    uint32_t num_frames;
+    enum AudioSampleFormat format;
+};
+
+bool audio_sample_load(audio_sample_t*, const char* filename, uint32_t frequency, bool persist);
+void audio_sample_free(audio_sample_t*);
+// Size in bytes of a stereo frame.
+uint32_t audio_sample_frame_size(enum AudioSampleFormat);
+
+#endif // AUDIO_SAMPLE_H_
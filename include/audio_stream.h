@@ -0,0 +1,39 @@
+#ifndef AUDIO_STREAM_H_
+#define AUDIO_STREAM_H_
+
+// Looping WAV stream read from disk.
+//
+// A background thread reads the PCM data of the file in small blocks, converts it to float stereo
+// at the mixer frequency and hands it over to the audio callback through a ring of fixed size
+// chunks. The memory used doesn't depend on the length of the file.
+//
+// The stream loops forever. The loop points are read from the `smpl` chunk of the file when there
+// is one, otherwise the whole file is looped. Looping is sample accurate: the frame after the loop
+// end is the loop start, the resampler doesn't see the seam.
+//
+// `audio_stream_open` and `audio_stream_close` are called from the game thread, `audio_stream_mix`
+// from the audio callback only.
+
+#include "audio_mix.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct audio_stream_o;
+
+// Returns NULL if the file can't be read or isn't a supported WAV file (8-bit, 16-bit or float
+// PCM). The chunks are filled before returning so playback can start right away.
+struct audio_stream_o* audio_stream_open(const char* filename, uint32_t frequency);
+// Asks the streaming thread to stop and returns right away, the thread frees the stream when it
+// exits. The stream *MUST NOT* be mixed anymore.
+void audio_stream_close(struct audio_stream_o*);
+// Adds `num_frames` stereo frames of the stream to `bus`. Never blocks, when the streaming thread
+// is late the missing frames are skipped.
+void audio_stream_mix(struct audio_stream_o*, float* bus, uint32_t num_frames, audio_gain_ramp_t ramp);
+// Number of times the callback ran out of data, for debugging.
+uint32_t audio_stream_underruns(const struct audio_stream_o*);
+// Waits for the streaming threads of the closed streams to free them, all streams *MUST* have been
+// closed. Only for shutdown, closing itself never waits.
+void audio_stream_wait_all_closed(void);
+
+#endif // AUDIO_STREAM_H_
@@ -0,0 +1,100 @@
+#ifndef BATCH_ENV_H_
+#define BATCH_ENV_H_
+
+// Many independent headless games stepped in lockstep, for bots, training and balancing sweeps.
+//
+// Every instance has its own atom system, player, camera and camera scrolling, updated as in the
+// game loop at a fixed step, and nothing is drawn. A step applies one action per instance and
+// returns one observation and one reward per instance. The instances are spread over a thread
+// pool, their results only depend on the seed and the actions whatever the number of threads.
+//
+// An episode ends when the player dies, wins or runs out of steps. The instance starts the next
+// episode right away in a new world so every instance always has an observation, `dones` tells
+// which ones were reset during the last step.
+//
+// Actions and results are structures of arrays indexed by instance. The results are owned by the
+// environment and valid until the next step or reset.
+
+#include "linalg.h"
+#include "tuning.h"
+
+#include <stdint.h>
+
+struct batch_env_o;
+
+// Observed neutrons and unstable atoms, the nearest to the player first.
+enum { BATCH_ENV_NEAREST_NEUTRONS = 8 };
+enum { BATCH_ENV_NEAREST_ATOMS = 4 };
+// Floats per observation, in world units and units per ms with the y axis going up:
+// - player velocity (2),
+// - camera position relative to the player (2), to turn world positions into cursor positions,
+// - nearest neutrons: position relative to the player and velocity (4 each),
+// - nearest unstable atoms: position relative to the player and fraction of the neutrons left to
+//   emit before being stable (3 each).
+// Missing neutrons and atoms are `BATCH_ENV_ABSENT_DISTANCE` away on both axes with the rest at 0.
+enum { BATCH_ENV_OBSERVATION_SIZE = 4 + 4 * BATCH_ENV_NEAREST_NEUTRONS + 3 * BATCH_ENV_NEAREST_ATOMS };
+static const float BATCH_ENV_ABSENT_DISTANCE = 10000;
+
+typedef struct batch_env_config_t batch_env_config_t;
+
+struct batch_env_config_t
+{
+    uint32_t num_instances;
+    // Threads started besides the one stepping the environment.
+    uint32_t num_workers;
+    // World seeds are derived from it, the instance and the episode.
+    uint64_t seed;
+    // World, chain reactions, sizes and speeds, and stabilized atoms to win (0 to never win).
+    tuning_t tuning;
+    // Screen size, cursors are in screen space as the mouse is in the game.
+    vec2_t viewport;
+    float step_ms;
+    // 0 for episodes only ended by death or victory.
+    uint32_t max_episode_steps;
+};
+
+typedef struct batch_env_actions_t batch_env_actions_t;
+
+struct batch_env_actions_t
+{
+    // Cursor in screen space, origin at the top-left corner of the viewport.
+    const float* cursor_x;
+    const float* cursor_y;
+    // 1 while the mouse button is held, the player heads to the cursor.
+    const uint8_t* button;
+};
+
+typedef struct batch_env_results_t batch_env_results_t;
+
+struct batch_env_results_t
+{
+    // `BATCH_ENV_OBSERVATION_SIZE` floats per instance.
+    const float* observations;
+    // 1 per atom stabilized during the step, -1 when the player dies.
+    const float* rewards;
+    // 1 when the episode ended during the step, the observation is then the first of the next one.
+    const uint8_t* dones;
+};
+
+typedef struct batch_env_stats_t batch_env_stats_t;
+
+struct batch_env_stats_t
+{
+    // Instance steps, `num_instances` per call of `batch_env_step`.
+    uint64_t steps;
+    uint64_t episodes; // Ended ones.
+    uint64_t deaths;
+    uint64_t wins;
+    uint64_t timeouts;
+};
+
+struct batch_env_o* batch_env_create(batch_env_config_t);
+void batch_env_destroy(struct batch_env_o*);
+
+// Starts a new episode on every instance, the first one again for each instance.
+batch_env_results_t batch_env_reset(struct batch_env_o*);
+batch_env_results_t batch_env_step(struct batch_env_o*, batch_env_actions_t);
+batch_env_stats_t batch_env_stats(const struct batch_env_o*);
+uint32_t batch_env_num_threads(const struct batch_env_o*);
+
+#endif // BATCH_ENV_H_
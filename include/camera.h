@@ -1,20 +1,21 @@
 #ifndef CAMERA_H_
 #define CAMERA_H_
 
-#include <SDL2/SDL_events.h>
-
 #include "linalg.h"
 
 struct camera_o;
 
 struct camera_o* camera_create(vec2_t pos, vec2_t viewport);
 void camera_destroy(struct camera_o*);
-void camera_handle_event(struct camera_o*, SDL_Event event);
 void camera_update(struct camera_o*);
 vec2_t camera_position(struct camera_o*);
+// Size of the screen in world units.
+vec2_t camera_viewport(struct camera_o*);
 mat3_t camera_view(struct camera_o*);
 vec2_t camera_screen_to_world(struct camera_o*, vec2_t screen);
 vec2_t camera_world_to_screen(struct camera_o* camera, vec2_t world);
+// Same transformation as `camera_world_to_screen` as a matrix, for `batch_transform`.
+mat3_t camera_world_to_screen_matrix(struct camera_o*);
 void camera_look_at(struct camera_o*, vec2_t pos);
 
 #endif // CAMERA_H_
@@ -4,9 +4,12 @@
 struct camera_scrolling_system_o;
 struct camera_o;
 struct player_o;
+struct tuning_t;
 
 struct camera_scrolling_system_o* camera_scrolling_system_create(void);
 void camera_scrolling_system_destroy(struct camera_scrolling_system_o*);
+// Only the camera follow factor is used, `tuning_default` until then.
+void camera_scrolling_system_set_tuning(struct camera_scrolling_system_o*, const struct tuning_t*);
 
 void camera_scrolling_system_update(
     struct camera_scrolling_system_o*,
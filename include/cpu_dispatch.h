@@ -0,0 +1,42 @@
+#ifndef CPU_DISPATCH_H_
+#define CPU_DISPATCH_H_
+
+// Runtime CPU feature dispatch.
+//
+// Hot paths (batch maths, audio mixing) are compiled once per instruction set in their own
+// translation units. `cpu_dispatch_init()` detects what the CPU supports with cpuid on x86, picks the
+// widest implementation of the batch maths and keeps the level for the other subsystems, which
+// select theirs from `cpu_dispatch_level()` (see `audio_mix_select`). The choice is made once and
+// not on every call.
+//
+// Part of the simulation library: headless users get the same kernels as the game, the batch
+// environment initializes the dispatch itself.
+//
+// The `LD49_SIMD` environment variable forces a level by name (`scalar`, `sse2`, `sse4.1`, `avx2`,
+// `neon`), for example to compare performance or to check a result against the scalar path. An
+// unsupported level falls back to the widest supported one below it.
+
+#include <stdbool.h>
+
+enum SimdLevel
+{
+    SIMD_LEVEL_SCALAR = 0,
+    SIMD_LEVEL_SSE2,
+    SIMD_LEVEL_SSE41,
+    SIMD_LEVEL_AVX2,
+    SIMD_LEVEL_NEON,
+
+    _SIMD_LEVEL_COUNT, // This *MUST* appear last in the enum.
+};
+
+// Must be called before any dispatched function is used, from a single thread. Later calls do
+// nothing. `batch_env_create` calls it.
+void cpu_dispatch_init(void);
+// Returns false and keeps the current level when `level` isn't supported by the CPU or wasn't
+// compiled in.
+bool cpu_dispatch_select(enum SimdLevel level);
+bool cpu_dispatch_supported(enum SimdLevel level);
+enum SimdLevel cpu_dispatch_level(void);
+const char* cpu_dispatch_level_name(enum SimdLevel level);
+
+#endif // CPU_DISPATCH_H_
@@ -1,6 +1,15 @@
 #ifndef DISPLAY_H_
 #define DISPLAY_H_
 
+// Window and renderer of the game.
+//
+// Everything is drawn in logical coordinates (the size given to `display_create`) and SDL scales
+// them to the window. With dynamic resolution enabled, the world drawn between
+// `display_begin_world` and `display_end_world` goes to an offscreen target instead, whose
+// resolution follows the frame time, and is then upscaled to the window. What is drawn after the
+// world (menus, HUD) stays at the resolution of the window.
+
+#include <stdbool.h>
 #include <stdint.h>
 
 struct SDL_Window;
@@ -8,11 +17,33 @@ struct SDL_Renderer;
 
 struct display_o;
 
+typedef struct dynamic_resolution_t dynamic_resolution_t;
+
+struct dynamic_resolution_t
+{
+    // Frame time the resolution of the world is adjusted to hold.
+    float target_frame_ms;
+    // Bounds of the resolution of the world per axis, as fractions of the window resolution.
+    float min_scale;
+    float max_scale;
+};
+
 struct display_o* display_create(uint32_t width, uint32_t height, const char* title);
 void display_destroy(struct display_o*);
 void display_set_title(struct display_o*, const char* title);
 struct SDL_Renderer* display_get_renderer(struct display_o*);
 
-#endif // DISPLAY_H_
-
+// Returns false, and keeps drawing the world at the window resolution, when the renderer can't
+// draw to textures.
+bool display_enable_dynamic_resolution(struct display_o*, const dynamic_resolution_t*);
+// The world is drawn in logical coordinates between these two calls, they do nothing when dynamic
+// resolution is disabled.
+void display_begin_world(struct display_o*);
+void display_end_world(struct display_o*);
+// Shows the frame and measures its time.
+void display_present(struct display_o*);
+// Current resolution of the world per axis as a fraction of the window resolution, 1 when dynamic
+// resolution is disabled.
+float display_world_scale(struct display_o*);
 
+#endif // DISPLAY_H_
@@ -0,0 +1,79 @@
+#ifndef GAME_H_
+#define GAME_H_
+
+// Main loop of the game driving a stack of states (title screen, game, pause menu...).
+//
+// States are created once by their owner and keep their resources while they aren't on the stack,
+// the textures come from the shared texture cache. Pushing, popping or switching a state only
+// calls its `enter` and `exit` hooks so every transition happens within the frame.
+//
+// Each frame the SDL events are drained into an input snapshot (see `input.h`) handed to the top
+// state, then the top state gets as many fixed step updates as the elapsed time needs, then the
+// states are drawn bottom to top starting at the highest one which isn't an overlay. The states
+// below the top are neither updated nor sent input: an overlay such as the pause menu freezes the
+// game under it without tearing it down.
+//
+// Stack changes made by the hooks take effect at once, the next update or input goes to the new
+// top state. The loop returns when the stack is empty or `game_quit` is called.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct audio_system_o;
+struct camera_o;
+struct display_o;
+struct texture_cache_o;
+struct SDL_Renderer;
+typedef struct input_t input_t;
+
+struct game_o;
+
+typedef struct game_state_t game_state_t;
+
+// Every hook is optional and gets the `user` pointer of the state.
+struct game_state_t
+{
+    const char* name;
+    void* user;
+    // Drawn over the states below it.
+    bool overlay;
+    // Nothing moves without input, the loop waits for events instead of spinning while the state
+    // is on top.
+    bool idle;
+
+    // The state is pushed, or switched to.
+    void (*enter)(void* user, struct game_o*);
+    // The state is popped, or switched from.
+    void (*exit)(void* user, struct game_o*);
+    // Once per frame before the updates. Closing the window is handled by the loop.
+    void (*handle_input)(void* user, struct game_o*, const input_t*);
+    // Fixed step, see `GAME_UPDATE_STEP_MS`.
+    void (*update)(void* user, struct game_o*);
+    void (*draw)(void* user, struct game_o*, struct SDL_Renderer*);
+};
+
+// About 60 UPS (Update Per Second). Neutron speeds don't depend on it and collisions are swept,
+// anything down to 20 UPS plays the same.
+static const uint32_t GAME_UPDATE_STEP_MS = 1000 / 60;
+
+struct game_o* game_create(struct display_o*, struct audio_system_o*);
+void game_destroy(struct game_o*);
+
+void game_run(struct game_o*);
+void game_quit(struct game_o*);
+
+void game_push_state(struct game_o*, game_state_t*);
+void game_pop_state(struct game_o*);
+// Replaces the top state, or pushes when the stack is empty.
+void game_switch_state(struct game_o*, game_state_t*);
+// False while another state is over `state`, it is then neither updated nor sent input.
+bool game_is_top_state(struct game_o*, const game_state_t*);
+// Camera giving the world position of the cursor in the input snapshots, NULL when the screen has
+// no world.
+void game_set_camera(struct game_o*, struct camera_o*);
+
+struct display_o* game_display(struct game_o*);
+struct audio_system_o* game_audio(struct game_o*);
+struct texture_cache_o* game_textures(struct game_o*);
+
+#endif // GAME_H_
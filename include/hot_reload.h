@@ -0,0 +1,28 @@
+#ifndef HOT_RELOAD_H_
+#define HOT_RELOAD_H_
+
+// Hot reload of the images and sounds modified on disk, in debug builds on Linux.
+//
+// A thread watches the asset directories with inotify. When an image (BMP or QOI) or a WAV is
+// written it loads it right away, a BMP to a surface, a QOI as is and a WAV to the mixer format,
+// and hands it over to the game thread.
+// `hot_reload_apply` is called by the game loop between two frames and swaps the loaded assets
+// in: images are uploaded in their existing texture (see `texture_cache_reload`) and sounds
+// replace the frames of their sample (see `audio_system_replace_sound`), nobody holding a texture
+// or playing a sound notices besides the new content. Only the QOI decoding and the upload happen
+// on the game thread.
+//
+// Elsewhere `hot_reload_create` returns NULL and the other functions do nothing.
+
+struct audio_system_o;
+struct texture_cache_o;
+
+struct hot_reload_o;
+
+// Watches `directory` and its subdirectories, the paths given to the texture cache and the audio
+// system must start with it.
+struct hot_reload_o* hot_reload_create(const char* directory, struct texture_cache_o*, struct audio_system_o*);
+void hot_reload_destroy(struct hot_reload_o*);
+void hot_reload_apply(struct hot_reload_o*);
+
+#endif // HOT_RELOAD_H_
@@ -0,0 +1,64 @@
+#ifndef INPUT_H_
+#define INPUT_H_
+
+// Snapshot of the mouse and keyboard taken once per frame.
+//
+// The game loop drains the SDL events at the start of every frame into an `input_t` (see
+// `input_poll`) and the screens read it instead of handling events one by one. Mouse motions only
+// overwrite the cursor position, a mouse polling at 1000 Hz costs a store per event and the world
+// position of the cursor is computed once per frame. Button and key edges are accumulated so a
+// press and a release within the same frame are both seen.
+//
+// The snapshot doesn't depend on the SDL, only filling it does.
+
+#include "linalg.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct camera_o;
+
+// Bits of the button masks.
+enum InputButton
+{
+    INPUT_BUTTON_LEFT = 1 << 0,
+    INPUT_BUTTON_MIDDLE = 1 << 1,
+    INPUT_BUTTON_RIGHT = 1 << 2,
+};
+
+// Bits of the key masks, only the keys the game uses are tracked.
+enum InputKey
+{
+    INPUT_KEY_ESCAPE = 1 << 0,
+};
+
+typedef struct input_t input_t;
+
+struct input_t
+{
+    // Latest cursor position, screen space has its origin at the top-left corner of the display.
+    vec2_t cursor;
+    // Cursor position at the last button press of the frame, where a click happened.
+    vec2_t press_cursor;
+    // Same positions in world space through the camera given to `input_poll`, when there is one.
+    vec2_t cursor_world;
+    vec2_t press_cursor_world;
+
+    uint32_t buttons_down; // At the end of the frame.
+    uint32_t buttons_pressed; // During the frame.
+    uint32_t buttons_released;
+    uint32_t keys_down;
+    uint32_t keys_pressed;
+
+    bool quit; // The window was closed.
+
+    // Drained during the frame, for profiling.
+    uint32_t num_events;
+    uint32_t num_motions;
+};
+
+// Edges are cleared, the cursor and what is held are kept. Waits up to `timeout_ms` for the first
+// event when it isn't 0. `camera` may be NULL for screens without a world.
+void input_poll(input_t*, uint32_t timeout_ms, struct camera_o* camera);
+
+#endif // INPUT_H_
@@ -3,6 +3,7 @@
 
 #include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 static const float PI_f = 3.14159265358979323846f;
 static const float PI_2_f = 1.57079632679489661923f;
@@ -21,13 +22,100 @@ static inline float min(float a, float b) { return a < b ? a : b; }
 static inline float clamp(float x, float min, float max) { return x < min ? min : x > max ? max : x; }
 static inline float sign(float x) { return x >= 0 ? 1 : -1; }
 
+// x^n by repeated squaring.
+static inline float powi(float x, uint32_t n)
+{
+    float result = 1;
+    for (; n; n >>= 1, x *= x)
+    {
+        if (n & 1) result *= x;
+    }
+    return result;
+}
+
 // Polynomial easing of the form f(x) = x^power with x in [0, 1] and power >= 0.
-// A power of 0 interpolates linearly.
-static inline float polynomial_easing(float x, float power) { return power == 0 ? x : powf(x, power); }
+// A power of 0 interpolates linearly. Integer powers avoid `powf`.
+static inline float polynomial_easing(float x, float power)
+{
+    if (power == 0) return x;
+    if (power <= 16 && power == (uint32_t)power) return powi(x, (uint32_t)power);
+    return powf(x, power);
+}
 static inline float polynomial_ease_in(float x, float power) { return polynomial_easing(x, power); }
 static inline float polynomial_ease_out(float x, float power) { return polynomial_easing(1 - x, power); }
 static inline float polynomial_ease_inout(float x, float power) { return x < 0.5f ? polynomial_easing(2 * x, power) * 0.5 : (1 - polynomial_easing(1 - 2 * (x - 0.5), power)) * 0.5 + 0.5; }
 
+//
+// Fast trigonometry
+//
+// Polynomial approximations of sin and cos evaluated after reducing the angle to [-pi/4, pi/4].
+// Maximum absolute errors, measured against the double precision libm for |x| <= 8192 (the range
+// reduction loses precision past that):
+//   - `fast_sincosf`:   1e-7 (libm `sinf`/`cosf` are at 3e-8).
+//   - `approx_sincosf`: 1.3e-5, visually exact for rotations and directions of a few hundred units.
+// `sinf`/`cosf` remain the choice when exact results are needed. `batch_sincos` in
+// `linalg_batch.h` is the SIMD version of `fast_sincosf` and returns the same results.
+//
+
+// Shared with the SIMD implementations which must perform the exact same operations.
+#define _SINCOS_2_PI 0.636619772367581343f
+#define _SINCOS_ROUND 12582912.0f // 1.5*2^23
+#define _SINCOS_PI_2_A 1.5703125f
+#define _SINCOS_PI_2_B 4.837512969970703125e-4f
+#define _SINCOS_PI_2_C 7.54978995489188216e-8f
+#define _SINCOS_S1 -1.6666654611e-1f
+#define _SINCOS_S2 8.3321608736e-3f
+#define _SINCOS_S3 -1.9515295891e-4f
+#define _SINCOS_C1 4.166664568298827e-2f
+#define _SINCOS_C2 -1.388731625493765e-3f
+#define _SINCOS_C3 2.443315711809948e-5f
+
+// Returns x reduced to [-pi/4, pi/4] and the quadrant of x in `quadrant` (in [0, 3]).
+static inline float _sincos_reduce(float x, uint32_t* quadrant)
+{
+    // Round to nearest by adding and removing 1.5*2^23 so that SIMD versions round the same way.
+    const float k = (x * _SINCOS_2_PI + _SINCOS_ROUND) - _SINCOS_ROUND;
+    *quadrant = (uint32_t)(int32_t)k & 3;
+    // Cody-Waite reduction with pi/2 split in three parts.
+    return ((x - k * _SINCOS_PI_2_A) - k * _SINCOS_PI_2_B) - k * _SINCOS_PI_2_C;
+}
+
+// Maps sin and cos of the reduced angle back to the quadrant of the original one.
+static inline void _sincos_quadrant(float sin_r, float cos_r, uint32_t quadrant, float* s, float* c)
+{
+    const float sin_x = quadrant & 1 ? cos_r : sin_r;
+    const float cos_x = quadrant & 1 ? sin_r : cos_r;
+    *s = quadrant & 2 ? -sin_x : sin_x;
+    *c = (quadrant + 1) & 2 ? -cos_x : cos_x;
+}
+
+static inline void fast_sincosf(float x, float* s, float* c)
+{
+    uint32_t quadrant;
+    const float r = _sincos_reduce(x, &quadrant);
+    const float z = r * r;
+    // Cephes minimax coefficients.
+    const float sin_r = r + r * z * (_SINCOS_S1 + z * (_SINCOS_S2 + z * _SINCOS_S3));
+    const float cos_r = 1.0f - 0.5f * z + z * z * (_SINCOS_C1 + z * (_SINCOS_C2 + z * _SINCOS_C3));
+    _sincos_quadrant(sin_r, cos_r, quadrant, s, c);
+}
+
+static inline void approx_sincosf(float x, float* s, float* c)
+{
+    uint32_t quadrant;
+    const float r = _sincos_reduce(x, &quadrant);
+    const float z = r * r;
+    // Least squares fit on [-pi/4, pi/4].
+    const float sin_r = r + r * z * (-0.166627561f + z * 0.00815158944f);
+    const float cos_r = 1.0f + z * (-0.49977258f + z * 0.0404819928f);
+    _sincos_quadrant(sin_r, cos_r, quadrant, s, c);
+}
+
+static inline float fast_sinf(float x) { float s, c; fast_sincosf(x, &s, &c); return s; }
+static inline float fast_cosf(float x) { float s, c; fast_sincosf(x, &s, &c); return c; }
+static inline float approx_sinf(float x) { float s, c; approx_sincosf(x, &s, &c); return s; }
+static inline float approx_cosf(float x) { float s, c; approx_sincosf(x, &s, &c); return c; }
+
 //
 // Vector maths
 //
@@ -75,6 +163,23 @@ static inline vec2_t vec2_rotate(vec2_t v, float angle)
     const float sin_angle = sinf(angle);
     return (vec2_t){v.x*cos_angle - v.y*sin_angle, v.x*sin_angle + v.y*cos_angle};
 }
+static inline vec2_t vec2_rotate_fast(vec2_t v, float angle)
+{
+    float sin_angle, cos_angle;
+    fast_sincosf(angle, &sin_angle, &cos_angle);
+    return (vec2_t){v.x*cos_angle - v.y*sin_angle, v.x*sin_angle + v.y*cos_angle};
+}
+
+// Fills `dirs` with `n` unit directions evenly spread on the circle, the first one being at
+// `phase` radians. Meant to be computed once (with the precise libm) and reused for N-way rings.
+static inline void direction_ring(vec2_t* dirs, uint32_t n, float phase)
+{
+    const float step = 2*PI_f / n;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        dirs[i] = (vec2_t){cosf(phase + step*i), sinf(phase + step*i)};
+    }
+}
 
 //
 // Matrix maths
@@ -120,6 +225,17 @@ static inline mat3_t mat3_rotation(float angle)
     };
 }
 
+static inline mat3_t mat3_rotation_fast(float angle)
+{
+    float sin_angle, cos_angle;
+    fast_sincosf(angle, &sin_angle, &cos_angle);
+    return (mat3_t){
+        .x = {cos_angle, -sin_angle, 0},
+        .y = {sin_angle,  cos_angle, 0},
+        .z = {        0,          0, 1},
+    };
+}
+
 static inline vec3_t mat3_mul_vec(mat3_t lhs, vec3_t rhs)
 {
     return (vec3_t){
@@ -0,0 +1,84 @@
+#ifndef LINALG_BATCH_H_
+#define LINALG_BATCH_H_
+
+// Batch operations over structure of arrays (SoA) float data.
+//
+// Vectors are given as separate `x` and `y` arrays of `n` elements. Output arrays can be the same
+// as any of the input arrays (in place operations) but must not partially overlap them. Masks
+// are one byte per element, 1 when the test passes and 0 otherwise.
+//
+// Each operation has a scalar, an SSE2, an SSE4.1, an AVX2 and a NEON implementation. The one
+// matching the CPU is selected by `cpu_dispatch_init()` (see `cpu_dispatch.h`), at startup or by
+// `batch_env_create`. Until then the scalar implementation is used.
+
+#include "linalg.h"
+
+#include <stdint.h>
+
+const char* linalg_batch_name(void);
+
+// out = a + b
+void batch_add(float* out, const float* a, const float* b, uint32_t n);
+// out = a * s
+void batch_scale(float* out, const float* a, float s, uint32_t n);
+// out = a * s + b
+void batch_fma(float* out, const float* a, float s, const float* b, uint32_t n);
+// out = x*x + y*y
+void batch_length_sq(float* out, const float* x, const float* y, uint32_t n);
+// out = (x - p.x)^2 + (y - p.y)^2
+void batch_dist_sq(float* out, const float* x, const float* y, vec2_t p, uint32_t n);
+// mask = circle of center (x, y) and `radius` intersects `c`. All the circles share the radius.
+void batch_circle_overlap(
+    uint8_t* mask, const float* x, const float* y, float radius, circle_t c, uint32_t n);
+// (out_x, out_y) = (x, y) / length(x, y)
+void batch_normalize(float* out_x, float* out_y, const float* x, const float* y, uint32_t n);
+// mask = (x, y) is inside `b` (bounds included, same as `bbox2_contain`).
+void batch_bbox_contain(uint8_t* mask, const float* x, const float* y, bbox2_t b, uint32_t n);
+// (out_x, out_y) = m * (x, y, 1), the outputs may be the inputs.
+void batch_transform(
+    float* out_x, float* out_y, const float* x, const float* y, mat3_t m, uint32_t n);
+// (out_s, out_c) = (sin(x), cos(x)), same results and error bound as `fast_sincosf`.
+void batch_sincos(float* out_s, float* out_c, const float* x, uint32_t n);
+// Continuous `circle_overlap`: mask = circle of center (x, y) and `radius` moving by (dx, dy)
+// touches `c` moving by `c_delta` at any point of their moves, nothing tunnels through however
+// long the moves are. All the circles share the radius.
+void batch_sweep_circle_overlap(
+    uint8_t* mask, const float* x, const float* y, const float* dx, const float* dy,
+    float radius, circle_t c, vec2_t c_delta, uint32_t n);
+
+// -----------------------------------------------------------------------------
+// Implementation details.
+// -----------------------------------------------------------------------------
+
+typedef struct linalg_batch_kernels_t linalg_batch_kernels_t;
+
+struct linalg_batch_kernels_t
+{
+    const char* name;
+    void (*add)(float*, const float*, const float*, uint32_t);
+    void (*scale)(float*, const float*, float, uint32_t);
+    void (*fma)(float*, const float*, float, const float*, uint32_t);
+    void (*length_sq)(float*, const float*, const float*, uint32_t);
+    void (*dist_sq)(float*, const float*, const float*, vec2_t, uint32_t);
+    void (*circle_overlap)(uint8_t*, const float*, const float*, float, circle_t, uint32_t);
+    void (*normalize)(float*, float*, const float*, const float*, uint32_t);
+    void (*bbox_contain)(uint8_t*, const float*, const float*, bbox2_t, uint32_t);
+    void (*transform)(float*, float*, const float*, const float*, mat3_t, uint32_t);
+    void (*sincos)(float*, float*, const float*, uint32_t);
+    void (*sweep_circle_overlap)(
+        uint8_t*, const float*, const float*, const float*, const float*,
+        float, circle_t, vec2_t, uint32_t);
+};
+
+// Each ISA lives in its own translation unit compiled with the matching target flags. They return
+// NULL when the ISA isn't available for the target the game is compiled for.
+const linalg_batch_kernels_t* linalg_batch_scalar_kernels(void);
+const linalg_batch_kernels_t* linalg_batch_sse2_kernels(void);
+const linalg_batch_kernels_t* linalg_batch_sse41_kernels(void);
+const linalg_batch_kernels_t* linalg_batch_avx2_kernels(void);
+const linalg_batch_kernels_t* linalg_batch_neon_kernels(void);
+
+// Called by the dispatcher. The kernels *MUST* be supported by the CPU.
+void linalg_batch_set_kernels(const linalg_batch_kernels_t*);
+
+#endif // LINALG_BATCH_H_
@@ -2,21 +2,33 @@
 #define PLAYER_H_
 
 #include "linalg.h"
-#include "world.h"
 
-#include <SDL2/SDL_events.h>
+#include <stdbool.h>
 
 struct player_o;
-struct camera_o;
-struct SDL_Renderer;
+struct tuning_t;
 
-struct player_o* player_create(struct SDL_Renderer*);
+// In units per ms. The atom system relies on it to know how soon the player can reach a neutron.
+static const float PLAYER_MAX_SPEED = 5;
+
+struct player_o* player_create(void);
 void player_destroy(struct player_o*);
-void player_update(struct player_o*, world_t, float dt);
-void player_handle_event(struct player_o*, struct camera_o*, SDL_Event event);
-void player_draw(struct player_o*, struct camera_o*, struct SDL_Renderer*);
+// Back at the world origin, alive and standing still as when created.
+void player_reset(struct player_o*);
+// Copies the tuning, `tuning_default` until then. Takes effect at once.
+void player_set_tuning(struct player_o*, const struct tuning_t*);
+void player_update(struct player_o*, float dt);
+// The player heads to `target` (in world space) while moving, and slows down once stopped.
+void player_start_move(struct player_o*, vec2_t target);
+// Only changes the target while moving.
+void player_move_to(struct player_o*, vec2_t target);
+void player_stop_move(struct player_o*);
 vec2_t player_position(const struct player_o*);
+// Position before the last `player_update`, the player moved in a straight line from there.
+vec2_t player_previous_position(const struct player_o*);
+vec2_t player_direction(const struct player_o*);
 bool player_intersect_circle(struct player_o*, circle_t);
+circle_t player_bounding_circle(const struct player_o*);
 void player_die(struct player_o*);
 bool player_is_dead(const struct player_o*);
 
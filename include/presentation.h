@@ -0,0 +1,34 @@
+#ifndef PRESENTATION_H_
+#define PRESENTATION_H_
+
+// Presentation of the simulation.
+//
+// The simulation (atoms, neutrons, player, camera, world) doesn't depend on SDL and is built as
+// its own library. The presentation takes its textures from the texture cache, reads the simulation
+// state to draw it and turns the simulation events into sounds. It never modifies the simulation.
+
+struct atom_system_o;
+struct audio_system_o;
+struct camera_o;
+struct player_o;
+struct texture_cache_o;
+struct tuning_t;
+struct SDL_Renderer;
+
+struct presentation_o;
+
+struct presentation_o* presentation_create(struct texture_cache_o*);
+void presentation_destroy(struct presentation_o*);
+// Sizes of the player and the neutrons, `tuning_default` until then.
+void presentation_set_tuning(struct presentation_o*, const struct tuning_t*);
+
+// Plays the sounds of the events of the last atom update, must be called after every update.
+void presentation_play_sounds(struct audio_system_o*, const struct atom_system_o*);
+void presentation_draw(
+    struct presentation_o*,
+    struct SDL_Renderer*,
+    struct camera_o*,
+    const struct player_o*,
+    const struct atom_system_o*);
+
+#endif // PRESENTATION_H_
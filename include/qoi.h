@@ -0,0 +1,48 @@
+#ifndef QOI_H_
+#define QOI_H_
+
+// Lossless image codec of the QOI format (https://qoiformat.org), compatible with its reference
+// implementation so that any tool exporting QOI can produce assets.
+//
+// Images are about as small as PNG for the game assets and load faster than the BMPs overall since
+// there is less to read and no format conversion left. Noisy images with few runs still decode
+// slower per pixel than a BMP is copied. Pixels are decoded as `0xAARRGGBB` words, the layout of
+// `SDL_PIXELFORMAT_ARGB8888` (and `RGB888` for opaque images) that the renderers upload as is. The
+// decoder writes straight into the destination, a surface or a locked texture, with any pitch.
+//
+// The stream is a sequence of byte-sized operations each depending on the previous pixel, only the
+// runs of identical pixels can be written several at once. They are filled with SSE2 or NEON,
+// the baselines of x86-64 and arm64, there is nothing wider to dispatch to: runs are a few pixels
+// long on average.
+//
+// SDL-free so that the offline converter and the benchmarks can use it.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Larger images are refused, the reference implementation does the same.
+static const uint32_t QOI_MAX_PIXELS = 400000000;
+
+typedef struct qoi_desc_t qoi_desc_t;
+
+struct qoi_desc_t
+{
+    uint32_t width;
+    uint32_t height;
+    // 3 when the image is opaque, 4 otherwise. The decoded pixels always have an alpha.
+    uint8_t channels;
+    // 0 for sRGB with linear alpha, 1 for all linear. Informative only.
+    uint8_t colorspace;
+};
+
+// False when `data` doesn't start with a valid header.
+bool qoi_read_header(const void* data, size_t size, qoi_desc_t*);
+// Decodes into `height` rows of `pitch` bytes, `pitch` being at least `4 * width`. False when the
+// data is truncated or invalid, the pixels are then left partly written.
+bool qoi_decode(const void* data, size_t size, uint32_t* pixels, uint32_t pitch);
+// Encodes `0xAARRGGBB` pixels into a buffer allocated with the display tag, freed with `mem_free`.
+// The alpha is ignored when `desc.channels` is 3.
+void* qoi_encode(const uint32_t* pixels, uint32_t pitch, qoi_desc_t desc, size_t* size);
+
+#endif // QOI_H_
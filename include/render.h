@@ -2,15 +2,43 @@
 #define RENDER_H_
 
 #include "linalg.h"
+#include "qoi.h"
 
 #include <SDL2/SDL_rect.h>
 
+#include <stdbool.h>
+#include <stddef.h>
+
 struct camera_o;
 
+struct SDL_Surface;
 struct SDL_Texture;
 struct SDL_Renderer;
 
-struct SDL_Texture* load_bmp_to_texture(struct SDL_Renderer*, const char* file);
+typedef struct image_t image_t;
+
+// An image read from disk and not uploaded yet. QOI images are kept encoded and decoded straight
+// into the memory of their texture, BMP images are loaded to a surface.
+struct image_t
+{
+    // The whole QOI file, NULL for a BMP.
+    void* qoi;
+    size_t qoi_size;
+    qoi_desc_t desc;
+    struct SDL_Surface* surface;
+};
+
+// Images are named by their BMP. The QOI image converted from it (built by `make`, same name with
+// the `.qoi` extension) is read instead unless the BMP was modified since, see `qoi.h`.
+// Doesn't need the renderer and can run on any thread, false when the image can't be read.
+bool load_image(const char* file, image_t*);
+void image_free(image_t*);
+// Frees the image, NULL when it is empty or couldn't be uploaded. `file` is only for the errors.
+struct SDL_Texture* image_to_texture(struct SDL_Renderer*, image_t*, const char* file);
+// Uploads the image in an existing texture of the same size and frees it. False when it failed,
+// `file` is only for the errors.
+bool image_update_texture(struct SDL_Texture*, image_t*, const char* file);
+struct SDL_Texture* load_image_to_texture(struct SDL_Renderer*, const char* file);
 
 // Take the min/max from the bounding box in world space and convert them to screen space.
 // Then compute the SDL_Rect used for drawing the box.
@@ -0,0 +1,228 @@
+// C generational slot map.
+//
+// == References ==
+//
+// Slot maps as described by Allan Deutsch and used in a lot of game engines.
+// https://www.youtube.com/watch?v=SHaAR7XPtNU
+//
+// == Documentation ==
+//
+// A slot map stores elements densely (in an `array.h` array) and hands out 32-bit handles that
+// stay valid no matter how elements are moved around in the dense storage. A handle packs a slot
+// index and a generation: removing an element bumps the generation of its slot so any handle that
+// still refers to it is detected as stale instead of silently aliasing another element.
+//
+// The dense array is a plain `array.h` array declared by the user next to a `slot_map_t`. It can
+// be iterated like any other array, for example `for (T* e = data; e < array_end(data); e++)`.
+// The dense array *MUST* only be modified through the slot map API.
+//
+// `slot_map_insert(map, data, element) -> (slot_handle_t)`
+// Append `element` to the dense array and returns a handle on it. Freed slots are reused first.
+//
+// `slot_map_remove(map, data, handle) -> (void)`
+// Removes the element referenced by `handle`. The handle *MUST* be valid. The last element of the
+// dense array is moved in place of the removed one so when removing while iterating over the dense
+// array the current index must not be incremented.
+//
+// `slot_map_release(map, handle) -> (uint32_t)`
+// Lower level removal for elements split across several parallel dense arrays (structure of
+// arrays). Frees the slot of `handle` and returns the dense index of its element. The element
+// must then be removed from every dense array with `slot_map_move_last`. Insertion is done by
+// pushing to the other dense arrays alongside `slot_map_insert`.
+//
+// `slot_map_move_last(data, index) -> (void)`
+// Moves the last element of the dense array `data` to `index` and shrinks the array by one.
+//
+// `slot_map_get(map, data, handle) -> (element*)`
+// Returns a pointer on the element referenced by `handle` or `NULL` if the handle is stale.
+// The pointer is invalidated by any insertion or removal.
+//
+// `slot_map_valid(map, handle) -> (bool)`
+// Returns `true` if `handle` references a live element.
+//
+// `slot_map_handle_at(map, index) -> (slot_handle_t)`
+// Returns the handle of the element at `index` in the dense array.
+//
+// `slot_map_reserve(map, data, size) -> (void)`
+// Reserve storage for at least `size` elements so that no allocation happens before that.
+//
+// `slot_map_clear(map, data) -> (void)`
+// Removes all elements. Every handle given so far becomes stale. Storage is kept.
+//
+// `slot_map_free(map, data) -> (void)`
+// Release all the memory allocated for the slot map and its dense array.
+//
+// == Usage example ==
+//
+// ```c
+// slot_map_t map = {0};
+// int* data = NULL; // Dense storage.
+// slot_handle_t a = slot_map_insert(&map, data, 12);
+// slot_handle_t b = slot_map_insert(&map, data, 15);
+// slot_map_remove(&map, data, a); // `15` is moved to the front of `data`, `b` is still valid.
+// assert(*slot_map_get(&map, data, b) == 15 && !slot_map_valid(&map, a));
+// slot_map_free(&map, data);
+// ```
+
+#ifndef SLOT_MAP_H_
+#define SLOT_MAP_H_
+
+#include "array.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Handles are 20 bits of slot index and 12 bits of generation. The generation never is 0 so the
+// null handle is always invalid.
+typedef uint32_t slot_handle_t;
+
+#define SLOT_HANDLE_NULL ((slot_handle_t)0)
+#define SLOT_MAP_INDEX_BITS 20
+#define SLOT_MAP_MAX_SLOTS (1u << SLOT_MAP_INDEX_BITS)
+
+typedef struct slot_map_t slot_map_t;
+
+struct slot_map_t
+{
+    // When the slot is alive `index` is the position of the element in the dense array otherwise
+    // it is the next free slot.
+    /* array */ struct _slot_t* _slots;
+    /* array */ uint32_t* _dense_to_slot;
+    uint32_t _free_head;
+    uint32_t _num_free;
+};
+
+// Public API.
+
+#define slot_map_insert(M, D, X) (array_push(D, X), _slot_map_alloc(M, (uint32_t)array_size(D) - 1))
+#define slot_map_remove(M, D, H) slot_map_move_last(D, _slot_map_release(M, H))
+#define slot_map_release(M, H) _slot_map_release(M, H)
+#define slot_map_move_last(D, I) ((D)[I] = (D)[array_size(D) - 1], array_pop(D))
+#define slot_map_get(M, D, H) (slot_map_valid(M, H) ? &(D)[_slot_map_index(M, H)] : NULL)
+#define slot_map_valid(M, H) _slot_map_valid(M, H)
+#define slot_map_handle_at(M, I) _slot_map_handle_at(M, I)
+#define slot_map_reserve(M, D, N) (array_reserve(D, N), _slot_map_reserve(M, N))
+#define slot_map_clear(M, D) (_slot_map_clear(M), array_clear(D))
+#define slot_map_free(M, D) (_slot_map_free(M), array_free(D))
+
+// -----------------------------------------------------------------------------
+// Implementation details.
+// -----------------------------------------------------------------------------
+
+struct _slot_t
+{
+    uint32_t index;
+    uint32_t generation;
+};
+
+#define _SLOT_MAP_GENERATION_MASK ((1u << (32 - SLOT_MAP_INDEX_BITS)) - 1)
+#define _slot_handle(S, G) ((slot_handle_t)(((G) << SLOT_MAP_INDEX_BITS) | (S)))
+#define _slot_handle_slot(H) ((H) & (SLOT_MAP_MAX_SLOTS - 1))
+#define _slot_handle_generation(H) ((H) >> SLOT_MAP_INDEX_BITS)
+
+static inline uint32_t _slot_map_next_generation(uint32_t generation)
+{
+    generation = (generation + 1) & _SLOT_MAP_GENERATION_MASK;
+    return generation == 0 ? 1 : generation;
+}
+
+static inline bool _slot_map_valid(const slot_map_t* map, slot_handle_t handle)
+{
+    const uint32_t slot = _slot_handle_slot(handle);
+    return slot < array_size(map->_slots)
+        && map->_slots[slot].generation == _slot_handle_generation(handle);
+}
+
+static inline uint32_t _slot_map_index(const slot_map_t* map, slot_handle_t handle)
+{
+    return map->_slots[_slot_handle_slot(handle)].index;
+}
+
+static inline slot_handle_t _slot_map_handle_at(const slot_map_t* map, uint32_t index)
+{
+    assert(index < array_size(map->_dense_to_slot) && "Slot map out of bounds.");
+    const uint32_t slot = map->_dense_to_slot[index];
+    return _slot_handle(slot, map->_slots[slot].generation);
+}
+
+static inline slot_handle_t _slot_map_alloc(slot_map_t* map, uint32_t index)
+{
+    uint32_t slot;
+
+    if (map->_num_free > 0)
+    {
+        slot = map->_free_head;
+        map->_free_head = map->_slots[slot].index;
+        map->_num_free--;
+    }
+    else
+    {
+        slot = (uint32_t)array_size(map->_slots);
+        assert(slot < SLOT_MAP_MAX_SLOTS && "slot_map.h: too many slots.");
+        array_push(map->_slots, ((struct _slot_t){.generation = 1}));
+    }
+
+    map->_slots[slot].index = index;
+    array_push(map->_dense_to_slot, slot);
+
+    return _slot_handle(slot, map->_slots[slot].generation);
+}
+
+// Frees the slot referenced by `handle` and patch the slot of the last dense element which is
+// about to be moved. Returns the dense index of the removed element.
+static inline uint32_t _slot_map_release(slot_map_t* map, slot_handle_t handle)
+{
+    assert(_slot_map_valid(map, handle) && "slot_map.h: stale handle.");
+
+    const uint32_t slot = _slot_handle_slot(handle);
+    const uint32_t index = map->_slots[slot].index;
+    const uint32_t last_slot = map->_dense_to_slot[array_size(map->_dense_to_slot) - 1];
+
+    map->_slots[last_slot].index = index;
+    map->_dense_to_slot[index] = last_slot;
+    array_pop(map->_dense_to_slot);
+
+    map->_slots[slot].generation = _slot_map_next_generation(map->_slots[slot].generation);
+    map->_slots[slot].index = map->_free_head;
+    map->_free_head = slot;
+    map->_num_free++;
+
+    return index;
+}
+
+static inline void _slot_map_reserve(slot_map_t* map, size_t size)
+{
+    array_reserve(map->_slots, size);
+    array_reserve(map->_dense_to_slot, size);
+}
+
+static inline void _slot_map_clear(slot_map_t* map)
+{
+    for (uint32_t i = 0; i < array_size(map->_dense_to_slot); ++i)
+    {
+        struct _slot_t* slot = &map->_slots[map->_dense_to_slot[i]];
+        slot->generation = _slot_map_next_generation(slot->generation);
+    }
+
+    // Rebuild the free list from scratch, all the slots are free now.
+    const uint32_t num_slots = (uint32_t)array_size(map->_slots);
+    for (uint32_t i = 0; i < num_slots; ++i)
+    {
+        map->_slots[i].index = i + 1;
+    }
+    map->_free_head = 0;
+    map->_num_free = num_slots;
+
+    array_clear(map->_dense_to_slot);
+}
+
+static inline void _slot_map_free(slot_map_t* map)
+{
+    array_free(map->_slots);
+    array_free(map->_dense_to_slot);
+    map->_free_head = 0;
+    map->_num_free = 0;
+}
+
+#endif // SLOT_MAP_H_
@@ -0,0 +1,138 @@
+// C wait-free single-producer/single-consumer queue.
+//
+// == References ==
+//
+// The classic Lamport ring buffer with cached indices, as described by Erik Rigtorp.
+// https://rigtorp.se/ringbuffer/
+//
+// == Documentation ==
+//
+// A fixed capacity ring buffer of fixed size elements shared by exactly two threads: one only
+// pushes, the other one only pops. Neither of them ever blocks or takes a lock so it can be used
+// to talk to realtime threads such as the audio callback. Elements are copied in and out.
+//
+// `spsc_queue_init(queue, element_size, capacity, tag) -> (void)`
+// Allocates the storage with `tag`. The capacity *MUST* be a power of two. This must be done before
+// the queue is shared between threads.
+//
+// `spsc_queue_free(queue) -> (void)`
+// Release the storage. None of the threads must use the queue anymore.
+//
+// `spsc_queue_push(queue, element) -> (bool)`
+// Producer only. Copies `element` at the back of the queue. Returns `false` and drops the element
+// when the queue is full.
+//
+// `spsc_queue_pop(queue, element) -> (bool)`
+// Consumer only. Copies the front element in `element` and removes it. Returns `false` when the
+// queue is empty.
+//
+// == Usage example ==
+//
+// ```c
+// spsc_queue_t queue;
+// spsc_queue_init(&queue, sizeof(int), 64, MEMORY_TAG_MISC);
+// int x = 12;
+// spsc_queue_push(&queue, &x); // On the producer thread.
+// int y;
+// while (spsc_queue_pop(&queue, &y)) {} // On the consumer thread.
+// spsc_queue_free(&queue);
+// ```
+
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+#include "allocator.h"
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// Indices written by each thread are kept a cache line apart. Padding is used rather than
+// `_Alignas` because queues are embedded in heap allocated systems which are only aligned on
+// `max_align_t`.
+#define _SPSC_CACHE_LINE 64
+
+typedef struct spsc_queue_t spsc_queue_t;
+
+struct spsc_queue_t
+{
+    // Read-only once initialized.
+    uint8_t* _data;
+    uint32_t _element_size;
+    uint32_t _mask;
+
+    uint8_t _pad0[_SPSC_CACHE_LINE];
+
+    // Written by the consumer. Indices grow forever and wrap around `UINT32_MAX`.
+    _Atomic uint32_t _head;
+    uint32_t _cached_tail;
+
+    uint8_t _pad1[_SPSC_CACHE_LINE];
+
+    // Written by the producer.
+    _Atomic uint32_t _tail;
+    uint32_t _cached_head;
+
+    uint8_t _pad2[_SPSC_CACHE_LINE];
+};
+
+static inline void spsc_queue_init(
+    spsc_queue_t* queue, uint32_t element_size, uint32_t capacity, enum MemoryTag tag)
+{
+    assert(capacity > 0 && (capacity & (capacity - 1)) == 0 && "spsc_queue.h: capacity must be a power of two.");
+
+    queue->_data = mem_alloc(tag, (size_t)element_size * capacity);
+    queue->_element_size = element_size;
+    queue->_mask = capacity - 1;
+    atomic_init(&queue->_head, 0);
+    atomic_init(&queue->_tail, 0);
+    queue->_cached_head = 0;
+    queue->_cached_tail = 0;
+}
+
+static inline void spsc_queue_free(spsc_queue_t* queue)
+{
+    mem_free(queue->_data);
+    queue->_data = NULL;
+}
+
+static inline bool spsc_queue_push(spsc_queue_t* queue, const void* element)
+{
+    const uint32_t tail = atomic_load_explicit(&queue->_tail, memory_order_relaxed);
+
+    // Only reload the consumer index when the queue looks full from the last known one.
+    if (tail - queue->_cached_head > queue->_mask)
+    {
+        queue->_cached_head = atomic_load_explicit(&queue->_head, memory_order_acquire);
+        if (tail - queue->_cached_head > queue->_mask)
+        {
+            return false;
+        }
+    }
+
+    memcpy(queue->_data + (size_t)(tail & queue->_mask) * queue->_element_size, element, queue->_element_size);
+    atomic_store_explicit(&queue->_tail, tail + 1, memory_order_release);
+    return true;
+}
+
+static inline bool spsc_queue_pop(spsc_queue_t* queue, void* element)
+{
+    const uint32_t head = atomic_load_explicit(&queue->_head, memory_order_relaxed);
+
+    if (head == queue->_cached_tail)
+    {
+        queue->_cached_tail = atomic_load_explicit(&queue->_tail, memory_order_acquire);
+        if (head == queue->_cached_tail)
+        {
+            return false;
+        }
+    }
+
+    memcpy(element, queue->_data + (size_t)(head & queue->_mask) * queue->_element_size, queue->_element_size);
+    atomic_store_explicit(&queue->_head, head + 1, memory_order_release);
+    return true;
+}
+
+#endif // SPSC_QUEUE_H_
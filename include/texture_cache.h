@@ -0,0 +1,33 @@
+#ifndef TEXTURE_CACHE_H_
+#define TEXTURE_CACHE_H_
+
+// Textures shared by every screen of the game.
+//
+// A texture is loaded the first time it is asked for and kept until the cache is destroyed, so
+// going back and forth between screens never loads anything again. Textures belong to the cache,
+// users must not destroy them.
+
+#include <stdbool.h>
+
+struct SDL_Renderer;
+struct SDL_Texture;
+struct image_t;
+
+struct texture_cache_o;
+
+struct texture_cache_o* texture_cache_create(struct SDL_Renderer*);
+void texture_cache_destroy(struct texture_cache_o*);
+
+// Loads the image at `path` on the first call (see `load_image`). NULL when it can't be loaded, which is only reported
+// and tried once.
+struct SDL_Texture* texture_cache_get(struct texture_cache_o*, const char* path);
+// Uploads an image already read from `path`, so that images can be read on another thread while
+// the renderer is created. Takes ownership of the image, an empty one is cached as a failed load.
+// Does nothing when `path` is already cached.
+void texture_cache_add(struct texture_cache_o*, const char* path, struct image_t*);
+// Hot reload, see `hot_reload.h`. Uploads the new image of `path` in its existing texture so users
+// keep their pointer, and takes ownership of the image. False when `path` isn't cached or the
+// image changed size, which needs a restart.
+bool texture_cache_reload(struct texture_cache_o*, const char* path, struct image_t*);
+
+#endif // TEXTURE_CACHE_H_
@@ -0,0 +1,32 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+// Fixed set of worker threads running data parallel loops.
+//
+// `thread_pool_for` splits a range of indices in blocks that the workers and the calling thread
+// take in turn until none is left, and only returns once every block is done. Blocks are taken
+// dynamically so a slow block doesn't hold the others back. The pool only runs one loop at a
+// time and must be used from a single thread.
+//
+// It is part of the simulation library and uses POSIX threads rather than the SDL (winpthreads on
+// Windows).
+
+#include <stdint.h>
+
+struct thread_pool_o;
+
+// Processes the indices `[begin, end)`. `thread` is 0 on the calling thread and `1 + i` on the
+// worker `i`, to index per thread scratch memory.
+typedef void (*thread_pool_fn_t)(void* user, uint32_t begin, uint32_t end, uint32_t thread);
+
+// `num_workers` threads are started besides the calling one, with 0 the loops run on the caller
+// only.
+struct thread_pool_o* thread_pool_create(uint32_t num_workers);
+void thread_pool_destroy(struct thread_pool_o*);
+uint32_t thread_pool_num_workers(const struct thread_pool_o*);
+
+// Calls `fn` over `[0, count)` in blocks of at most `block_size` indices.
+void thread_pool_for(
+    struct thread_pool_o*, thread_pool_fn_t fn, void* user, uint32_t count, uint32_t block_size);
+
+#endif // THREAD_POOL_H_
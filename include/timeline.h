@@ -0,0 +1,24 @@
+#ifndef TIMELINE_H_
+#define TIMELINE_H_
+
+// Timeline of the startup, for profiling.
+//
+// Phases are timed with the performance counter relative to `timeline_start` and can be recorded
+// from any thread, phases running in parallel overlap in the report. Recording is a couple of
+// atomic operations and never allocates, phases past `TIMELINE_MAX_PHASES` are dropped.
+
+#include <stdint.h>
+#include <stdio.h>
+
+enum { TIMELINE_MAX_PHASES = 32 };
+
+// Origin of the timestamps, called first thing in `main`.
+void timeline_start(void);
+// `name` must outlive the timeline, usually a string literal.
+uint32_t timeline_begin(const char* name);
+void timeline_end(uint32_t phase);
+
+// Must not be called while phases are recorded on other threads.
+void timeline_report(FILE*);
+
+#endif // TIMELINE_H_
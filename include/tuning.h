@@ -0,0 +1,102 @@
+#ifndef TUNING_H_
+#define TUNING_H_
+
+// Gameplay constants read from a tuning file instead of being compiled in.
+//
+// The file is parsed once into a flat `tuning_t` and the systems keep their own copy (see the
+// `*_set_tuning` functions), the hot paths read plain fields and never parse anything. The game
+// loads `assets/tuning.txt` at startup and again when it changes, headless runs fill the structure
+// themselves or load their own files, so balancing sweeps don't need to recompile.
+//
+// The file has one `name = value` per line, `#` starts a comment, and vectors are two numbers
+// separated by spaces:
+//
+// ```
+// # Half extents of the atoms.
+// atom_size = 100
+// player_size = 60 40
+// ```
+//
+// Missing names keep their current value. Unknown names and values out of range are reported and
+// skipped, the rest of the file still applies.
+
+#include "atom.h"
+#include "linalg.h"
+#include "world.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct tuning_t tuning_t;
+
+struct tuning_t
+{
+    // Atoms and neutrons, sizes are half extents.
+    float atom_size;
+    float neutron_size;
+    // Neutrons an atom emits before being stable, it applies to the atoms generated afterwards.
+    uint32_t atom_neutrons;
+    // Wobbling of the unstable atoms, in radians per ms.
+    float atom_wobble_speed;
+    // Nothing is emitted during this long after a new game starts.
+    float preparation_ms;
+
+    // Half extents, the bounding circle of the player has the horizontal one as radius.
+    vec2_t player_size;
+    // Speed kept from one update to the next once the button is released.
+    float player_slowdown;
+    // Speed as a fraction of the distance to the target, up to `PLAYER_MAX_SPEED`.
+    float player_follow;
+    // Camera speed as a fraction of its distance to the player.
+    float camera_follow;
+
+    // World of a new game, see `world_t`.
+    float chunk_size;
+    int32_t active_radius;
+
+    // Chain reactions, see `chain_reaction_t`.
+    bool chain_reaction;
+    float chain_cross_section;
+    uint32_t chain_fission_neutrons;
+    uint32_t chain_max_cascade_fissions;
+    uint32_t chain_max_cascade_depth;
+
+    // Stabilized atoms to win a game, 0 to never win.
+    uint32_t stable_atoms_to_win;
+};
+
+typedef struct tuning_stamp_t tuning_stamp_t;
+
+// Size and modification time of the file at the last load.
+struct tuning_stamp_t
+{
+    int64_t size;
+    int64_t mtime;
+};
+
+// The values the game was balanced with.
+tuning_t tuning_default(void);
+// Maps `path` and applies its values over `tuning`. False when the file can't be read or the
+// values don't fit together (atoms larger than the chunks), `tuning` is then left untouched.
+// `stamp` may be NULL.
+bool tuning_load(const char* path, tuning_t*, tuning_stamp_t* stamp);
+// The file was modified since `stamp`, it only costs a `stat`.
+bool tuning_changed(const char* path, tuning_stamp_t stamp);
+
+static inline world_t tuning_world(const tuning_t* tuning, uint64_t seed)
+{
+    return (world_t){.seed = seed, .chunk_size = tuning->chunk_size, .active_radius = tuning->active_radius};
+}
+
+static inline chain_reaction_t tuning_chain_reaction(const tuning_t* tuning)
+{
+    return (chain_reaction_t){
+        .enabled = tuning->chain_reaction,
+        .cross_section = tuning->chain_cross_section,
+        .fission_neutrons = tuning->chain_fission_neutrons,
+        .max_cascade_fissions = tuning->chain_max_cascade_fissions,
+        .max_cascade_depth = tuning->chain_max_cascade_depth,
+    };
+}
+
+#endif // TUNING_H_
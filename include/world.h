@@ -1,19 +1,82 @@
 #ifndef WORLD_H_
 #define WORLD_H_
 
+// Unbounded world split into square chunks.
+//
+// The content of a chunk only depends on the world seed and the chunk coordinate so chunks can be
+// generated lazily, in any order, and generated again identically after being dropped. Only the
+// chunks around the camera are simulated (see `atom_system_stream`), memory and update cost
+// depend on that area and not on how far the player went.
+
+#include "linalg.h"
+
+#include <math.h>
+#include <stdint.h>
+
+typedef struct chunk_coord_t chunk_coord_t;
+
+struct chunk_coord_t
+{
+    int32_t x;
+    int32_t y;
+};
+
 typedef struct world_t world_t;
 
 struct world_t
 {
-    struct
-    {
-        float north;
-        float south;
-        float east;
-        float west;
-    } bounds;
+    uint64_t seed;
+    float chunk_size;
+    // Chunks within this many chunks of the camera chunk (on both axes) are active. Active chunks
+    // are only evicted once they are one more chunk away so that going back and forth over a chunk
+    // border doesn't generate and evict the same chunks again and again.
+    int32_t active_radius;
 };
 
-#endif // WORLD_H_
+static inline chunk_coord_t world_chunk_at(world_t world, vec2_t pos)
+{
+    return (chunk_coord_t){(int32_t)floorf(pos.x / world.chunk_size), (int32_t)floorf(pos.y / world.chunk_size)};
+}
 
+static inline bbox2_t world_chunk_bounds(world_t world, chunk_coord_t chunk)
+{
+    const vec2_t min = {chunk.x * world.chunk_size, chunk.y * world.chunk_size};
+    return (bbox2_t){min, {min.x + world.chunk_size, min.y + world.chunk_size}};
+}
 
+// Chebyshev distance, the number of chunks to cross on the longest axis.
+static inline int32_t world_chunk_distance(chunk_coord_t a, chunk_coord_t b)
+{
+    const int32_t dx = a.x > b.x ? a.x - b.x : b.x - a.x;
+    const int32_t dy = a.y > b.y ? a.y - b.y : b.y - a.y;
+    return dx > dy ? dx : dy;
+}
+
+static inline uint64_t world_chunk_key(chunk_coord_t chunk)
+{
+    return ((uint64_t)(uint32_t)chunk.x << 32) | (uint32_t)chunk.y;
+}
+
+// splitmix64, good enough to derive independent streams from close seeds.
+static inline uint64_t world_random_next(uint64_t* state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [0, 1).
+static inline float world_random_float(uint64_t* state)
+{
+    return (float)(world_random_next(state) >> 40) / (float)(1u << 24);
+}
+
+// Initial state of the random generator of a chunk.
+static inline uint64_t world_chunk_seed(world_t world, chunk_coord_t chunk)
+{
+    uint64_t state = world.seed ^ world_chunk_key(chunk);
+    return world_random_next(&state);
+}
+
+#endif // WORLD_H_
@@ -0,0 +1,216 @@
+#include "allocator.h"
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+static const char* tag_names[_MEMORY_TAG_COUNT] = {
+    "misc",
+    "atom",
+    "player",
+    "camera",
+    "audio",
+    "display",
+};
+
+// Prepended to every allocation so that frees know the size and tag of the block. The union keeps
+// the user pointer aligned as malloc would.
+typedef union block_header_t
+{
+    struct
+    {
+        size_t size;
+        uint32_t tag;
+    };
+    max_align_t _align;
+} block_header_t;
+
+typedef struct tag_stats_t
+{
+    atomic_size_t live_bytes;
+    atomic_size_t peak_bytes;
+    atomic_size_t total_bytes;
+    atomic_uint_fast64_t num_allocs;
+    atomic_uint_fast64_t num_frees;
+} tag_stats_t;
+
+// Stats can be updated from any thread (audio and loading threads allocate too).
+static tag_stats_t stats[_MEMORY_TAG_COUNT];
+
+#define TAG_STACK_SIZE 16
+static _Thread_local enum MemoryTag tag_stack[TAG_STACK_SIZE];
+static _Thread_local uint32_t tag_stack_size = 0;
+
+#ifndef NDEBUG
+static _Thread_local uint32_t forbid_depth = 0;
+static _Thread_local const char* forbid_name = NULL;
+#endif
+
+static void check_allocation_allowed(size_t size, enum MemoryTag tag)
+{
+#ifndef NDEBUG
+    if (forbid_depth > 0)
+    {
+        fprintf(stderr, "Allocation of %zu bytes (%s) inside no-allocation scope '%s'.\n",
+            size, tag_names[tag], forbid_name);
+        assert(!"allocator.c: allocation inside a no-allocation scope.");
+    }
+#else
+    (void)size;
+    (void)tag;
+#endif
+}
+
+static void record_alloc(enum MemoryTag tag, size_t size)
+{
+    tag_stats_t* s = &stats[tag];
+    const size_t live = atomic_fetch_add(&s->live_bytes, size) + size;
+    atomic_fetch_add(&s->total_bytes, size);
+    atomic_fetch_add(&s->num_allocs, 1);
+
+    size_t peak = atomic_load(&s->peak_bytes);
+    while (live > peak && !atomic_compare_exchange_weak(&s->peak_bytes, &peak, live)) {}
+}
+
+static void record_free(enum MemoryTag tag, size_t size)
+{
+    atomic_fetch_sub(&stats[tag].live_bytes, size);
+    atomic_fetch_add(&stats[tag].num_frees, 1);
+}
+
+void* mem_alloc(enum MemoryTag tag, size_t size)
+{
+    return mem_realloc(tag, NULL, size);
+}
+
+void* mem_realloc(enum MemoryTag tag, void* ptr, size_t size)
+{
+    assert((uint32_t)tag < _MEMORY_TAG_COUNT);
+
+    block_header_t* header = ptr ? (block_header_t*)ptr - 1 : NULL;
+    const size_t old_size = header ? header->size : 0;
+    if (header)
+    {
+        tag = header->tag;
+    }
+
+    check_allocation_allowed(size, tag);
+
+    header = realloc(header, sizeof(block_header_t) + size);
+    if (!header)
+    {
+        return NULL;
+    }
+
+    if (old_size)
+    {
+        record_free(tag, old_size);
+    }
+    record_alloc(tag, size);
+
+    header->size = size;
+    header->tag = tag;
+    return header + 1;
+}
+
+void mem_free(void* ptr)
+{
+    if (!ptr) return;
+
+    block_header_t* header = (block_header_t*)ptr - 1;
+    record_free(header->tag, header->size);
+    free(header);
+}
+
+void mem_push_tag(enum MemoryTag tag)
+{
+    assert(tag_stack_size < TAG_STACK_SIZE && "allocator.c: tag stack overflow.");
+    tag_stack[tag_stack_size++] = tag;
+}
+
+void mem_pop_tag(void)
+{
+    assert(tag_stack_size > 0 && "allocator.c: tag stack underflow.");
+    tag_stack_size--;
+}
+
+enum MemoryTag mem_current_tag(void)
+{
+    return tag_stack_size > 0 ? tag_stack[tag_stack_size - 1] : MEMORY_TAG_MISC;
+}
+
+mem_stats_t mem_stats(enum MemoryTag tag)
+{
+    assert((uint32_t)tag < _MEMORY_TAG_COUNT);
+
+    const tag_stats_t* s = &stats[tag];
+    return (mem_stats_t){
+        .live_bytes = atomic_load(&s->live_bytes),
+        .peak_bytes = atomic_load(&s->peak_bytes),
+        .total_bytes = atomic_load(&s->total_bytes),
+        .num_allocs = atomic_load(&s->num_allocs),
+        .num_frees = atomic_load(&s->num_frees),
+    };
+}
+
+mem_stats_t mem_stats_total(void)
+{
+    // The total peak is the sum of the per tag peaks which is an upper bound of the real one.
+    mem_stats_t total = {0};
+    for (uint32_t i = 0; i < _MEMORY_TAG_COUNT; ++i)
+    {
+        const mem_stats_t s = mem_stats((enum MemoryTag)i);
+        total.live_bytes += s.live_bytes;
+        total.peak_bytes += s.peak_bytes;
+        total.total_bytes += s.total_bytes;
+        total.num_allocs += s.num_allocs;
+        total.num_frees += s.num_frees;
+    }
+    return total;
+}
+
+const char* mem_tag_name(enum MemoryTag tag)
+{
+    assert((uint32_t)tag < _MEMORY_TAG_COUNT);
+    return tag_names[tag];
+}
+
+void mem_report(FILE* out)
+{
+    fprintf(out, "%-10s %12s %12s %14s %10s %10s\n",
+        "tag", "live (B)", "peak (B)", "total (B)", "allocs", "frees");
+
+    for (uint32_t i = 0; i < _MEMORY_TAG_COUNT; ++i)
+    {
+        const mem_stats_t s = mem_stats((enum MemoryTag)i);
+        fprintf(out, "%-10s %12zu %12zu %14zu %10llu %10llu\n",
+            tag_names[i], s.live_bytes, s.peak_bytes, s.total_bytes,
+            (unsigned long long)s.num_allocs, (unsigned long long)s.num_frees);
+    }
+
+    const mem_stats_t total = mem_stats_total();
+    fprintf(out, "%-10s %12zu %12zu %14zu %10llu %10llu\n",
+        "total", total.live_bytes, total.peak_bytes, total.total_bytes,
+        (unsigned long long)total.num_allocs, (unsigned long long)total.num_frees);
+}
+
+void mem_forbid_begin(const char* name)
+{
+#ifndef NDEBUG
+    if (forbid_depth++ == 0)
+    {
+        forbid_name = name;
+    }
+#else
+    (void)name;
+#endif
+}
+
+void mem_forbid_end(void)
+{
+#ifndef NDEBUG
+    assert(forbid_depth > 0 && "allocator.c: unbalanced mem_forbid_end.");
+    forbid_depth--;
+#endif
+}
@@ -1,374 +1,1152 @@
 #include "atom.h"
 
-#include "audio.h"
+#include "allocator.h"
 #include "array.h"
-#include "camera.h"
 #include "linalg.h"
+#include "linalg_batch.h"
 #include "player.h"
-#include "render.h"
-
-#include <SDL2/SDL.h>
+#include "slot_map.h"
+#include "tuning.h"
 
 #include <assert.h>
+#include <math.h>
 #include <stdlib.h>
-
-// @Todo: move this somewhere else.
-static const uint32_t ATOM_SIZE = 100;
-static const uint32_t NEUTRON_SIZE = 8;
+#include <string.h>
+
+// No atom is generated this close to the world origin where the player starts.
+static const float SPAWN_CLEAR_RADIUS = 400;
+// Tries to place each atom of a chunk, the atom is skipped when they all fail.
+static const uint32_t PLACEMENT_ATTEMPTS = 16;
+// Most neutrons a single atom can have alive at once (see `emit_neutron_circle`). An enum so that
+// it can size arrays.
+enum { MAX_NEUTRONS_PER_ATOM = 8 };
+// A chunk has 1 to `MAX_ATOMS_PER_CHUNK` atoms.
+enum { MAX_ATOMS_PER_CHUNK = 4 };
+// In units per ms, they don't depend on the update step.
+static const float NEUTRON_MIN_SPEED = 0.08f;
+static const float NEUTRON_MAX_SPEED = 0.4f;
+// Neutron events are scheduled on a hashed timing wheel of `WHEEL_SLOTS` slots, one per tick of
+// `WHEEL_TICK_MS`. An event `n` ticks away waits in its slot for `n / WHEEL_SLOTS` turns.
+static const float WHEEL_TICK_MS = 16;
+enum { WHEEL_SLOTS = 1024 };
+static const uint32_t WHEEL_NONE = UINT32_MAX;
+static const uint32_t NO_CHUNK = UINT32_MAX;
 
 typedef struct atom_t atom_t;
 typedef struct atom_state_t atom_state_t;
 typedef struct neutron_t neutron_t;
+typedef struct active_chunk_t active_chunk_t;
+typedef struct dormant_chunk_t dormant_chunk_t;
+typedef struct wheel_event_t wheel_event_t;
+typedef struct cascade_t cascade_t;
 typedef struct atom_system_o atom_system_o;
 
+// Neutrons move in straight lines at constant speed, only their trajectory is stored (as structure
+// of arrays in the atom system) and positions are computed when needed. All neutrons have a
+// bounding circle of radius `tuning.neutron_size`.
 struct neutron_t
 {
-    vec2_t pos;
-    vec2_t dir;
-    float speed;
-    float bounding_circle_radius;
+    slot_handle_t atom; // Emitting atom.
+    slot_handle_t target; // Next atom on the trajectory that can capture it, if any.
+    slot_handle_t cascade;
+    uint32_t depth; // In the cascade, 0 for a spontaneous emission.
+};
+
+// Neutrons and fissions descending from a spontaneous emission. Removed with its last neutron.
+struct cascade_t
+{
+    uint32_t num_neutrons;
+    uint32_t num_fissions;
 };
 
 struct atom_state_t
 {
     uint32_t num_left;
     uint32_t num_exceeding_neutrons;
-    uint32_t unstability_duration_ms;
 };
 
 struct atom_t
 {
     vec2_t pos;
     atom_state_t state;
-    /* array */ neutron_t* neutrons;
-    void (*emit_neutron)(struct atom_t*, float);
+    uint32_t num_neutrons; // Neutrons emitted by this atom still alive.
+    void (*emit_neutron)(struct atom_system_o*, slot_handle_t, slot_handle_t cascade, circle_t player);
 };
 
-// @Todo: change the API to atom_system_o, use neutrons pool and atom pool.
-struct atom_system_o
+// Chunk being simulated, its atoms are in the atom pool.
+struct active_chunk_t
 {
-    atom_t* atoms;
-    float angle;
-    float angle_increment;
+    chunk_coord_t coord;
+    uint32_t num_atoms;
+    slot_handle_t atoms[MAX_ATOMS_PER_CHUNK];
+};
 
-    float start_time;
+// Chunk evicted after some of its atoms emitted. Only what the generation can't give back is kept,
+// chunks nobody touched are dropped and generated again when needed.
+struct dormant_chunk_t
+{
+    uint64_t key; // `world_chunk_key`
+    uint8_t num_left[MAX_ATOMS_PER_CHUNK]; // In generation order.
+};
 
-    SDL_Texture* atom_texture;
-    SDL_Texture* neutron_texture;
+// Next time a neutron needs to be looked at: when it leaves the simulated area or, before that, the
+// earliest time it could touch the player.
+struct wheel_event_t
+{
+    slot_handle_t neutron;
+    uint32_t tick;
+    uint32_t next; // Next event of the same slot, or of the free list.
 };
 
-static void emit_neutron_random(atom_t* atom, float dt)
+struct atom_system_o
 {
-    vec2_t dir = vec2_normalize((vec2_t){
-            ((float)rand() / RAND_MAX - 0.5f) * 2 * 2*PI_f,
-            ((float)rand() / RAND_MAX - 0.5f) * 2 * 2*PI_f});
+    // Atoms and neutrons pools. Elements are densely packed and referenced with stable handles.
+    /* slot map */ atom_t* atoms;
+    slot_map_t atom_map;
+    /* slot map */ neutron_t* neutrons;
+    slot_map_t neutron_map;
+    // Parallel to `neutrons`, position at `spawn_ms` and velocity in units per ms.
+    /* array */ float* neutron_origin_x;
+    /* array */ float* neutron_origin_y;
+    /* array */ float* neutron_vel_x;
+    /* array */ float* neutron_vel_y;
+    /* array */ float* neutron_spawn_ms;
+    // When the neutron leaves `simulated_bounds`.
+    /* array */ float* neutron_exit_ms;
+    // When the neutron reaches `neutron_t::target`.
+    /* array */ float* neutron_capture_ms;
+    /* slot map */ cascade_t* cascades;
+    slot_map_t cascade_map;
+
+    chain_reaction_t chain;
+    atom_metrics_t metrics;
+    uint32_t interaction_tests; // Since the previous update.
+
+    // Exactly one pending event per neutron, the pool is linked in lists by `wheel_event_t::next`.
+    /* array */ wheel_event_t* wheel_events;
+    uint32_t wheel_free;
+    uint32_t wheel_slots[WHEEL_SLOTS];
+    // Last tick processed.
+    uint32_t wheel_tick;
+    // Scratch of the neutrons whose event comes up during an update: their event, their move over
+    // the update and whether it touches the player.
+    /* array */ uint32_t* due_events;
+    /* array */ float* due_x;
+    /* array */ float* due_y;
+    /* array */ float* due_dx;
+    /* array */ float* due_dy;
+    /* array */ uint8_t* due_hit;
+    // Cleared at the start of every update.
+    /* array */ atom_event_t* events;
 
-    neutron_t neutron = {
-        .pos = atom->pos,
-        .dir = dir,
-        .speed = (((float)rand() / RAND_MAX) * 0.4f + 0.1f) * 0.05f * dt,
-        .bounding_circle_radius = NEUTRON_SIZE,
-    };
+    float angle;
+    // Sign of the wobbling, its speed comes from the tuning.
+    float angle_direction;
+
+    // Emission directions and speeds. Seeded from the world at reset so that a game only depends on
+    // its seed and inputs, and systems share no state with each other.
+    uint64_t random;
+
+    // Directions of the neutrons emitted by `emit_neutron_circle`.
+    vec2_t circle_directions[MAX_NEUTRONS_PER_ATOM];
+
+    // Simulated time since the last reset, the simulation doesn't read any clock.
+    float time_ms;
+    uint32_t num_stabilized;
+
+    tuning_t tuning;
+    // Taken from the tuning at reset, the chunks of a game must all be generated alike.
+    float atom_size;
+    uint32_t atom_neutrons;
+    world_t world;
+    bool streamed;
+    // Chunk the active chunks are centered on.
+    chunk_coord_t center;
+    // Neutrons leaving the area of the chunks that can still be active are dropped.
+    bbox2_t simulated_bounds;
+    /* array */ active_chunk_t* chunks;
+    // Sorted by key.
+    /* array */ dormant_chunk_t* dormant_chunks;
+    // Scratch grid of the chunks around the center already active, filled when streaming.
+    /* array */ uint8_t* active_grid;
+    // Index in `chunks` of the chunks within `active_radius + 1` of the center, or `NO_CHUNK`.
+    /* array */ uint32_t* chunk_lookup;
+};
 
-    array_push(atom->neutrons, neutron);
+static uint32_t wheel_tick_at(float time_ms)
+{
+    return (uint32_t)(time_ms / WHEEL_TICK_MS);
 }
 
-static void emit_neutron_circle(atom_t* atom, float dt)
+static void wheel_link(atom_system_o* as, uint32_t event_index)
 {
-    static const uint32_t NUM_EMIT = 8;
-    const float angle_step = 2*PI_f / NUM_EMIT;
-
-    for (uint32_t i = 0; i < NUM_EMIT; ++i)
-    {
-        vec2_t dir = {cosf(angle_step*i), sinf(angle_step*i)};
+    wheel_event_t* event = &as->wheel_events[event_index];
+    const uint32_t slot = event->tick % WHEEL_SLOTS;
+    event->next = as->wheel_slots[slot];
+    as->wheel_slots[slot] = event_index;
+}
 
-        neutron_t neutron = {
-            .pos = atom->pos,
-            .dir = dir,
-            .speed = (((float)rand() / RAND_MAX) * 0.4f + 0.1f) * 0.05f * dt,
-            .bounding_circle_radius = NEUTRON_SIZE,
-        };
+static void wheel_release(atom_system_o* as, uint32_t event_index)
+{
+    as->wheel_events[event_index].next = as->wheel_free;
+    as->wheel_free = event_index;
+}
 
-        array_push(atom->neutrons, neutron);
-    }
+static vec2_t neutron_position(const atom_system_o* as, uint32_t index, float time_ms)
+{
+    const float age = time_ms - as->neutron_spawn_ms[index];
+    return (vec2_t){
+        as->neutron_origin_x[index] + as->neutron_vel_x[index] * age,
+        as->neutron_origin_y[index] + as->neutron_vel_y[index] * age,
+    };
 }
 
-struct atom_system_o* atom_system_create(struct SDL_Renderer* render)
+// The trajectory must start inside `bounds`.
+static float neutron_exit_ms(const atom_system_o* as, uint32_t index, bbox2_t bounds)
 {
-    // @Note @Todo: see later about custom allocators.
-    struct atom_system_o* system = malloc(sizeof(struct atom_system_o));
-    system->atoms = NULL;
-    system->atom_texture = load_bmp_to_texture(render, "assets/images/atom.bmp");
-    system->neutron_texture = load_bmp_to_texture(render, "assets/images/neutron.bmp");
-    system->angle = 0;
-    system->angle_increment = 0.0005;
-    system->start_time = SDL_GetTicks();
+    const vec2_t origin = {as->neutron_origin_x[index], as->neutron_origin_y[index]};
+    const vec2_t vel = {as->neutron_vel_x[index], as->neutron_vel_y[index]};
 
-    return system;
+    float duration = INFINITY;
+    if (vel.x != 0)
+    {
+        duration = fminf(duration, ((vel.x > 0 ? bounds.max.x : bounds.min.x) - origin.x) / vel.x);
+    }
+    if (vel.y != 0)
+    {
+        duration = fminf(duration, ((vel.y > 0 ? bounds.max.y : bounds.min.y) - origin.y) / vel.y);
+    }
+
+    return as->neutron_spawn_ms[index] + duration;
 }
 
-void atom_system_destroy(struct atom_system_o* as)
+// Schedules the next event of the neutron at `index`, currently at `pos`. It can't be sooner than
+// the next tick.
+static void schedule_neutron(
+    atom_system_o* as, uint32_t event_index, uint32_t index, vec2_t pos, circle_t player)
 {
-    assert(as);
+    // Neither the neutron nor the player can close the gap between them faster than their
+    // speeds combined, the neutron is left alone until then.
+    const float gap = vec2_dist(pos, player.center) - player.radius - as->tuning.neutron_size;
+    const float speed = vec2_length((vec2_t){as->neutron_vel_x[index], as->neutron_vel_y[index]}) + PLAYER_MAX_SPEED;
+    const float contact_ms = as->time_ms + (gap > 0 ? gap / speed : 0);
+    const float next_ms = fminf(contact_ms, fminf(as->neutron_exit_ms[index], as->neutron_capture_ms[index]));
+    const uint32_t tick = wheel_tick_at(next_ms);
+
+    as->wheel_events[event_index].neutron = slot_map_handle_at(&as->neutron_map, index);
+    as->wheel_events[event_index].tick = tick > as->wheel_tick ? tick : as->wheel_tick + 1;
+    wheel_link(as, event_index);
+}
 
-    for (uint32_t i = 0; i < array_size(as->atoms); ++i)
+static const active_chunk_t* find_active_chunk(const atom_system_o* as, chunk_coord_t coord)
+{
+    const int32_t radius = as->world.active_radius + 1;
+    const int32_t x = coord.x - as->center.x + radius;
+    const int32_t y = coord.y - as->center.y + radius;
+    const int32_t extent = 2 * radius + 1;
+    if (x < 0 || y < 0 || x >= extent || y >= extent)
     {
-        array_free(as->atoms[i].neutrons);
+        return NULL;
     }
-    array_free(as->atoms);
 
-    SDL_DestroyTexture(as->atom_texture);
-    SDL_DestroyTexture(as->neutron_texture);
-    free(as);
+    const uint32_t chunk_index = as->chunk_lookup[y * extent + x];
+    return chunk_index != NO_CHUNK ? &as->chunks[chunk_index] : NULL;
 }
 
-void atom_system_generate_atoms(
-    struct atom_system_o* as,
-    struct player_o* player,
-    world_t world,
-    uint32_t n)
+// Finds the first unstable atom the neutron at `index` reaches after `from_ms` and before leaving
+// the simulated area. The atoms never move, only the chunks crossed by the trajectory are visited
+// (in order, a capture circle never goes over the borders of its chunk) instead of every atom.
+// Atoms the neutron is already in are ignored, starting with the one it comes from.
+static void cast_neutron(atom_system_o* as, uint32_t index, float from_ms)
 {
-    assert(as);
+    as->neutrons[index].target = SLOT_HANDLE_NULL;
+    as->neutron_capture_ms[index] = INFINITY;
 
-    as->start_time = SDL_GetTicks();
+    const vec2_t vel = {as->neutron_vel_x[index], as->neutron_vel_y[index]};
+    const float speed = vec2_length(vel);
+    const float max_t = (as->neutron_exit_ms[index] - from_ms) * speed;
+    if (!as->chain.enabled || speed == 0 || !(max_t > 0))
+    {
+        return;
+    }
 
-    const int32_t lower_x = world.bounds.west;
-    const int32_t upper_x = world.bounds.east;
-    const int32_t lower_y = world.bounds.south;
-    const int32_t upper_y = world.bounds.north;
-    atom_t* atoms = NULL; // array.
+    const ray_t ray = {neutron_position(as, index, from_ms), vec2_div_scalar(vel, speed)};
+    const float size = as->world.chunk_size;
+    chunk_coord_t cell = world_chunk_at(as->world, ray.o);
 
-    const float atom_bounding_circle_radius = sqrtf(2*ATOM_SIZE*ATOM_SIZE);
+    // Amanatides & Woo traversal: distances along the ray to the next chunk border on each axis.
+    const int32_t step_x = ray.dir.x > 0 ? 1 : -1;
+    const int32_t step_y = ray.dir.y > 0 ? 1 : -1;
+    const float delta_x = ray.dir.x != 0 ? size / fabsf(ray.dir.x) : INFINITY;
+    const float delta_y = ray.dir.y != 0 ? size / fabsf(ray.dir.y) : INFINITY;
+    float next_x = ray.dir.x != 0 ? ((cell.x + (step_x > 0)) * size - ray.o.x) / ray.dir.x : INFINITY;
+    float next_y = ray.dir.y != 0 ? ((cell.y + (step_y > 0)) * size - ray.o.y) / ray.dir.y : INFINITY;
+    float cell_t = 0;
 
-    // @Todo: this is using brute force to place atoms. Do something better! Place them using
-    // poisson-disc sampling or some spatial partionning.
-    uint32_t left = n;
-    while (left)
+    while (cell_t <= max_t)
     {
-        vec2_t candidate_pos = {
-            .x = (rand() % (upper_x - lower_x + 1)) + lower_x,
-            .y = (rand() % (upper_y - lower_y + 1)) + lower_y,
-        };
+        const active_chunk_t* chunk = find_active_chunk(as, cell);
+        float best_t = INFINITY;
+        slot_handle_t best_atom = SLOT_HANDLE_NULL;
 
-        bool valid_candidate = true;
+        for (uint32_t i = 0; chunk && i < chunk->num_atoms; ++i)
+        {
+            const atom_t* atom = slot_map_get(&as->atom_map, as->atoms, chunk->atoms[i]);
+            if (atom->state.num_left == 0)
+            {
+                continue;
+            }
 
-        const atom_t* end = atoms + array_size(atoms);
-        for (const atom_t* atom = atoms; atom < end; atom++)
+            as->interaction_tests++;
+            const circle_t capture = {atom->pos, as->chain.cross_section};
+            const ray_hit_t hit = ray_circle_intersect(ray, capture);
+            if (hit.valid && hit.t >= 0 && hit.t < best_t && !circle_contain(capture, ray.o))
+            {
+                best_t = hit.t;
+                best_atom = chunk->atoms[i];
+            }
+        }
+
+        if (best_atom != SLOT_HANDLE_NULL)
         {
-            circle_t c1 = {.center = atom->pos, .radius = atom_bounding_circle_radius};
-            circle_t c2 = {.center = candidate_pos, .radius = atom_bounding_circle_radius};
-            if (circle_intersect(c1, c2) || player_intersect_circle(player, c2))
+            if (best_t <= max_t)
             {
-                valid_candidate = false;
-                break;
+                as->neutrons[index].target = best_atom;
+                as->neutron_capture_ms[index] = from_ms + best_t / speed;
             }
+            return;
         }
 
-        if (valid_candidate)
+        if (next_x < next_y)
         {
-            atom_t atom = {
-                .pos = candidate_pos,
-                .state = {
-                    .num_left = 10,
-                    .num_exceeding_neutrons = 10,
-                    .unstability_duration_ms = 1000,
-                },
-                .neutrons = NULL,
-                .emit_neutron = rand() % 2 ? &emit_neutron_random : &emit_neutron_circle,
-            };
-            array_push(atoms, atom);
-            left--;
+            cell_t = next_x;
+            next_x += delta_x;
+            cell.x += step_x;
+        }
+        else
+        {
+            cell_t = next_y;
+            next_y += delta_y;
+            cell.y += step_y;
         }
     }
+}
 
-    if (as->atoms)
+static void spawn_neutron(
+    atom_system_o* as, slot_handle_t atom, slot_handle_t cascade, uint32_t depth,
+    vec2_t pos, vec2_t velocity, circle_t player)
+{
+    neutron_t neutron = {.atom = atom, .target = SLOT_HANDLE_NULL, .cascade = cascade, .depth = depth};
+    slot_map_insert(&as->neutron_map, as->neutrons, neutron);
+    array_push(as->neutron_origin_x, pos.x);
+    array_push(as->neutron_origin_y, pos.y);
+    array_push(as->neutron_vel_x, velocity.x);
+    array_push(as->neutron_vel_y, velocity.y);
+    array_push(as->neutron_spawn_ms, as->time_ms);
+    array_push(as->neutron_exit_ms, 0);
+    array_push(as->neutron_capture_ms, INFINITY);
+    slot_map_get(&as->cascade_map, as->cascades, cascade)->num_neutrons++;
+
+    const uint32_t index = array_size(as->neutrons) - 1;
+    as->neutron_exit_ms[index] = neutron_exit_ms(as, index, as->simulated_bounds);
+    cast_neutron(as, index, as->time_ms);
+
+    uint32_t event_index = as->wheel_free;
+    if (event_index != WHEEL_NONE)
+    {
+        as->wheel_free = as->wheel_events[event_index].next;
+    }
+    else
+    {
+        event_index = array_size(as->wheel_events);
+        array_push(as->wheel_events, (wheel_event_t){0});
+    }
+    schedule_neutron(as, event_index, index, pos, player);
+}
+
+// The event of the neutron is left in the wheel, it is dropped when it comes up (or by
+// `wheel_rebuild`) since the handle is no longer valid.
+static void despawn_neutron(atom_system_o* as, uint32_t index)
+{
+    const slot_handle_t cascade_handle = as->neutrons[index].cascade;
+    cascade_t* cascade = slot_map_get(&as->cascade_map, as->cascades, cascade_handle);
+    if (--cascade->num_neutrons == 0)
     {
-        array_free(as->atoms);
+        slot_map_remove(&as->cascade_map, as->cascades, cascade_handle);
     }
 
-    as->atoms = atoms;
+    const uint32_t i = slot_map_release(&as->neutron_map, slot_map_handle_at(&as->neutron_map, index));
+    slot_map_move_last(as->neutrons, i);
+    slot_map_move_last(as->neutron_origin_x, i);
+    slot_map_move_last(as->neutron_origin_y, i);
+    slot_map_move_last(as->neutron_vel_x, i);
+    slot_map_move_last(as->neutron_vel_y, i);
+    slot_map_move_last(as->neutron_spawn_ms, i);
+    slot_map_move_last(as->neutron_exit_ms, i);
+    slot_map_move_last(as->neutron_capture_ms, i);
 }
 
-bool atom_system_all_stable(const struct atom_system_o* as)
+// Releases the events of the neutrons despawned outside of their own event and brings forward the
+// events coming after the exit or the capture of their neutron.
+static void wheel_rebuild(atom_system_o* as)
 {
-    uint32_t num_stable_atoms = 0;
-    const atom_t* end = as->atoms + array_size(as->atoms);
-    for (const atom_t* atom = as->atoms; atom < end; atom++)
+    uint32_t pending = WHEEL_NONE;
+    for (uint32_t slot = 0; slot < WHEEL_SLOTS; ++slot)
     {
-        if (atom->state.num_left == 0)
+        uint32_t event_index = as->wheel_slots[slot];
+        as->wheel_slots[slot] = WHEEL_NONE;
+
+        while (event_index != WHEEL_NONE)
         {
-            num_stable_atoms++;
+            const uint32_t next = as->wheel_events[event_index].next;
+            as->wheel_events[event_index].next = pending;
+            pending = event_index;
+            event_index = next;
         }
     }
 
-    return num_stable_atoms == array_size(as->atoms);
+    while (pending != WHEEL_NONE)
+    {
+        wheel_event_t* event = &as->wheel_events[pending];
+        const uint32_t next = event->next;
+        const neutron_t* neutron = slot_map_get(&as->neutron_map, as->neutrons, event->neutron);
+
+        if (neutron)
+        {
+            const uint32_t i = (uint32_t)(neutron - as->neutrons);
+            const uint32_t exit_tick = wheel_tick_at(fminf(as->neutron_exit_ms[i], as->neutron_capture_ms[i]));
+            if (exit_tick < event->tick)
+            {
+                event->tick = exit_tick > as->wheel_tick ? exit_tick : as->wheel_tick + 1;
+            }
+            wheel_link(as, pending);
+        }
+        else
+        {
+            wheel_release(as, pending);
+        }
+        pending = next;
+    }
 }
 
-void atom_system_update(
-    struct atom_system_o* as,
-    struct audio_system_o* audio,
-    struct player_o* player,
-    world_t world,
-    float dt)
+static float random_neutron_speed(atom_system_o* as)
 {
-    assert(as && player);
+    return NEUTRON_MIN_SPEED + world_random_float(&as->random) * (NEUTRON_MAX_SPEED - NEUTRON_MIN_SPEED);
+}
+
+static void emit_neutron_random(
+    atom_system_o* as, slot_handle_t handle, slot_handle_t cascade, circle_t player)
+{
+    atom_t* atom = slot_map_get(&as->atom_map, as->atoms, handle);
+
+    vec2_t dir = vec2_normalize((vec2_t){
+            (world_random_float(&as->random) - 0.5f) * 2 * 2*PI_f,
+            (world_random_float(&as->random) - 0.5f) * 2 * 2*PI_f});
+    float speed = random_neutron_speed(as);
+
+    spawn_neutron(as, handle, cascade, 0, atom->pos, vec2_mul_scalar(dir, speed), player);
+    atom->num_neutrons++;
+}
 
-    uint32_t now_ms = SDL_GetTicks();
-    uint32_t elapsed_ms = now_ms - as->start_time;
-    if (elapsed_ms < 2000) // 2 sec preparation before shooting starts.
+static void emit_neutron_circle(
+    atom_system_o* as, slot_handle_t handle, slot_handle_t cascade, circle_t player)
+{
+    atom_t* atom = slot_map_get(&as->atom_map, as->atoms, handle);
+
+    for (uint32_t i = 0; i < MAX_NEUTRONS_PER_ATOM; ++i)
+    {
+        vec2_t dir = as->circle_directions[i];
+        float speed = random_neutron_speed(as);
+
+        spawn_neutron(as, handle, cascade, 0, atom->pos, vec2_mul_scalar(dir, speed), player);
+        atom->num_neutrons++;
+    }
+}
+
+// The neutron at `index` reached its target, it is absorbed either way.
+static void capture_neutron(atom_system_o* as, uint32_t index, circle_t player)
+{
+    const neutron_t neutron = as->neutrons[index];
+    const slot_handle_t handle = neutron.target;
+    atom_t* atom = slot_map_get(&as->atom_map, as->atoms, handle);
+    cascade_t* cascade = slot_map_get(&as->cascade_map, as->cascades, neutron.cascade);
+    const uint32_t num_neutrons = as->chain.fission_neutrons;
+
+    const bool split = cascade->num_fissions < as->chain.max_cascade_fissions
+        && neutron.depth < as->chain.max_cascade_depth
+        && atom->num_neutrons + num_neutrons <= MAX_NEUTRONS_PER_ATOM;
+    if (!split)
     {
         return;
     }
 
-    // @Todo: smooth things out.
-    as->angle += as->angle_increment * dt;
-    if (as->angle >= PI_4_f/2 || as->angle <= - PI_4_f/2)
+    cascade->num_fissions++;
+    as->metrics.fissions++;
+    as->metrics.total_fissions++;
+    if (cascade->num_fissions > as->metrics.largest_cascade)
+    {
+        as->metrics.largest_cascade = cascade->num_fissions;
+    }
+    if (neutron.depth + 1 > as->metrics.deepest_cascade)
     {
-        as->angle_increment = -as->angle_increment;
+        as->metrics.deepest_cascade = neutron.depth + 1;
     }
 
-    bool neutron_emitted_this_update = false;
-    bool atom_stable_this_update = false;
+    atom->state.num_left -= 1;
+    array_push(as->events, ((atom_event_t){ATOM_EVENT_FISSION, atom->pos}));
+    if (atom->state.num_left == 0)
+    {
+        array_push(as->events, ((atom_event_t){ATOM_EVENT_STABLE, atom->pos}));
+        as->num_stabilized++;
+    }
 
-    for (uint32_t i = 0; i < array_size(as->atoms); ++i)
+    vec2_t directions[MAX_NEUTRONS_PER_ATOM];
+    direction_ring(directions, num_neutrons, world_random_float(&as->random) * 2*PI_f);
+    for (uint32_t i = 0; i < num_neutrons; ++i)
     {
-        atom_t* atom = &as->atoms[i];
+        const vec2_t velocity = vec2_mul_scalar(directions[i], random_neutron_speed(as));
+        spawn_neutron(as, handle, neutron.cascade, neutron.depth + 1, atom->pos, velocity, player);
+        atom->num_neutrons++;
+    }
+}
 
-        if (array_empty(atom->neutrons) && atom->state.num_left > 0)
-        {
-            // Emit a new neutron in a random direction.
+struct atom_system_o* atom_system_create(void)
+{
+    struct atom_system_o* system = mem_alloc(MEMORY_TAG_ATOM, sizeof(struct atom_system_o));
+    system->atoms = NULL;
+    system->atom_map = (slot_map_t){0};
+    system->neutrons = NULL;
+    system->neutron_map = (slot_map_t){0};
+    system->neutron_origin_x = NULL;
+    system->neutron_origin_y = NULL;
+    system->neutron_vel_x = NULL;
+    system->neutron_vel_y = NULL;
+    system->neutron_spawn_ms = NULL;
+    system->neutron_exit_ms = NULL;
+    system->neutron_capture_ms = NULL;
+    system->cascades = NULL;
+    system->cascade_map = (slot_map_t){0};
+    system->chain = (chain_reaction_t){.enabled = false};
+    system->metrics = (atom_metrics_t){0};
+    system->interaction_tests = 0;
+    system->chunk_lookup = NULL;
+    system->wheel_events = NULL;
+    system->wheel_free = WHEEL_NONE;
+    for (uint32_t i = 0; i < WHEEL_SLOTS; ++i)
+    {
+        system->wheel_slots[i] = WHEEL_NONE;
+    }
+    system->wheel_tick = 0;
+    system->due_events = NULL;
+    system->due_x = NULL;
+    system->due_y = NULL;
+    system->due_dx = NULL;
+    system->due_dy = NULL;
+    system->due_hit = NULL;
+    system->events = NULL;
+    system->chunks = NULL;
+    system->dormant_chunks = NULL;
+    system->active_grid = NULL;
+    system->tuning = tuning_default();
+    system->world = tuning_world(&system->tuning, 0);
+    system->atom_size = system->tuning.atom_size;
+    system->atom_neutrons = system->tuning.atom_neutrons;
+    system->streamed = false;
+    system->center = (chunk_coord_t){0, 0};
+    system->simulated_bounds = (bbox2_t){{0, 0}, {0, 0}};
+    system->num_stabilized = 0;
+    system->angle = 0;
+    system->angle_direction = 1;
+    system->random = 0;
+    direction_ring(system->circle_directions, MAX_NEUTRONS_PER_ATOM, 0);
+    system->time_ms = 0;
 
-            // @Todo: emit several neutrons at a time
-            // @Todo: emit in different patterns/behavior depending on the atom type.
+    return system;
+}
 
-            atom->state.num_left -= 1;
+void atom_system_destroy(struct atom_system_o* as)
+{
+    assert(as);
 
-            neutron_emitted_this_update = true;
-            if (atom->state.num_left == 0)
-            {
-                atom_stable_this_update = true;
-            }
+    slot_map_free(&as->atom_map, as->atoms);
+    slot_map_free(&as->neutron_map, as->neutrons);
+    array_free(as->neutron_origin_x);
+    array_free(as->neutron_origin_y);
+    array_free(as->neutron_vel_x);
+    array_free(as->neutron_vel_y);
+    array_free(as->neutron_spawn_ms);
+    array_free(as->neutron_exit_ms);
+    array_free(as->neutron_capture_ms);
+    slot_map_free(&as->cascade_map, as->cascades);
+    array_free(as->wheel_events);
+    array_free(as->due_events);
+    array_free(as->due_x);
+    array_free(as->due_y);
+    array_free(as->due_dx);
+    array_free(as->due_dy);
+    array_free(as->due_hit);
+    array_free(as->events);
+    array_free(as->chunks);
+    array_free(as->dormant_chunks);
+    array_free(as->active_grid);
+    array_free(as->chunk_lookup);
+    mem_free(as);
+}
 
-            atom->emit_neutron(atom, dt);
+void atom_system_reset(struct atom_system_o* as, world_t world)
+{
+    // Chunks must fit at least an atom away from their borders.
+    assert(as && world.chunk_size > 2*sqrtf(2)*as->tuning.atom_size && world.active_radius >= 0);
+
+    as->world = world;
+    as->atom_size = as->tuning.atom_size;
+    as->atom_neutrons = as->tuning.atom_neutrons;
+    as->streamed = false;
+    as->time_ms = 0;
+    as->num_stabilized = 0;
+    // Another stream than the chunk generators which are seeded with `seed ^ key`.
+    as->random = ~world.seed;
+
+    slot_map_clear(&as->atom_map, as->atoms);
+    slot_map_clear(&as->neutron_map, as->neutrons);
+    array_clear(as->neutron_origin_x);
+    array_clear(as->neutron_origin_y);
+    array_clear(as->neutron_vel_x);
+    array_clear(as->neutron_vel_y);
+    array_clear(as->neutron_spawn_ms);
+    array_clear(as->neutron_exit_ms);
+    array_clear(as->neutron_capture_ms);
+    slot_map_clear(&as->cascade_map, as->cascades);
+    as->metrics = (atom_metrics_t){0};
+    as->interaction_tests = 0;
+    array_clear(as->wheel_events);
+    as->wheel_free = WHEEL_NONE;
+    for (uint32_t i = 0; i < WHEEL_SLOTS; ++i)
+    {
+        as->wheel_slots[i] = WHEEL_NONE;
+    }
+    as->wheel_tick = 0;
+    array_clear(as->events);
+    array_clear(as->chunks);
+    array_clear(as->dormant_chunks);
+
+    // Reserve the pools for the most chunks that can be active at once so that updates never
+    // allocate. Only the dormant chunks grow with the explored area.
+    const uint32_t active_extent = 2 * world.active_radius + 1;
+    const uint32_t max_extent = active_extent + 2;
+    const uint32_t max_chunks = max_extent * max_extent;
+    const uint32_t max_atoms = max_chunks * MAX_ATOMS_PER_CHUNK;
+    const uint32_t max_neutrons = max_atoms * MAX_NEUTRONS_PER_ATOM;
+
+    mem_push_tag(MEMORY_TAG_ATOM);
+    slot_map_reserve(&as->atom_map, as->atoms, max_atoms);
+    slot_map_reserve(&as->neutron_map, as->neutrons, max_neutrons);
+    array_reserve(as->neutron_origin_x, max_neutrons);
+    array_reserve(as->neutron_origin_y, max_neutrons);
+    array_reserve(as->neutron_vel_x, max_neutrons);
+    array_reserve(as->neutron_vel_y, max_neutrons);
+    array_reserve(as->neutron_spawn_ms, max_neutrons);
+    array_reserve(as->neutron_exit_ms, max_neutrons);
+    array_reserve(as->neutron_capture_ms, max_neutrons);
+    // A cascade has at least a neutron alive.
+    slot_map_reserve(&as->cascade_map, as->cascades, max_neutrons);
+    array_reserve(as->wheel_events, max_neutrons);
+    array_reserve(as->due_events, max_neutrons);
+    array_reserve(as->due_x, max_neutrons);
+    array_reserve(as->due_y, max_neutrons);
+    array_reserve(as->due_dx, max_neutrons);
+    array_reserve(as->due_dy, max_neutrons);
+    array_reserve(as->due_hit, max_neutrons);
+    // At most a stabilization per atom and update, and an emission or a fission per neutron the
+    // atom can have alive.
+    array_reserve(as->events, (MAX_NEUTRONS_PER_ATOM + 1) * max_atoms);
+    array_reserve(as->chunks, max_chunks);
+    array_resize(as->active_grid, active_extent * active_extent);
+    array_resize(as->chunk_lookup, max_extent * max_extent);
+    mem_pop_tag();
+}
+
+static dormant_chunk_t* find_dormant_chunk(atom_system_o* as, uint64_t key, uint32_t* insert_index)
+{
+    // Lower bound.
+    uint32_t first = 0;
+    uint32_t count = array_size(as->dormant_chunks);
+    while (count > 0)
+    {
+        const uint32_t half = count / 2;
+        if (as->dormant_chunks[first + half].key < key)
+        {
+            first += half + 1;
+            count -= half + 1;
         }
+        else
+        {
+            count = half;
+        }
+    }
 
-        // @Todo: some spatial collision detection ?
+    *insert_index = first;
+    const bool found = first < array_size(as->dormant_chunks) && as->dormant_chunks[first].key == key;
+    return found ? &as->dormant_chunks[first] : NULL;
+}
 
-        for (uint32_t j = 0; j < array_size(atom->neutrons); ++j)
-        {
-            neutron_t* neutron = &atom->neutrons[j];
-            neutron->pos = vec2_add(neutron->pos, vec2_mul_scalar(neutron->dir, neutron->speed * dt));
+static void activate_chunk(atom_system_o* as, chunk_coord_t coord)
+{
+    uint32_t insert_index;
+    const dormant_chunk_t* dormant = find_dormant_chunk(as, world_chunk_key(coord), &insert_index);
+
+    // Atoms are kept a bounding circle away from the chunk borders so that atoms of neighbouring
+    // chunks never overlap.
+    const float radius = sqrtf(2)*as->atom_size;
+    const bbox2_t bounds = world_chunk_bounds(as->world, coord);
+    const float placement_size = as->world.chunk_size - 2*radius;
+    const circle_t spawn = {.center = {0, 0}, .radius = SPAWN_CLEAR_RADIUS};
+
+    // Everything below only depends on the random generator of the chunk.
+    uint64_t random = world_chunk_seed(as->world, coord);
+    const uint32_t n = 1 + world_random_next(&random) % MAX_ATOMS_PER_CHUNK;
+
+    active_chunk_t chunk = {.coord = coord, .num_atoms = 0};
+    vec2_t positions[MAX_ATOMS_PER_CHUNK];
 
-            bool delete_neutron = false;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        const bool emit_random = world_random_next(&random) % 2;
 
-            if (player_intersect_circle(
-                    player, (circle_t){neutron->pos, neutron->bounding_circle_radius}))
+        for (uint32_t attempt = 0; attempt < PLACEMENT_ATTEMPTS; ++attempt)
+        {
+            const vec2_t candidate_pos = {
+                bounds.min.x + radius + world_random_float(&random) * placement_size,
+                bounds.min.y + radius + world_random_float(&random) * placement_size,
+            };
+            const circle_t candidate = {.center = candidate_pos, .radius = radius};
+
+            bool valid_candidate = !circle_intersect(candidate, spawn);
+            for (uint32_t j = 0; j < chunk.num_atoms && valid_candidate; ++j)
             {
-                // @Todo: player hit
-                player_die(player);
-                delete_neutron = true;
+                valid_candidate = !circle_intersect(candidate, (circle_t){positions[j], radius});
             }
-            else if (neutron->pos.x >= world.bounds.east || neutron->pos.x <= world.bounds.west
-                || neutron->pos.y >= world.bounds.north || neutron->pos.y <= world.bounds.south)
+
+            if (valid_candidate)
             {
-                delete_neutron = true;
+                const uint32_t index = chunk.num_atoms++;
+                positions[index] = candidate_pos;
+
+                atom_t atom = {
+                    .pos = candidate_pos,
+                    .state = {
+                        .num_left = dormant ? dormant->num_left[index] : as->atom_neutrons,
+                        .num_exceeding_neutrons = as->atom_neutrons,
+                    },
+                    .num_neutrons = 0,
+                    .emit_neutron = emit_random ? &emit_neutron_random : &emit_neutron_circle,
+                };
+                chunk.atoms[index] = slot_map_insert(&as->atom_map, as->atoms, atom);
+                break;
             }
+        }
+    }
+
+    array_push(as->chunks, chunk);
+}
+
+static void evict_chunk(atom_system_o* as, uint32_t chunk_index)
+{
+    const active_chunk_t chunk = as->chunks[chunk_index];
+    array_remove_fast(as->chunks, chunk_index);
+
+    dormant_chunk_t dormant = {.key = world_chunk_key(chunk.coord)};
+    bool modified = false;
+
+    for (uint32_t i = 0; i < chunk.num_atoms; ++i)
+    {
+        const atom_t* atom = slot_map_get(&as->atom_map, as->atoms, chunk.atoms[i]);
+        dormant.num_left[i] = atom->state.num_left;
+        modified |= atom->state.num_left != atom->state.num_exceeding_neutrons;
+        slot_map_remove(&as->atom_map, as->atoms, chunk.atoms[i]);
+    }
+
+    if (!modified)
+    {
+        return;
+    }
+
+    uint32_t insert_index;
+    dormant_chunk_t* existing = find_dormant_chunk(as, dormant.key, &insert_index);
+    if (existing)
+    {
+        *existing = dormant;
+        return;
+    }
+
+    mem_push_tag(MEMORY_TAG_ATOM);
+    array_push(as->dormant_chunks, dormant);
+    mem_pop_tag();
+
+    const uint32_t num_moved = array_size(as->dormant_chunks) - 1 - insert_index;
+    memmove(
+        &as->dormant_chunks[insert_index + 1], &as->dormant_chunks[insert_index],
+        num_moved * sizeof(dormant_chunk_t));
+    as->dormant_chunks[insert_index] = dormant;
+}
+
+void atom_system_stream(struct atom_system_o* as, vec2_t center)
+{
+    assert(as);
+
+    const chunk_coord_t center_chunk = world_chunk_at(as->world, center);
+    if (as->streamed && center_chunk.x == as->center.x && center_chunk.y == as->center.y)
+    {
+        return;
+    }
+
+    as->streamed = true;
+    as->center = center_chunk;
+
+    const int32_t radius = as->world.active_radius;
+    const int32_t extent = 2 * radius + 1;
+    memset(as->active_grid, 0, array_size(as->active_grid));
+
+    // Iterate backward so that the chunk moved in place of an evicted one was already processed.
+    bool evicted = false;
+    for (uint32_t i = array_size(as->chunks); i-- > 0;)
+    {
+        const chunk_coord_t coord = as->chunks[i].coord;
+        const int32_t distance = world_chunk_distance(coord, center_chunk);
 
-            if (delete_neutron)
+        if (distance > radius + 1)
+        {
+            evict_chunk(as, i);
+            evicted = true;
+        }
+        else if (distance <= radius)
+        {
+            const int32_t x = coord.x - center_chunk.x + radius;
+            const int32_t y = coord.y - center_chunk.y + radius;
+            as->active_grid[y * extent + x] = 1;
+        }
+    }
+
+    for (int32_t y = 0; y < extent; ++y)
+    {
+        for (int32_t x = 0; x < extent; ++x)
+        {
+            if (!as->active_grid[y * extent + x])
             {
-                // Order isn't important, remove and replace with last in the array.
-                if (array_size(atom->neutrons) == 1)
-                {
-                    array_pop(atom->neutrons);
-                }
-                else
-                {
-                    atom->neutrons[j] = atom->neutrons[array_size(atom->neutrons) - 1];
-                    array_pop(atom->neutrons);
-                    // array_remove_fast(atom->neutrons, j);
-                }
+                activate_chunk(as, (chunk_coord_t){center_chunk.x + x - radius, center_chunk.y + y - radius});
             }
+        }
+    }
 
-            // printf("%d %d\n", array_size(atom->neutrons), atom->state.num_left);
+    // Neutrons of evicted atoms are far from the camera. They go with their atom so that every
+    // neutron has an atom and the pools never outgrow their reservation.
+    if (evicted)
+    {
+        for (uint32_t i = array_size(as->neutrons); i-- > 0;)
+        {
+            if (!slot_map_valid(&as->atom_map, as->neutrons[i].atom))
+            {
+                despawn_neutron(as, i);
+            }
         }
     }
 
-    if (neutron_emitted_this_update)
+    const chunk_coord_t min_chunk = {center_chunk.x - radius - 1, center_chunk.y - radius - 1};
+    const chunk_coord_t max_chunk = {center_chunk.x + radius + 1, center_chunk.y + radius + 1};
+    as->simulated_bounds = (bbox2_t){
+        world_chunk_bounds(as->world, min_chunk).min,
+        world_chunk_bounds(as->world, max_chunk).max,
+    };
+
+    const int32_t lookup_extent = 2 * (radius + 1) + 1;
+    for (uint32_t i = 0; i < array_size(as->chunk_lookup); ++i)
     {
-        audio_system_play_sound(audio, AUDIO_ENTRY_EMIT_NEUTRON);
+        as->chunk_lookup[i] = NO_CHUNK;
     }
-    if (atom_stable_this_update)
+    for (uint32_t i = 0; i < array_size(as->chunks); ++i)
+    {
+        const int32_t x = as->chunks[i].coord.x - center_chunk.x + radius + 1;
+        const int32_t y = as->chunks[i].coord.y - center_chunk.y + radius + 1;
+        as->chunk_lookup[y * lookup_extent + x] = i;
+    }
+
+    // The new chunks may be on the way of the neutrons.
+    for (uint32_t i = 0; i < array_size(as->neutrons); ++i)
     {
-        audio_system_play_sound(audio, AUDIO_ENTRY_ATOM_STABLE);
+        as->neutron_exit_ms[i] = neutron_exit_ms(as, i, as->simulated_bounds);
+        cast_neutron(as, i, as->time_ms);
     }
+    wheel_rebuild(as);
 }
 
-static void draw_stability_bar(atom_t atom, struct camera_o* camera, SDL_Renderer* render)
+uint32_t atom_system_num_stabilized(const struct atom_system_o* as)
 {
-    static const float OFFSET = ATOM_SIZE;
-    static const vec2_t BAR_OUTLINE_SIZE = {ATOM_SIZE, 10};
+    assert(as);
+    return as->num_stabilized;
+}
 
-    vec2_t bar_outline_pos = vec2_add(atom.pos, (vec2_t){0, OFFSET});
-    SDL_Rect rect_outline = sdl_rect_from_pos_and_size(camera, bar_outline_pos, BAR_OUTLINE_SIZE);
+uint32_t atom_system_num_active_chunks(const struct atom_system_o* as)
+{
+    assert(as);
+    return array_size(as->chunks);
+}
+
+uint32_t atom_system_num_dormant_chunks(const struct atom_system_o* as)
+{
+    assert(as);
+    return array_size(as->dormant_chunks);
+}
 
-    float fill_percent = (float)atom.state.num_left / atom.state.num_exceeding_neutrons;
-    vec2_t bar_size = {BAR_OUTLINE_SIZE.x * (1 - fill_percent) - 2, BAR_OUTLINE_SIZE.y - 2};
-    vec2_t bar_pos = {
-        bar_outline_pos.x - BAR_OUTLINE_SIZE.x / 2 + bar_size.x / 2 + 1,
-        bar_outline_pos.y,
+void atom_system_set_tuning(struct atom_system_o* as, const struct tuning_t* tuning)
+{
+    assert(as && tuning);
+    as->tuning = *tuning;
+}
+
+void atom_system_set_chain_reaction(struct atom_system_o* as, chain_reaction_t chain)
+{
+    assert(as && chain.cross_section >= 0);
+
+    // Atoms keep their bounding radius away from the chunk borders, so do their capture circles.
+    const float max_cross_section = sqrtf(2)*as->atom_size;
+    chain.cross_section = fminf(chain.cross_section, max_cross_section);
+    chain.fission_neutrons = chain.fission_neutrons < MAX_NEUTRONS_PER_ATOM ? chain.fission_neutrons : MAX_NEUTRONS_PER_ATOM;
+    as->chain = chain;
+}
+
+atom_metrics_t atom_system_metrics(const struct atom_system_o* as)
+{
+    assert(as);
+    return as->metrics;
+}
+
+uint32_t atom_system_num_atoms(const struct atom_system_o* as)
+{
+    assert(as);
+    return array_size(as->atoms);
+}
+
+atom_info_t atom_system_atom(const struct atom_system_o* as, uint32_t index)
+{
+    assert(as && index < array_size(as->atoms));
+    const atom_t* atom = &as->atoms[index];
+    return (atom_info_t){
+        .pos = atom->pos,
+        .size = as->atom_size,
+        .num_left = atom->state.num_left,
+        .num_exceeding_neutrons = atom->state.num_exceeding_neutrons,
     };
-    SDL_Rect rect_bar = sdl_rect_from_pos_and_size(camera, bar_pos, bar_size);
+}
 
-    SDL_SetRenderDrawColor(render, 0, 0, 0, 255);
-    SDL_RenderDrawRect(render, &rect_outline);
-    SDL_SetRenderDrawColor(render, 50, 50, 255, 255);
-    SDL_RenderFillRect(render, &rect_bar);
+uint32_t atom_system_num_neutrons(const struct atom_system_o* as)
+{
+    assert(as);
+    return array_size(as->neutrons);
+}
+
+void atom_system_neutron_positions(const struct atom_system_o* as, float* x, float* y)
+{
+    assert(as && x && y);
+
+    for (uint32_t i = 0; i < array_size(as->neutrons); ++i)
+    {
+        const float age = as->time_ms - as->neutron_spawn_ms[i];
+        x[i] = as->neutron_origin_x[i] + as->neutron_vel_x[i] * age;
+        y[i] = as->neutron_origin_y[i] + as->neutron_vel_y[i] * age;
+    }
 }
 
-void atom_system_draw(struct atom_system_o* as, struct camera_o* camera, struct SDL_Renderer* render)
+void atom_system_neutron_velocities(const struct atom_system_o* as, float* x, float* y)
 {
-    assert(as && camera && render);
+    assert(as && x && y);
 
-    // @Todo: culling
+    memcpy(x, as->neutron_vel_x, array_size(as->neutrons) * sizeof(float));
+    memcpy(y, as->neutron_vel_y, array_size(as->neutrons) * sizeof(float));
+}
 
-    for (uint32_t i = 0; i < array_size(as->atoms); ++i)
+float atom_system_wobble_angle(const struct atom_system_o* as)
+{
+    assert(as);
+    return as->angle;
+}
+
+const atom_event_t* atom_system_events(const struct atom_system_o* as, uint32_t* num_events)
+{
+    assert(as && num_events);
+    *num_events = array_size(as->events);
+    return as->events;
+}
+
+// Only the neutrons whose event comes up are looked at, the others can't have left the simulated
+// area or reached the player yet. They are then tested against the player over the whole update,
+// along both moves, so that fast neutrons or long steps don't go through the player.
+static void update_neutrons(atom_system_o* as, struct player_o* player, float dt)
+{
+    const uint32_t previous_tick = as->wheel_tick;
+    const uint32_t tick = wheel_tick_at(as->time_ms);
+    // Events scheduled from now on come up in later updates.
+    as->wheel_tick = tick;
+
+    array_clear(as->due_events);
+    array_clear(as->due_x);
+    array_clear(as->due_y);
+    array_clear(as->due_dx);
+    array_clear(as->due_dy);
+
+    // A neutron can't have touched the player before the update that processes its event, the
+    // moves start at the previous update.
+    const float previous_time_ms = as->time_ms - dt;
+
+    // A slot holds the events of every turn, going around once is enough however long the update.
+    const uint32_t num_ticks = tick - previous_tick < WHEEL_SLOTS ? tick - previous_tick : WHEEL_SLOTS;
+    for (uint32_t t = 1; t <= num_ticks; ++t)
     {
-        atom_t atom = as->atoms[i];
+        const uint32_t slot = (previous_tick + t) % WHEEL_SLOTS;
+        uint32_t event_index = as->wheel_slots[slot];
+        as->wheel_slots[slot] = WHEEL_NONE;
 
-        if (atom.state.num_left > 0)
+        while (event_index != WHEEL_NONE)
         {
-            SDL_Rect rect = sdl_rect_from_pos_and_size_with_scale(camera, atom.pos, (vec2_t){ATOM_SIZE, ATOM_SIZE}, 1 + sinf(as->angle)*0.3);
-            SDL_RenderCopyEx(render, as->atom_texture, NULL, &rect, degrees(sinf(as->angle)), NULL, SDL_FLIP_NONE);
+            const wheel_event_t event = as->wheel_events[event_index];
+            const uint32_t current_index = event_index;
+            event_index = event.next;
+
+            const neutron_t* neutron = slot_map_get(&as->neutron_map, as->neutrons, event.neutron);
+            if (!neutron)
+            {
+                wheel_release(as, current_index);
+                continue;
+            }
+
+            if (event.tick > tick)
+            {
+                // Later turn.
+                wheel_link(as, current_index);
+                continue;
+            }
+
+            const uint32_t i = (uint32_t)(neutron - as->neutrons);
+            const float start_ms = fmaxf(previous_time_ms, as->neutron_spawn_ms[i]);
+            const vec2_t start = neutron_position(as, i, start_ms);
+            array_push(as->due_events, current_index);
+            array_push(as->due_x, start.x);
+            array_push(as->due_y, start.y);
+            array_push(as->due_dx, as->neutron_vel_x[i] * (as->time_ms - start_ms));
+            array_push(as->due_dy, as->neutron_vel_y[i] * (as->time_ms - start_ms));
         }
-        else
+    }
+
+    const uint32_t num_due = array_size(as->due_events);
+    as->metrics.neutron_events = num_due;
+    const circle_t player_circle = player_bounding_circle(player);
+    const circle_t player_start = {player_previous_position(player), player_circle.radius};
+    const vec2_t player_move = vec2_sub(player_circle.center, player_start.center);
+
+    array_resize(as->due_hit, num_due);
+    batch_sweep_circle_overlap(
+        as->due_hit, as->due_x, as->due_y, as->due_dx, as->due_dy,
+        as->tuning.neutron_size, player_start, player_move, num_due);
+
+    for (uint32_t k = 0; k < num_due; ++k)
+    {
+        const uint32_t event_index = as->due_events[k];
+        // Only other neutrons were despawned so far, the handle is still valid.
+        const neutron_t* neutron = slot_map_get(
+            &as->neutron_map, as->neutrons, as->wheel_events[event_index].neutron);
+        const uint32_t i = (uint32_t)(neutron - as->neutrons);
+        const bool hit = as->due_hit[k];
+        const bool exited = as->time_ms >= as->neutron_exit_ms[i];
+        bool captured = false;
+
+        if (!hit && !exited && as->time_ms >= as->neutron_capture_ms[i])
         {
-            // @Todo: smooth transition instead of stopping directly.
-            SDL_Rect rect = sdl_rect_from_pos_and_size_with_scale(camera, atom.pos, (vec2_t){ATOM_SIZE, ATOM_SIZE}, 0.5);
-            SDL_RenderCopy(render, as->atom_texture, NULL, &rect);
+            // The target may have become stable or been evicted since the neutron was cast, it
+            // then carries on to the next one.
+            const atom_t* target = slot_map_get(&as->atom_map, as->atoms, neutron->target);
+            captured = target && target->state.num_left > 0;
+            if (captured)
+            {
+                capture_neutron(as, i, player_circle);
+            }
+            else
+            {
+                cast_neutron(as, i, as->time_ms);
+            }
         }
 
-        /*
-        atom.state.num_left == 0
-            ? SDL_SetRenderDrawColor(render, 255, 0, 0, 255)
-            : SDL_SetRenderDrawColor(render, 0, 0, 255, 255);
-
-        SDL_RenderDrawRect(render, &rect);
-        SDL_SetRenderDrawColor(render, 255, 255, 255, 255);
-        */
+        if (!hit && !exited && !captured)
+        {
+            schedule_neutron(as, event_index, i, neutron_position(as, i, as->time_ms), player_circle);
+            continue;
+        }
 
-        for (uint32_t j = 0; j < array_size(atom.neutrons); ++j)
+        if (hit)
         {
-            const neutron_t* neutron = &atom.neutrons[j];
+            // @Todo: player hit
+            player_die(player);
+        }
 
-            SDL_Rect rect = sdl_rect_from_pos_and_size(
-                camera, neutron->pos, (vec2_t){NEUTRON_SIZE, NEUTRON_SIZE});
-            // SDL_RenderDrawRect(render, &rect);
-            SDL_RenderCopy(render, as->neutron_texture, NULL, &rect);
+        atom_t* atom = slot_map_get(&as->atom_map, as->atoms, neutron->atom);
+        if (atom)
+        {
+            atom->num_neutrons--;
         }
 
-        if (atom.state.num_left > 0)
+        despawn_neutron(as, i);
+        wheel_release(as, event_index);
+    }
+}
+
+void atom_system_update(struct atom_system_o* as, struct player_o* player, float dt)
+{
+    assert(as && player);
+
+    array_clear(as->events);
+
+    as->time_ms += dt;
+    if (as->time_ms < as->tuning.preparation_ms)
+    {
+        return;
+    }
+
+    // @Todo: smooth things out.
+    as->angle += as->angle_direction * as->tuning.atom_wobble_speed * dt;
+    if (as->angle >= PI_4_f/2 || as->angle <= - PI_4_f/2)
+    {
+        as->angle_direction = -as->angle_direction;
+    }
+
+    as->metrics.fissions = 0;
+    update_neutrons(as, player, dt);
+
+    const circle_t player_circle = player_bounding_circle(player);
+
+    for (uint32_t i = 0; i < array_size(as->atoms); ++i)
+    {
+        atom_t* atom = &as->atoms[i];
+
+        if (atom->num_neutrons == 0 && atom->state.num_left > 0)
         {
-            draw_stability_bar(atom, camera, render);
+            // Emit a new neutron in a random direction.
+
+            // @Todo: emit several neutrons at a time
+            // @Todo: emit in different patterns/behavior depending on the atom type.
+
+            atom->state.num_left -= 1;
+
+            array_push(as->events, ((atom_event_t){ATOM_EVENT_EMIT_NEUTRON, atom->pos}));
+            if (atom->state.num_left == 0)
+            {
+                array_push(as->events, ((atom_event_t){ATOM_EVENT_STABLE, atom->pos}));
+                as->num_stabilized++;
+            }
+
+            const slot_handle_t cascade = slot_map_insert(
+                &as->cascade_map, as->cascades, ((cascade_t){.num_neutrons = 0, .num_fissions = 0}));
+            atom->emit_neutron(as, slot_map_handle_at(&as->atom_map, i), cascade, player_circle);
         }
     }
+
+    as->metrics.interaction_tests = as->interaction_tests;
+    as->interaction_tests = 0;
 }
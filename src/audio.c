@@ -1,58 +1,506 @@
 #include "audio.h"
 
+#include "allocator.h"
+#include "audio_mix.h"
+#include "audio_sample.h"
+#include "audio_stream.h"
+#include "cpu_dispatch.h"
+#include "linalg.h"
+#include "spsc_queue.h"
+#include "timeline.h"
+
 #include <SDL2/SDL.h>
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 static const char* audio_files[_AUDIO_ENTRY_COUNT] = {
     "assets/sfx/emit_neutron.wav",
     "assets/sfx/atom_stable.wav",
+    // Shares the sample of the emission, loaded once.
+    "assets/sfx/emit_neutron.wav",
+};
+
+enum VoiceSteal
+{
+    VOICE_STEAL_OLDEST = 0,
+    VOICE_STEAL_QUIETEST,
 };
 
-typedef struct audio_sample_t audio_sample_t;
+typedef struct audio_sound_desc_t audio_sound_desc_t;
+
+struct audio_sound_desc_t
+{
+    // A sound can only steal the voice of a sound with a lower or equal priority.
+    uint8_t priority;
+    // Instances over the limit steal the voice of another instance of the same sound.
+    uint8_t max_instances;
+    // Triggers closer than this to the start of a playing instance are merged into it.
+    uint16_t coalesce_ms;
+    enum VoiceSteal steal;
+};
+
+static const audio_sound_desc_t sound_descs[_AUDIO_ENTRY_COUNT] = {
+    [AUDIO_ENTRY_EMIT_NEUTRON] = {.priority = 1, .max_instances = 8, .coalesce_ms = 40, .steal = VOICE_STEAL_QUIETEST},
+    [AUDIO_ENTRY_ATOM_STABLE] = {.priority = 2, .max_instances = 4, .coalesce_ms = 100, .steal = VOICE_STEAL_OLDEST},
+    // A fission is followed by the emissions of its neutrons, it mustn't be crowded out by them.
+    [AUDIO_ENTRY_FISSION] = {.priority = 2, .max_instances = 4, .coalesce_ms = 60, .steal = VOICE_STEAL_OLDEST},
+};
+
+// Musics are never stolen.
+static const uint8_t MUSIC_PRIORITY = UINT8_MAX;
+
+// The device always runs at this frequency and with these channels, SDL converts behind our back
+// if the hardware doesn't support them. Samples are either float or 16-bit, whichever the hardware
+// prefers.
+static const int32_t MIX_FREQUENCY = 48000;
+static const uint8_t MIX_CHANNELS = 2;
+static const uint16_t MIX_BUFFER_FRAMES = 256;
+// Commands pushed by the game thread during the duration of an audio buffer. Commands that don't
+// fit are dropped.
+static const uint32_t COMMAND_QUEUE_CAPACITY = 256;
+// Keep the converted samples next to the assets so that the next start doesn't convert again.
+static const bool PERSIST_CONVERTED_SAMPLES = true;
+// Positional sounds are played at full gain up to `listener_range` from the listener and fade out
+// linearly over `ATTENUATION_FALLOFF` ranges after that. They are never panned fully on one side.
+static const float ATTENUATION_FALLOFF = 2.0f;
+static const float MAX_POSITIONAL_PAN = 0.8f;
+// -3 dB pan law scaled so that a centered sound plays at its original level on both channels.
+static const float PAN_CENTER_GAIN = 1.41421356237309504880f;
+// Limiter of the master bus. When the mix gets louder than the ceiling its gain goes down to bring
+// the peak of the buffer back to the ceiling, then recovers at `LIMITER_RELEASE` per second.
+// Samples above the knee are bent smoothly so the start of a buffer, while the gain goes down,
+// never clips.
+static const float LIMITER_CEILING = 1.0f;
+static const float LIMITER_KNEE = 0.8f;
+static const float LIMITER_RELEASE = 2.0f;
+
+typedef struct audio_voice_state_t audio_voice_state_t;
+typedef struct audio_command_t audio_command_t;
+typedef struct audio_voice_shadow_t audio_voice_shadow_t;
+
+// Owned by the audio callback. A voice plays either a sample or a stream.
+struct audio_voice_state_t
+{
+    const audio_sample_t* sample;
+    struct audio_stream_o* stream;
+    uint32_t position;
+    // Gains at the end of the last buffer, the next buffer ramps them to the target ones.
+    float gain_left;
+    float gain_right;
+    float target_left;
+    float target_right;
+    // Handle of the sound being played, commands for any other handle are stale.
+    audio_voice_t handle;
+    bool active;
+    // Fading out, the voice ends after the next buffer.
+    bool stopping;
+};
+
+enum AudioCommandType
+{
+    AUDIO_COMMAND_PLAY = 0,
+    AUDIO_COMMAND_STOP,
+    AUDIO_COMMAND_SET_GAIN,
+};
 
-struct audio_sample_t
+struct audio_command_t
 {
-    SDL_AudioSpec wav_spec;
-    SDL_AudioDeviceID device_handle;
-    uint32_t wav_length;
-    uint8_t* wav_buffer;
-    bool loaded;
+    enum AudioCommandType type;
+    audio_voice_t voice;
+    const audio_sample_t* sample;
+    struct audio_stream_o* stream;
+    float gain_left;
+    float gain_right;
+};
+
+// What the game thread knows about a voice.
+struct audio_voice_shadow_t
+{
+    uint32_t generation;
+    bool busy;
+    enum AudioEntry entry;
+    uint8_t priority;
+    uint32_t start_ms;
+    // Loudest of the two channel gains.
+    float gain;
+    // Streams are closed once the callback reports their voice finished.
+    struct audio_stream_o* stream;
 };
 
 struct audio_system_o
 {
+    // Entries using the same file share the frames of the first one.
     audio_sample_t samples[_AUDIO_ENTRY_COUNT];
+    bool shared_samples[_AUDIO_ENTRY_COUNT];
+
+    // The game thread never touches the voices, it keeps track of which ones are busy and sends
+    // commands to the callback. The callback sends back the voices that finished playing.
+    /* game -> callback */ spsc_queue_t commands;
+    /* callback -> game */ spsc_queue_t finished_voices;
+
+    // Game thread side.
+    audio_voice_shadow_t shadows[AUDIO_MAX_VOICES];
+    vec2_t listener_position;
+    float listener_range;
+    // Counters at the previous `audio_system_mix_stats`.
+    uint64_t stats_frames;
+    uint64_t stats_voice_frames;
+    uint64_t stats_ticks;
+
+    // Audio callback side.
+    audio_voice_state_t voices[AUDIO_MAX_VOICES];
+    // Sounds that stole a voice, they start once the stolen sound faded out.
+    audio_voice_state_t stealing_voices[AUDIO_MAX_VOICES];
+    float limiter_gain;
+    // Voices are mixed in there when the device doesn't take float samples.
+    float* bus;
+    uint32_t bus_frames;
+    // Written by the callback, read by the game thread for statistics.
+    _Atomic uint64_t mixed_frames;
+    _Atomic uint64_t mixed_voice_frames;
+    _Atomic uint64_t callback_ticks;
+
+    SDL_AudioDeviceID device;
+    SDL_AudioFormat device_format;
 };
 
+//
+// Voice handles.
+//
+
+#define VOICE_INDEX_BITS 8
+#define VOICE_INDEX_MASK ((1u << VOICE_INDEX_BITS) - 1)
+
+static_assert(AUDIO_MAX_VOICES <= (1 << VOICE_INDEX_BITS), "Not enough bits for the voice index.");
+
+static inline audio_voice_t voice_handle(uint32_t index, uint32_t generation)
+{
+    return (generation << VOICE_INDEX_BITS) | index;
+}
+
+static inline uint32_t voice_index(audio_voice_t voice)
+{
+    return voice & VOICE_INDEX_MASK;
+}
+
+// Constant power panning so that a sound keeps the same loudness when moving across the field.
+static void pan_gains(float gain, float pan, float* gain_left, float* gain_right)
+{
+    pan = clamp(pan, -1.0f, 1.0f);
+    float sin_angle, cos_angle;
+    approx_sincosf((pan + 1) * PI_4_f, &sin_angle, &cos_angle);
+    *gain_left = gain * cos_angle * PAN_CENTER_GAIN;
+    *gain_right = gain * sin_angle * PAN_CENTER_GAIN;
+}
+
+//
+// Mixing.
+//
+
+// Ramp from the current gains of the voice to its target ones over the next `num_frames` frames.
+static audio_gain_ramp_t next_gain_ramp(audio_voice_state_t* voice, uint32_t num_frames)
+{
+    const audio_gain_ramp_t ramp = audio_gain_ramp(
+        voice->gain_left, voice->gain_right, voice->target_left, voice->target_right, num_frames);
+    voice->gain_left = voice->target_left;
+    voice->gain_right = voice->target_right;
+    return ramp;
+}
+
+// Adds the sample of the voice to the `num_frames` stereo frames of `bus`. Returns false once the
+// end of the sample is reached.
+static bool mix_sample(audio_voice_state_t* voice, float* bus, uint32_t num_frames, audio_gain_ramp_t ramp)
+{
+    const audio_sample_t* sample = voice->sample;
+    const uint32_t left = sample->num_frames - voice->position;
+    const uint32_t n = num_frames < left ? num_frames : left;
+    const uint8_t* frames = (const uint8_t*)sample->frames
+        + (size_t)voice->position * audio_sample_frame_size(sample->format);
+
+    switch (sample->format)
+    {
+        case AUDIO_SAMPLE_F32: audio_mix_f32(bus, (const float*)frames, n, ramp); break;
+        case AUDIO_SAMPLE_S16: audio_mix_s16(bus, (const int16_t*)frames, n, ramp); break;
+        default: assert(false && "Unknown sample format.");
+    }
+
+    voice->position += n;
+    return voice->position < sample->num_frames;
+}
+
+// Adds the voice to the `num_frames` stereo frames of `bus`. Returns false once it ended.
+static bool mix_voice(audio_voice_state_t* voice, float* bus, uint32_t num_frames)
+{
+    const audio_gain_ramp_t ramp = next_gain_ramp(voice, num_frames);
+    bool playing = true;
+
+    if (voice->stream)
+    {
+        // Streams loop forever, they only end when stopped.
+        audio_stream_mix(voice->stream, bus, num_frames, ramp);
+    }
+    else
+    {
+        playing = mix_sample(voice, bus, num_frames, ramp);
+    }
+
+    return playing && !voice->stopping;
+}
+
+static audio_voice_state_t* callback_voice(struct audio_system_o* audio, audio_voice_t voice)
+{
+    audio_voice_state_t* state = &audio->voices[voice_index(voice)];
+    return state->active && state->handle == voice ? state : NULL;
+}
+
+static audio_voice_state_t* stealing_voice(struct audio_system_o* audio, audio_voice_t voice)
+{
+    audio_voice_state_t* state = &audio->stealing_voices[voice_index(voice)];
+    return state->active && state->handle == voice ? state : NULL;
+}
+
+static void end_voice(struct audio_system_o* audio, audio_voice_state_t* voice)
+{
+    voice->active = false;
+
+    // The queue has room for the end of every voice plus the end of the voice each of them may have
+    // stolen. If it were full anyway the game would only lose the voice until it is stolen.
+    spsc_queue_push(&audio->finished_voices, &voice->handle);
+}
+
+static void execute_commands(struct audio_system_o* audio)
+{
+    audio_command_t command;
+    while (spsc_queue_pop(&audio->commands, &command))
+    {
+        switch (command.type)
+        {
+            case AUDIO_COMMAND_PLAY:
+            {
+                // Sounds start at their own beginning so they don't need to fade in.
+                const audio_voice_state_t started = {
+                    .sample = command.sample,
+                    .stream = command.stream,
+                    .position = 0,
+                    .gain_left = command.gain_left,
+                    .gain_right = command.gain_right,
+                    .target_left = command.gain_left,
+                    .target_right = command.gain_right,
+                    .handle = command.voice,
+                    .active = true,
+                };
+
+                // A stolen sound fades out over the next buffer like a stopped one, the new sound
+                // starts in the same buffer once it is done (see `mix_bus`). A sound waiting for
+                // the voice is replaced, it never started.
+                audio_voice_state_t* voice = &audio->voices[voice_index(command.voice)];
+                if (voice->active)
+                {
+                    voice->target_left = 0;
+                    voice->target_right = 0;
+                    voice->stopping = true;
+                    audio->stealing_voices[voice_index(command.voice)] = started;
+                }
+                else
+                {
+                    *voice = started;
+                }
+            } break;
+
+            case AUDIO_COMMAND_STOP:
+            {
+                audio_voice_state_t* voice = callback_voice(audio, command.voice);
+                audio_voice_state_t* stealing = stealing_voice(audio, command.voice);
+                if (voice)
+                {
+                    voice->target_left = 0;
+                    voice->target_right = 0;
+                    voice->stopping = true;
+                }
+                else if (stealing)
+                {
+                    // Nothing was heard yet, there is nothing to fade out.
+                    end_voice(audio, stealing);
+                }
+            } break;
+
+            case AUDIO_COMMAND_SET_GAIN:
+            {
+                audio_voice_state_t* voice = callback_voice(audio, command.voice);
+                if (!voice)
+                {
+                    voice = stealing_voice(audio, command.voice);
+                }
+                if (voice && !voice->stopping)
+                {
+                    voice->target_left = command.gain_left;
+                    voice->target_right = command.gain_right;
+                }
+            } break;
+        }
+    }
+}
+
+static void limit_bus(struct audio_system_o* audio, float* bus, uint32_t num_frames)
+{
+    const float peak = audio_mix_peak(bus, num_frames);
+    const float wanted = peak > LIMITER_CEILING ? LIMITER_CEILING / peak : 1.0f;
+    const float released = audio->limiter_gain + LIMITER_RELEASE * (float)num_frames / (float)MIX_FREQUENCY;
+    const float gain = min(wanted, released);
+
+    audio_mix_limit(bus, num_frames, audio->limiter_gain, (gain - audio->limiter_gain) / (float)num_frames, LIMITER_KNEE);
+    audio->limiter_gain = gain;
+}
+
+// Mixes every voice in the `num_frames` stereo frames of `bus`.
+static void mix_bus(struct audio_system_o* audio, float* bus, uint32_t num_frames)
+{
+    SDL_memset(bus, 0, (size_t)num_frames * MIX_CHANNELS * sizeof(float));
+
+    uint32_t num_voices = 0;
+    for (uint32_t i = 0; i < AUDIO_MAX_VOICES; ++i)
+    {
+        audio_voice_state_t* voice = &audio->voices[i];
+        if (voice->active)
+        {
+            num_voices++;
+            if (!mix_voice(voice, bus, num_frames))
+            {
+                end_voice(audio, voice);
+            }
+        }
+
+        // The stolen sound faded out in this buffer, the one that stole its voice plays over it.
+        audio_voice_state_t* stealing = &audio->stealing_voices[i];
+        if (stealing->active && !voice->active)
+        {
+            *voice = *stealing;
+            stealing->active = false;
+
+            num_voices++;
+            if (!mix_voice(voice, bus, num_frames))
+            {
+                end_voice(audio, voice);
+            }
+        }
+    }
+
+    limit_bus(audio, bus, num_frames);
+
+    atomic_fetch_add_explicit(&audio->mixed_frames, num_frames, memory_order_relaxed);
+    atomic_fetch_add_explicit(&audio->mixed_voice_frames, (uint64_t)num_voices * num_frames, memory_order_relaxed);
+}
+
+// Runs on SDL's audio thread.
+static void mix_callback(void* userdata, uint8_t* stream, int length)
+{
+    struct audio_system_o* audio = userdata;
+    const uint64_t start = SDL_GetPerformanceCounter();
+
+    execute_commands(audio);
+
+    if (audio->device_format == AUDIO_F32SYS)
+    {
+        mix_bus(audio, (float*)stream, (uint32_t)length / (MIX_CHANNELS * sizeof(float)));
+    }
+    else
+    {
+        // Voices are accumulated in float so they can't overflow, the saturation only happens once
+        // when the limited bus is converted.
+        int16_t* out = (int16_t*)stream;
+        const uint32_t num_frames = (uint32_t)length / (MIX_CHANNELS * sizeof(int16_t));
+        for (uint32_t done = 0; done < num_frames;)
+        {
+            const uint32_t n = num_frames - done < audio->bus_frames ? num_frames - done : audio->bus_frames;
+            mix_bus(audio, audio->bus, n);
+            audio_mix_to_s16(out + MIX_CHANNELS * done, audio->bus, n);
+            done += n;
+        }
+    }
+
+    atomic_fetch_add_explicit(&audio->callback_ticks, SDL_GetPerformanceCounter() - start, memory_order_relaxed);
+}
+
+//
+// Loading.
+//
+
 struct audio_system_o* audio_system_create(void)
 {
-    // @Note @Todo: see later about custom allocators.
-    struct audio_system_o* system = malloc(sizeof(struct audio_system_o));
+    struct audio_system_o* system = mem_alloc(MEMORY_TAG_AUDIO, sizeof(struct audio_system_o));
+    SDL_memset(system, 0, sizeof(struct audio_system_o));
+    system->limiter_gain = 1.0f;
+    atomic_init(&system->mixed_frames, 0);
+    atomic_init(&system->mixed_voice_frames, 0);
+    atomic_init(&system->callback_ticks, 0);
+    spsc_queue_init(&system->commands, sizeof(audio_command_t), COMMAND_QUEUE_CAPACITY, MEMORY_TAG_AUDIO);
+    spsc_queue_init(&system->finished_voices, sizeof(audio_voice_t), 2 * AUDIO_MAX_VOICES, MEMORY_TAG_AUDIO);
 
+    audio_mix_select(cpu_dispatch_level());
+    printf("Audio mixing: %s\n", audio_mix_name());
+
+    const uint32_t samples_phase = timeline_begin("audio samples");
     for (uint32_t i = 0; i < (uint32_t)_AUDIO_ENTRY_COUNT; ++i)
     {
-        audio_sample_t* sample = &system->samples[i];
+        uint32_t first = 0;
+        while (strcmp(audio_files[first], audio_files[i]) != 0)
+        {
+            first++;
+        }
 
-        sample->loaded = true;
-        if (!SDL_LoadWAV(audio_files[i], &sample->wav_spec, &sample->wav_buffer, &sample->wav_length))
+        if (first < i)
         {
-            fprintf(stderr, "Couldn't load '%s': %s\n", audio_files[i], SDL_GetError());
-            sample->loaded = false;
+            system->samples[i] = system->samples[first];
+            system->shared_samples[i] = true;
         }
         else
         {
-            sample->device_handle = SDL_OpenAudioDevice(NULL, 0, &sample->wav_spec, NULL, 0);
-            if (sample->device_handle <= 0)
-            {
-                fprintf(stderr, "Couldn't open audio device: %s\n", SDL_GetError());
-            }
+            audio_sample_load(&system->samples[i], audio_files[i], MIX_FREQUENCY, PERSIST_CONVERTED_SAMPLES);
         }
     }
 
+    timeline_end(samples_phase);
+
+    const uint32_t device_phase = timeline_begin("audio device");
+    SDL_AudioSpec want = {
+        .freq = MIX_FREQUENCY,
+        .format = AUDIO_F32SYS,
+        .channels = MIX_CHANNELS,
+        .samples = MIX_BUFFER_FRAMES,
+        .callback = mix_callback,
+        .userdata = system,
+    };
+
+    SDL_AudioSpec have;
+    system->device = SDL_OpenAudioDevice(NULL, 0, &want, &have, SDL_AUDIO_ALLOW_FORMAT_CHANGE);
+    if (system->device != 0 && have.format != AUDIO_F32SYS && have.format != AUDIO_S16SYS)
+    {
+        // Let SDL convert from float rather than writing yet another output kernel.
+        SDL_CloseAudioDevice(system->device);
+        system->device = SDL_OpenAudioDevice(NULL, 0, &want, &have, 0);
+    }
+
+    if (system->device == 0)
+    {
+        fprintf(stderr, "Couldn't open audio device: %s\n", SDL_GetError());
+    }
+    else
+    {
+        system->device_format = have.format;
+        if (have.format == AUDIO_S16SYS)
+        {
+            system->bus_frames = have.samples;
+            system->bus = mem_alloc(MEMORY_TAG_AUDIO, (size_t)have.samples * MIX_CHANNELS * sizeof(float));
+        }
+        SDL_PauseAudioDevice(system->device, 0);
+    }
+    timeline_end(device_phase);
+
     return system;
 }
 
@@ -60,25 +508,388 @@ void audio_system_destroy(struct audio_system_o* audio)
 {
     assert(audio);
 
+    // Closing the device waits for the callback to return so the samples can be freed afterwards.
+    if (audio->device != 0)
+    {
+        SDL_CloseAudioDevice(audio->device);
+    }
+
     for (uint32_t i = 0; i < _AUDIO_ENTRY_COUNT; ++i)
     {
-        SDL_CloseAudioDevice(audio->samples[i].device_handle);
-        SDL_FreeWAV(audio->samples[i].wav_buffer);
+        if (!audio->shared_samples[i])
+        {
+            audio_sample_free(&audio->samples[i]);
+        }
+    }
+
+    for (uint32_t i = 0; i < AUDIO_MAX_VOICES; ++i)
+    {
+        if (audio->shadows[i].stream)
+        {
+            audio_stream_close(audio->shadows[i].stream);
+        }
+    }
+    // Closed streams are freed by their thread, waiting for them keeps the memory report honest.
+    audio_stream_wait_all_closed();
+
+    spsc_queue_free(&audio->commands);
+    spsc_queue_free(&audio->finished_voices);
+    mem_free(audio->bus);
+    mem_free(audio);
+}
+
+//
+// Playback.
+//
+
+// Frees the voices the callback is done with. Closing their stream doesn't wait for the streaming
+// thread, the game thread never blocks here.
+static void collect_finished_voices(struct audio_system_o* audio)
+{
+    audio_voice_t voice;
+    while (spsc_queue_pop(&audio->finished_voices, &voice))
+    {
+        audio_voice_shadow_t* shadow = &audio->shadows[voice_index(voice)];
+        if (voice == voice_handle(voice_index(voice), shadow->generation))
+        {
+            shadow->busy = false;
+
+            if (shadow->stream)
+            {
+                audio_stream_close(shadow->stream);
+                shadow->stream = NULL;
+            }
+        }
+    }
+}
+
+static bool is_voice_playing(const struct audio_system_o* audio, audio_voice_t voice)
+{
+    const uint32_t index = voice_index(voice);
+    return voice != AUDIO_VOICE_NULL
+        && index < AUDIO_MAX_VOICES
+        && audio->shadows[index].busy
+        && voice == voice_handle(index, audio->shadows[index].generation);
+}
+
+// Returns true if `a` should be stolen rather than `b`.
+static bool is_better_victim(const audio_voice_shadow_t* a, const audio_voice_shadow_t* b, enum VoiceSteal steal)
+{
+    if (steal == VOICE_STEAL_QUIETEST && a->gain != b->gain)
+    {
+        return a->gain < b->gain;
+    }
+    return (int32_t)(a->start_ms - b->start_ms) < 0;
+}
+
+// Picks the voice for a new sound: a free one, a stolen one or none (`AUDIO_MAX_VOICES`). It only
+// looks at the shadows so the cost is bounded by the number of voices.
+static uint32_t find_voice(const struct audio_system_o* audio, enum AudioEntry entry, uint8_t priority)
+{
+    const bool is_music = priority == MUSIC_PRIORITY;
+    const enum VoiceSteal steal = is_music ? VOICE_STEAL_OLDEST : sound_descs[entry].steal;
+
+    uint32_t num_instances = 0;
+    uint32_t free_voice = AUDIO_MAX_VOICES;
+    uint32_t instance_victim = AUDIO_MAX_VOICES;
+    uint32_t victim = AUDIO_MAX_VOICES;
+
+    for (uint32_t i = 0; i < AUDIO_MAX_VOICES; ++i)
+    {
+        const audio_voice_shadow_t* shadow = &audio->shadows[i];
+        if (!shadow->busy)
+        {
+            if (free_voice == AUDIO_MAX_VOICES) free_voice = i;
+            continue;
+        }
+        if (shadow->stream)
+        {
+            continue;
+        }
+
+        if (!is_music && shadow->entry == entry)
+        {
+            num_instances++;
+            if (instance_victim == AUDIO_MAX_VOICES || is_better_victim(shadow, &audio->shadows[instance_victim], steal))
+            {
+                instance_victim = i;
+            }
+        }
+
+        if (shadow->priority <= priority
+            && (victim == AUDIO_MAX_VOICES || shadow->priority < audio->shadows[victim].priority
+                || (shadow->priority == audio->shadows[victim].priority
+                    && is_better_victim(shadow, &audio->shadows[victim], steal))))
+        {
+            victim = i;
+        }
+    }
+
+    if (!is_music && num_instances >= sound_descs[entry].max_instances)
+    {
+        return instance_victim;
     }
+    return free_voice != AUDIO_MAX_VOICES ? free_voice : victim;
+}
+
+static audio_voice_t start_voice(
+    struct audio_system_o* audio,
+    enum AudioEntry entry,
+    struct audio_stream_o* stream,
+    uint8_t priority,
+    float gain,
+    float pan)
+{
+    collect_finished_voices(audio);
+
+    const uint32_t index = find_voice(audio, entry, priority);
+    if (index == AUDIO_MAX_VOICES)
+    {
+        return AUDIO_VOICE_NULL;
+    }
+
+    // The callback reports the end of the stolen sound once it faded out, its handle is stale by
+    // then so only the end of the new sound frees the voice.
+    audio_voice_shadow_t* shadow = &audio->shadows[index];
+    uint32_t generation = (shadow->generation + 1) & (UINT32_MAX >> VOICE_INDEX_BITS);
+    generation += generation == 0;
+
+    audio_command_t command = {
+        .type = AUDIO_COMMAND_PLAY,
+        .voice = voice_handle(index, generation),
+        .sample = stream ? NULL : &audio->samples[entry],
+        .stream = stream,
+    };
+    pan_gains(gain, pan, &command.gain_left, &command.gain_right);
 
-    free(audio);
+    if (!spsc_queue_push(&audio->commands, &command))
+    {
+        return AUDIO_VOICE_NULL;
+    }
+
+    *shadow = (audio_voice_shadow_t){
+        .generation = generation,
+        .busy = true,
+        .entry = entry,
+        .priority = priority,
+        .start_ms = SDL_GetTicks(),
+        .gain = max(command.gain_left, command.gain_right),
+        .stream = stream,
+    };
+    return command.voice;
 }
 
-void audio_system_play_sound(const struct audio_system_o* audio, enum AudioEntry entry)
+// Returns the voice a new trigger of `entry` should be merged into, if any.
+static audio_voice_t find_coalescing_voice(const struct audio_system_o* audio, enum AudioEntry entry)
+{
+    const uint32_t now_ms = SDL_GetTicks();
+    for (uint32_t i = 0; i < AUDIO_MAX_VOICES; ++i)
+    {
+        const audio_voice_shadow_t* shadow = &audio->shadows[i];
+        if (shadow->busy && !shadow->stream && shadow->entry == entry
+            && now_ms - shadow->start_ms < sound_descs[entry].coalesce_ms)
+        {
+            return voice_handle(i, shadow->generation);
+        }
+    }
+    return AUDIO_VOICE_NULL;
+}
+
+audio_voice_t audio_system_play(struct audio_system_o* audio, enum AudioEntry entry, float gain, float pan)
 {
     assert(audio);
     assert((uint32_t)entry >= 0 && (uint32_t)entry < _AUDIO_ENTRY_COUNT);
 
-    const audio_sample_t* sample = &audio->samples[(uint32_t)entry];
+    if (!audio->samples[entry].frames || audio->device == 0)
+    {
+        fprintf(stderr, "Can't play sound.\n");
+        return AUDIO_VOICE_NULL;
+    }
+
+    collect_finished_voices(audio);
+
+    // Identical triggers in a short window are merged, keeping the loudest gain and its pan.
+    const audio_voice_t coalesced = find_coalescing_voice(audio, entry);
+    if (coalesced != AUDIO_VOICE_NULL)
+    {
+        audio_voice_shadow_t* shadow = &audio->shadows[voice_index(coalesced)];
+        float gain_left, gain_right;
+        pan_gains(gain, pan, &gain_left, &gain_right);
+        if (max(gain_left, gain_right) > shadow->gain)
+        {
+            audio_system_set_gain_pan(audio, coalesced, gain, pan);
+        }
+        return coalesced;
+    }
+
+    return start_voice(audio, entry, NULL, sound_descs[entry].priority, gain, pan);
+}
+
+audio_voice_t audio_system_play_at(struct audio_system_o* audio, enum AudioEntry entry, vec2_t position)
+{
+    assert(audio);
+
+    if (audio->listener_range <= 0)
+    {
+        return audio_system_play(audio, entry, 1.0f, 0.0f);
+    }
+
+    const vec2_t offset = vec2_sub(position, audio->listener_position);
+    const float distance = vec2_length(offset);
+    const float range = audio->listener_range;
+
+    const float gain = clamp(1 - (distance - range) / (ATTENUATION_FALLOFF * range), 0.0f, 1.0f);
+    if (gain == 0)
+    {
+        return AUDIO_VOICE_NULL;
+    }
+
+    const float pan = clamp(offset.x / range, -1.0f, 1.0f) * MAX_POSITIONAL_PAN;
+    return audio_system_play(audio, entry, gain, pan);
+}
+
+void audio_system_set_listener(struct audio_system_o* audio, vec2_t position, float range)
+{
+    assert(audio);
+    audio->listener_position = position;
+    audio->listener_range = range;
+}
+
+audio_voice_t audio_system_play_music(struct audio_system_o* audio, const char* filename, float gain)
+{
+    assert(audio && filename);
+
+    if (audio->device == 0)
+    {
+        return AUDIO_VOICE_NULL;
+    }
+
+    struct audio_stream_o* stream = audio_stream_open(filename, MIX_FREQUENCY);
+    if (!stream)
+    {
+        return AUDIO_VOICE_NULL;
+    }
+
+    const audio_voice_t voice = start_voice(audio, 0, stream, MUSIC_PRIORITY, gain, 0.0f);
+    if (voice == AUDIO_VOICE_NULL)
+    {
+        audio_stream_close(stream);
+    }
+
+    return voice;
+}
+
+void audio_system_play_sound(struct audio_system_o* audio, enum AudioEntry entry)
+{
+    audio_system_play(audio, entry, 1.0f, 0.0f);
+}
+
+void audio_system_stop(struct audio_system_o* audio, audio_voice_t voice)
+{
+    assert(audio);
+
+    collect_finished_voices(audio);
+    if (!is_voice_playing(audio, voice)) return;
+
+    // The voice is freed once the callback reports it finished.
+    const audio_command_t command = {.type = AUDIO_COMMAND_STOP, .voice = voice};
+    spsc_queue_push(&audio->commands, &command);
+}
+
+void audio_system_set_gain_pan(struct audio_system_o* audio, audio_voice_t voice, float gain, float pan)
+{
+    assert(audio);
+
+    if (!is_voice_playing(audio, voice)) return;
+
+    audio_command_t command = {.type = AUDIO_COMMAND_SET_GAIN, .voice = voice};
+    pan_gains(gain, pan, &command.gain_left, &command.gain_right);
+    spsc_queue_push(&audio->commands, &command);
+}
+
+audio_mix_stats_t audio_system_mix_stats(struct audio_system_o* audio)
+{
+    assert(audio);
+
+    const uint64_t frames = atomic_load_explicit(&audio->mixed_frames, memory_order_relaxed);
+    const uint64_t voice_frames = atomic_load_explicit(&audio->mixed_voice_frames, memory_order_relaxed);
+    const uint64_t ticks = atomic_load_explicit(&audio->callback_ticks, memory_order_relaxed);
+
+    const double mixed_frames = (double)(frames - audio->stats_frames);
+    const double mixed_voice_frames = (double)(voice_frames - audio->stats_voice_frames);
+    const double callback_ms = (double)(ticks - audio->stats_ticks) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    const double audio_ms = mixed_frames * 1000.0 / MIX_FREQUENCY;
+
+    audio->stats_frames = frames;
+    audio->stats_voice_frames = voice_frames;
+    audio->stats_ticks = ticks;
+
+    return (audio_mix_stats_t){
+        .voices = mixed_frames > 0 ? (float)(mixed_voice_frames / mixed_frames) : 0.0f,
+        .voices_per_ms = callback_ms > 0 ? (float)(mixed_voice_frames / MIX_BUFFER_FRAMES / callback_ms) : 0.0f,
+        .load = audio_ms > 0 ? (float)(callback_ms / audio_ms) : 0.0f,
+    };
+}
+
+//
+// Hot reload.
+//
 
-    if (!sample->loaded) fprintf(stderr, "Can't play sound.\n");
+bool audio_system_load_sound(const char* filename, struct audio_sample_t* sample)
+{
+    assert(filename && sample);
+
+    for (uint32_t i = 0; i < _AUDIO_ENTRY_COUNT; ++i)
+    {
+        if (strcmp(audio_files[i], filename) == 0)
+        {
+            return audio_sample_load(sample, filename, MIX_FREQUENCY, PERSIST_CONVERTED_SAMPLES);
+        }
+    }
+    return false;
+}
+
+void audio_system_replace_sound(struct audio_system_o* audio, const char* filename, struct audio_sample_t* sample)
+{
+    assert(audio && filename && sample);
+
+    // Voices point to the sample of their entry, its content is swapped while the callback can't
+    // run so they never see half of it.
+    if (audio->device != 0)
+    {
+        SDL_LockAudioDevice(audio->device);
+    }
+
+    audio_sample_t previous = {0};
+    bool replaced = false;
+    for (uint32_t i = 0; i < _AUDIO_ENTRY_COUNT; ++i)
+    {
+        if (strcmp(audio_files[i], filename) != 0)
+        {
+            continue;
+        }
+
+        if (!audio->shared_samples[i])
+        {
+            previous = audio->samples[i];
+        }
+        audio->samples[i] = *sample;
+        replaced = true;
+
+        for (uint32_t v = 0; v < AUDIO_MAX_VOICES; ++v)
+        {
+            audio_voice_state_t* voice = &audio->voices[v];
+            if (voice->active && voice->sample == &audio->samples[i])
+            {
+                voice->position = voice->position < sample->num_frames ? voice->position : sample->num_frames;
+            }
+        }
+    }
+
+    if (audio->device != 0)
+    {
+        SDL_UnlockAudioDevice(audio->device);
+    }
 
-    SDL_ClearQueuedAudio(sample->device_handle);
-    SDL_QueueAudio(sample->device_handle, sample->wav_buffer, sample->wav_length);
-    SDL_PauseAudioDevice(sample->device_handle, 0);
+    audio_sample_free(replaced ? &previous : sample);
 }
@@ -0,0 +1,137 @@
+#include "audio_mix.h"
+
+#include <assert.h>
+#include <math.h>
+
+//
+// Scalar implementation, also used for the tails of the SIMD ones.
+//
+// The SIMD implementations do the same operations in the same order so that all of them give
+// identical results. In particular the gain of a frame is always computed from its index rather
+// than accumulated.
+//
+
+static void mix_f32_scalar(float* bus, const float* frames, uint32_t num_frames, audio_gain_ramp_t ramp)
+{
+    for (uint32_t i = 0; i < num_frames; ++i)
+    {
+        bus[2*i + 0] += frames[2*i + 0] * (ramp.left + (float)i * ramp.step_left);
+        bus[2*i + 1] += frames[2*i + 1] * (ramp.right + (float)i * ramp.step_right);
+    }
+}
+
+static void mix_s16_scalar(float* bus, const int16_t* frames, uint32_t num_frames, audio_gain_ramp_t ramp)
+{
+    const float scale = 1.0f / 32768.0f;
+    for (uint32_t i = 0; i < num_frames; ++i)
+    {
+        bus[2*i + 0] += ((float)frames[2*i + 0] * scale) * (ramp.left + (float)i * ramp.step_left);
+        bus[2*i + 1] += ((float)frames[2*i + 1] * scale) * (ramp.right + (float)i * ramp.step_right);
+    }
+}
+
+static float peak_scalar(const float* bus, uint32_t num_frames)
+{
+    float peak = 0;
+    for (uint32_t i = 0; i < 2 * num_frames; ++i)
+    {
+        const float a = fabsf(bus[i]);
+        peak = a > peak ? a : peak;
+    }
+    return peak;
+}
+
+static void limit_scalar(float* bus, uint32_t num_frames, float gain, float step, float knee)
+{
+    // Above the knee the samples follow `knee + range * z / (1 + z)`, which has a slope of 1 at the
+    // knee and tends to `knee + range = 1`.
+    const float range = 1.0f - knee;
+    for (uint32_t i = 0; i < 2 * num_frames; ++i)
+    {
+        const float x = bus[i] * (gain + (float)(i / 2) * step);
+        const float a = fabsf(x);
+        const float over = a - knee;
+        const float z = (over > 0.0f ? over : 0.0f) / range;
+        const float y = (a < knee ? a : knee) + range * (z / (1.0f + z));
+        bus[i] = copysignf(y, x);
+    }
+}
+
+static void to_s16_scalar(int16_t* out, const float* bus, uint32_t num_frames)
+{
+    for (uint32_t i = 0; i < 2 * num_frames; ++i)
+    {
+        float x = bus[i] * 32767.0f;
+        x = x > -32768.0f ? x : -32768.0f;
+        x = x < 32767.0f ? x : 32767.0f;
+        out[i] = (int16_t)lrintf(x);
+    }
+}
+
+static const audio_mix_kernels_t scalar_kernels = {
+    .name = "scalar",
+    .mix_f32 = mix_f32_scalar,
+    .mix_s16 = mix_s16_scalar,
+    .peak = peak_scalar,
+    .limit = limit_scalar,
+    .to_s16 = to_s16_scalar,
+};
+
+const audio_mix_kernels_t* audio_mix_scalar_kernels(void)
+{
+    return &scalar_kernels;
+}
+
+//
+// Dispatch.
+//
+
+static const audio_mix_kernels_t* kernels = &scalar_kernels;
+
+// There are only scalar, SSE2 and AVX2 kernels, SSE4.1 uses the SSE2 ones and NEON the scalar
+// ones. The x86 levels are ordered by width.
+void audio_mix_select(enum SimdLevel level)
+{
+    assert(level < _SIMD_LEVEL_COUNT);
+
+    kernels = &scalar_kernels;
+    if (level >= SIMD_LEVEL_SSE2 && level <= SIMD_LEVEL_AVX2 && audio_mix_sse2_kernels())
+    {
+        kernels = audio_mix_sse2_kernels();
+    }
+    if (level == SIMD_LEVEL_AVX2 && audio_mix_avx2_kernels())
+    {
+        kernels = audio_mix_avx2_kernels();
+    }
+}
+
+const char* audio_mix_name(void)
+{
+    return kernels->name;
+}
+
+void audio_mix_f32(float* bus, const float* frames, uint32_t num_frames, audio_gain_ramp_t ramp)
+{
+    kernels->mix_f32(bus, frames, num_frames, ramp);
+}
+
+void audio_mix_s16(float* bus, const int16_t* frames, uint32_t num_frames, audio_gain_ramp_t ramp)
+{
+    kernels->mix_s16(bus, frames, num_frames, ramp);
+}
+
+float audio_mix_peak(const float* bus, uint32_t num_frames)
+{
+    return kernels->peak(bus, num_frames);
+}
+
+void audio_mix_limit(float* bus, uint32_t num_frames, float gain, float step, float knee)
+{
+    assert(knee >= 0 && knee < 1);
+    kernels->limit(bus, num_frames, gain, step, knee);
+}
+
+void audio_mix_to_s16(int16_t* out, const float* bus, uint32_t num_frames)
+{
+    kernels->to_s16(out, bus, num_frames);
+}
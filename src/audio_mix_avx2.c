@@ -0,0 +1,164 @@
+#include "audio_mix.h"
+
+#include <stddef.h>
+
+// This file is compiled with `-mavx2` (see the Makefile). Nothing from it must be called unless
+// the CPU supports AVX2.
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+// Tails are processed by the scalar implementation, one frame at a time with the gain of that
+// frame (see `audio_mix_sse2.c`).
+static inline audio_gain_ramp_t frame_gain(audio_gain_ramp_t ramp, uint32_t i)
+{
+    return (audio_gain_ramp_t){ramp.left + (float)i * ramp.step_left, ramp.right + (float)i * ramp.step_right, 0, 0};
+}
+
+static void mix_f32_avx2(float* bus, const float* frames, uint32_t num_frames, audio_gain_ramp_t ramp)
+{
+    // Four stereo frames per iteration: lanes are L0 R0 L1 R1 L2 R2 L3 R3.
+    const __m256 base = _mm256_setr_ps(
+        ramp.left, ramp.right, ramp.left, ramp.right, ramp.left, ramp.right, ramp.left, ramp.right);
+    const __m256 step = _mm256_setr_ps(
+        ramp.step_left, ramp.step_right, ramp.step_left, ramp.step_right,
+        ramp.step_left, ramp.step_right, ramp.step_left, ramp.step_right);
+    __m256 index = _mm256_setr_ps(0.0f, 0.0f, 1.0f, 1.0f, 2.0f, 2.0f, 3.0f, 3.0f);
+
+    uint32_t i = 0;
+    for (; i < (num_frames & ~3u); i += 4)
+    {
+        const __m256 gain = _mm256_add_ps(base, _mm256_mul_ps(index, step));
+        const __m256 mixed = _mm256_add_ps(
+            _mm256_loadu_ps(bus + 2*i), _mm256_mul_ps(_mm256_loadu_ps(frames + 2*i), gain));
+        _mm256_storeu_ps(bus + 2*i, mixed);
+        index = _mm256_add_ps(index, _mm256_set1_ps(4.0f));
+    }
+    for (; i < num_frames; ++i)
+    {
+        audio_mix_scalar_kernels()->mix_f32(bus + 2*i, frames + 2*i, 1, frame_gain(ramp, i));
+    }
+}
+
+static void mix_s16_avx2(float* bus, const int16_t* frames, uint32_t num_frames, audio_gain_ramp_t ramp)
+{
+    const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+    const __m256 base = _mm256_setr_ps(
+        ramp.left, ramp.right, ramp.left, ramp.right, ramp.left, ramp.right, ramp.left, ramp.right);
+    const __m256 step = _mm256_setr_ps(
+        ramp.step_left, ramp.step_right, ramp.step_left, ramp.step_right,
+        ramp.step_left, ramp.step_right, ramp.step_left, ramp.step_right);
+    __m256 index = _mm256_setr_ps(0.0f, 0.0f, 1.0f, 1.0f, 2.0f, 2.0f, 3.0f, 3.0f);
+
+    // Eight stereo frames per iteration, widened to 32 bits four frames at a time.
+    uint32_t i = 0;
+    for (; i < (num_frames & ~7u); i += 8)
+    {
+        const __m128i samples_lo = _mm_loadu_si128((const __m128i*)(frames + 2*i + 0));
+        const __m128i samples_hi = _mm_loadu_si128((const __m128i*)(frames + 2*i + 8));
+        const __m256 lo = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(samples_lo)), scale);
+        const __m256 hi = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(samples_hi)), scale);
+
+        const __m256 gain_lo = _mm256_add_ps(base, _mm256_mul_ps(index, step));
+        index = _mm256_add_ps(index, _mm256_set1_ps(4.0f));
+        const __m256 gain_hi = _mm256_add_ps(base, _mm256_mul_ps(index, step));
+        index = _mm256_add_ps(index, _mm256_set1_ps(4.0f));
+
+        _mm256_storeu_ps(bus + 2*i + 0, _mm256_add_ps(_mm256_loadu_ps(bus + 2*i + 0), _mm256_mul_ps(lo, gain_lo)));
+        _mm256_storeu_ps(bus + 2*i + 8, _mm256_add_ps(_mm256_loadu_ps(bus + 2*i + 8), _mm256_mul_ps(hi, gain_hi)));
+    }
+    for (; i < num_frames; ++i)
+    {
+        audio_mix_scalar_kernels()->mix_s16(bus + 2*i, frames + 2*i, 1, frame_gain(ramp, i));
+    }
+}
+
+static float peak_avx2(const float* bus, uint32_t num_frames)
+{
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 peak = _mm256_setzero_ps();
+
+    const uint32_t n = 2 * num_frames;
+    uint32_t i = 0;
+    for (; i < (n & ~7u); i += 8)
+    {
+        peak = _mm256_max_ps(peak, _mm256_and_ps(_mm256_loadu_ps(bus + i), abs_mask));
+    }
+
+    __m128 peak4 = _mm_max_ps(_mm256_castps256_ps128(peak), _mm256_extractf128_ps(peak, 1));
+    peak4 = _mm_max_ps(peak4, _mm_shuffle_ps(peak4, peak4, _MM_SHUFFLE(1, 0, 3, 2)));
+    peak4 = _mm_max_ps(peak4, _mm_shuffle_ps(peak4, peak4, _MM_SHUFFLE(2, 3, 0, 1)));
+    const float tail = audio_mix_scalar_kernels()->peak(bus + i, (n - i) / 2);
+    const float result = _mm_cvtss_f32(peak4);
+    return tail > result ? tail : result;
+}
+
+static void limit_avx2(float* bus, uint32_t num_frames, float gain, float step, float knee)
+{
+    const __m256 sign_mask = _mm256_castsi256_ps(_mm256_set1_epi32((int32_t)0x80000000u));
+    const __m256 vgain = _mm256_set1_ps(gain);
+    const __m256 vstep = _mm256_set1_ps(step);
+    const __m256 vknee = _mm256_set1_ps(knee);
+    const __m256 vrange = _mm256_set1_ps(1.0f - knee);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256 index = _mm256_setr_ps(0.0f, 0.0f, 1.0f, 1.0f, 2.0f, 2.0f, 3.0f, 3.0f);
+
+    uint32_t i = 0;
+    for (; i < (num_frames & ~3u); i += 4)
+    {
+        const __m256 x = _mm256_mul_ps(_mm256_loadu_ps(bus + 2*i), _mm256_add_ps(vgain, _mm256_mul_ps(index, vstep)));
+        const __m256 a = _mm256_andnot_ps(sign_mask, x);
+        const __m256 z = _mm256_div_ps(_mm256_max_ps(_mm256_sub_ps(a, vknee), _mm256_setzero_ps()), vrange);
+        const __m256 y = _mm256_add_ps(
+            _mm256_min_ps(a, vknee), _mm256_mul_ps(vrange, _mm256_div_ps(z, _mm256_add_ps(one, z))));
+        _mm256_storeu_ps(bus + 2*i, _mm256_or_ps(y, _mm256_and_ps(x, sign_mask)));
+        index = _mm256_add_ps(index, _mm256_set1_ps(4.0f));
+    }
+    for (; i < num_frames; ++i)
+    {
+        audio_mix_scalar_kernels()->limit(bus + 2*i, 1, gain + (float)i * step, 0.0f, knee);
+    }
+}
+
+static void to_s16_avx2(int16_t* out, const float* bus, uint32_t num_frames)
+{
+    const __m256 scale = _mm256_set1_ps(32767.0f);
+    const __m256 low = _mm256_set1_ps(-32768.0f);
+    const __m256 high = _mm256_set1_ps(32767.0f);
+
+    const uint32_t n = 2 * num_frames;
+    uint32_t i = 0;
+    for (; i < (n & ~15u); i += 16)
+    {
+        const __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(bus + i + 0), scale), low), high);
+        const __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(bus + i + 8), scale), low), high);
+
+        // The pack works within each 128-bit lane, the 64-bit blocks are put back in order after.
+        const __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    audio_mix_scalar_kernels()->to_s16(out + i, bus + i, (n - i) / 2);
+}
+
+static const audio_mix_kernels_t avx2_kernels = {
+    .name = "avx2",
+    .mix_f32 = mix_f32_avx2,
+    .mix_s16 = mix_s16_avx2,
+    .peak = peak_avx2,
+    .limit = limit_avx2,
+    .to_s16 = to_s16_avx2,
+};
+
+const audio_mix_kernels_t* audio_mix_avx2_kernels(void)
+{
+    return &avx2_kernels;
+}
+
+#else
+
+const audio_mix_kernels_t* audio_mix_avx2_kernels(void)
+{
+    return NULL;
+}
+
+#endif // __AVX2__
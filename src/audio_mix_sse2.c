@@ -0,0 +1,153 @@
+#include "audio_mix.h"
+
+#include <stddef.h>
+
+#if defined(__SSE2__)
+
+#include <emmintrin.h>
+
+// Tails are processed by the scalar implementation. The gain of a frame depends on its index from
+// the start so they are handed over one frame at a time with the gain of that frame, which gives
+// the same result.
+static inline audio_gain_ramp_t frame_gain(audio_gain_ramp_t ramp, uint32_t i)
+{
+    return (audio_gain_ramp_t){ramp.left + (float)i * ramp.step_left, ramp.right + (float)i * ramp.step_right, 0, 0};
+}
+
+static void mix_f32_sse2(float* bus, const float* frames, uint32_t num_frames, audio_gain_ramp_t ramp)
+{
+    // Two stereo frames per iteration: lanes are L0 R0 L1 R1.
+    const __m128 base = _mm_setr_ps(ramp.left, ramp.right, ramp.left, ramp.right);
+    const __m128 step = _mm_setr_ps(ramp.step_left, ramp.step_right, ramp.step_left, ramp.step_right);
+    __m128 index = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+
+    uint32_t i = 0;
+    for (; i < (num_frames & ~1u); i += 2)
+    {
+        const __m128 gain = _mm_add_ps(base, _mm_mul_ps(index, step));
+        const __m128 mixed = _mm_add_ps(_mm_loadu_ps(bus + 2*i), _mm_mul_ps(_mm_loadu_ps(frames + 2*i), gain));
+        _mm_storeu_ps(bus + 2*i, mixed);
+        index = _mm_add_ps(index, _mm_set1_ps(2.0f));
+    }
+    for (; i < num_frames; ++i)
+    {
+        audio_mix_scalar_kernels()->mix_f32(bus + 2*i, frames + 2*i, 1, frame_gain(ramp, i));
+    }
+}
+
+static void mix_s16_sse2(float* bus, const int16_t* frames, uint32_t num_frames, audio_gain_ramp_t ramp)
+{
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    const __m128 base = _mm_setr_ps(ramp.left, ramp.right, ramp.left, ramp.right);
+    const __m128 step = _mm_setr_ps(ramp.step_left, ramp.step_right, ramp.step_left, ramp.step_right);
+    __m128 index = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+
+    // Four stereo frames per iteration, widened to 32 bits by interleaving each sample with itself
+    // and shifting the copy out with sign extension.
+    uint32_t i = 0;
+    for (; i < (num_frames & ~3u); i += 4)
+    {
+        const __m128i samples = _mm_loadu_si128((const __m128i*)(frames + 2*i));
+        const __m128 lo = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16)), scale);
+        const __m128 hi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16)), scale);
+
+        const __m128 gain_lo = _mm_add_ps(base, _mm_mul_ps(index, step));
+        index = _mm_add_ps(index, _mm_set1_ps(2.0f));
+        const __m128 gain_hi = _mm_add_ps(base, _mm_mul_ps(index, step));
+        index = _mm_add_ps(index, _mm_set1_ps(2.0f));
+
+        _mm_storeu_ps(bus + 2*i + 0, _mm_add_ps(_mm_loadu_ps(bus + 2*i + 0), _mm_mul_ps(lo, gain_lo)));
+        _mm_storeu_ps(bus + 2*i + 4, _mm_add_ps(_mm_loadu_ps(bus + 2*i + 4), _mm_mul_ps(hi, gain_hi)));
+    }
+    for (; i < num_frames; ++i)
+    {
+        audio_mix_scalar_kernels()->mix_s16(bus + 2*i, frames + 2*i, 1, frame_gain(ramp, i));
+    }
+}
+
+static float peak_sse2(const float* bus, uint32_t num_frames)
+{
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 peak = _mm_setzero_ps();
+
+    const uint32_t n = 2 * num_frames;
+    uint32_t i = 0;
+    for (; i < (n & ~3u); i += 4)
+    {
+        peak = _mm_max_ps(peak, _mm_and_ps(_mm_loadu_ps(bus + i), abs_mask));
+    }
+
+    peak = _mm_max_ps(peak, _mm_shuffle_ps(peak, peak, _MM_SHUFFLE(1, 0, 3, 2)));
+    peak = _mm_max_ps(peak, _mm_shuffle_ps(peak, peak, _MM_SHUFFLE(2, 3, 0, 1)));
+    const float tail = audio_mix_scalar_kernels()->peak(bus + i, (n - i) / 2);
+    const float result = _mm_cvtss_f32(peak);
+    return tail > result ? tail : result;
+}
+
+static void limit_sse2(float* bus, uint32_t num_frames, float gain, float step, float knee)
+{
+    const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32((int32_t)0x80000000u));
+    const __m128 vgain = _mm_set1_ps(gain);
+    const __m128 vstep = _mm_set1_ps(step);
+    const __m128 vknee = _mm_set1_ps(knee);
+    const __m128 vrange = _mm_set1_ps(1.0f - knee);
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 index = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+
+    uint32_t i = 0;
+    for (; i < (num_frames & ~1u); i += 2)
+    {
+        const __m128 x = _mm_mul_ps(_mm_loadu_ps(bus + 2*i), _mm_add_ps(vgain, _mm_mul_ps(index, vstep)));
+        const __m128 a = _mm_andnot_ps(sign_mask, x);
+        const __m128 z = _mm_div_ps(_mm_max_ps(_mm_sub_ps(a, vknee), _mm_setzero_ps()), vrange);
+        const __m128 y = _mm_add_ps(_mm_min_ps(a, vknee), _mm_mul_ps(vrange, _mm_div_ps(z, _mm_add_ps(one, z))));
+        _mm_storeu_ps(bus + 2*i, _mm_or_ps(y, _mm_and_ps(x, sign_mask)));
+        index = _mm_add_ps(index, _mm_set1_ps(2.0f));
+    }
+    for (; i < num_frames; ++i)
+    {
+        audio_mix_scalar_kernels()->limit(bus + 2*i, 1, gain + (float)i * step, 0.0f, knee);
+    }
+}
+
+static void to_s16_sse2(int16_t* out, const float* bus, uint32_t num_frames)
+{
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    const __m128 low = _mm_set1_ps(-32768.0f);
+    const __m128 high = _mm_set1_ps(32767.0f);
+
+    const uint32_t n = 2 * num_frames;
+    uint32_t i = 0;
+    for (; i < (n & ~7u); i += 8)
+    {
+        // Rounds to nearest even like `lrintf`, the pack saturates but the values are clamped
+        // beforehand because out of range conversions don't.
+        const __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(bus + i + 0), scale), low), high);
+        const __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(bus + i + 4), scale), low), high);
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+    audio_mix_scalar_kernels()->to_s16(out + i, bus + i, (n - i) / 2);
+}
+
+static const audio_mix_kernels_t sse2_kernels = {
+    .name = "sse2",
+    .mix_f32 = mix_f32_sse2,
+    .mix_s16 = mix_s16_sse2,
+    .peak = peak_sse2,
+    .limit = limit_sse2,
+    .to_s16 = to_s16_sse2,
+};
+
+const audio_mix_kernels_t* audio_mix_sse2_kernels(void)
+{
+    return &sse2_kernels;
+}
+
+#else
+
+const audio_mix_kernels_t* audio_mix_sse2_kernels(void)
+{
+    return NULL;
+}
+
+#endif // __SSE2__
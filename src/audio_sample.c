@@ -0,0 +1,219 @@
+#include "audio_sample.h"
+
+#include "allocator.h"
+
+#include <SDL2/SDL.h>
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+static const char* CONVERTED_EXTENSION = ".pcm";
+static const uint32_t CONVERTED_VERSION = 2;
+
+static const uint32_t frame_sizes[] = {
+    [AUDIO_SAMPLE_F32] = 2 * sizeof(float),
+    [AUDIO_SAMPLE_S16] = 2 * sizeof(int16_t),
+};
+
+static_assert(sizeof(frame_sizes) / sizeof(frame_sizes[0]) == _AUDIO_SAMPLE_FORMAT_COUNT,
+    "Every sample format must have a frame size.");
+enum { MAX_PATH_LENGTH = 512 };
+
+typedef struct converted_header_t converted_header_t;
+
+// Written as is, the persisted files are only meant to be read back on the same machine.
+struct converted_header_t
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t frequency;
+    uint32_t format;
+    uint32_t num_frames;
+    // The conversion is redone when the asset changes.
+    int64_t source_size;
+    int64_t source_mtime;
+};
+
+static bool source_info(const char* filename, int64_t* size, int64_t* mtime)
+{
+    struct stat info;
+    if (stat(filename, &info) != 0)
+    {
+        return false;
+    }
+
+    *size = info.st_size;
+    *mtime = info.st_mtime;
+    return true;
+}
+
+static bool converted_path(const char* filename, char path[MAX_PATH_LENGTH])
+{
+    const int length = snprintf(path, MAX_PATH_LENGTH, "%s%s", filename, CONVERTED_EXTENSION);
+    return length > 0 && length < MAX_PATH_LENGTH;
+}
+
+static bool load_converted(audio_sample_t* sample, const char* filename, uint32_t frequency)
+{
+    char path[MAX_PATH_LENGTH];
+    int64_t size, mtime;
+    if (!converted_path(filename, path) || !source_info(filename, &size, &mtime))
+    {
+        return false;
+    }
+
+    FILE* file = fopen(path, "rb");
+    if (!file)
+    {
+        return false;
+    }
+
+    converted_header_t header;
+    const bool valid = fread(&header, sizeof(header), 1, file) == 1
+        && memcmp(header.magic, "LDPC", 4) == 0
+        && header.version == CONVERTED_VERSION
+        && header.frequency == frequency
+        && header.format < _AUDIO_SAMPLE_FORMAT_COUNT
+        && header.source_size == size
+        && header.source_mtime == mtime
+        && header.num_frames > 0;
+
+    if (valid)
+    {
+        sample->format = header.format;
+        sample->frames = mem_alloc(MEMORY_TAG_AUDIO, (size_t)header.num_frames * frame_sizes[sample->format]);
+        sample->num_frames = header.num_frames;
+
+        if (fread(sample->frames, frame_sizes[sample->format], header.num_frames, file) != header.num_frames)
+        {
+            audio_sample_free(sample);
+        }
+    }
+
+    fclose(file);
+    return sample->frames != NULL;
+}
+
+static void persist_converted(const audio_sample_t* sample, const char* filename, uint32_t frequency)
+{
+    char path[MAX_PATH_LENGTH];
+    converted_header_t header = {
+        .magic = {'L', 'D', 'P', 'C'},
+        .version = CONVERTED_VERSION,
+        .frequency = frequency,
+        .format = sample->format,
+        .num_frames = sample->num_frames,
+    };
+    if (!converted_path(filename, path) || !source_info(filename, &header.source_size, &header.source_mtime))
+    {
+        return;
+    }
+
+    // Failing to persist only makes the next start slower.
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        return;
+    }
+
+    const bool written = fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(sample->frames, frame_sizes[sample->format], sample->num_frames, file) == sample->num_frames;
+    fclose(file);
+
+    if (!written)
+    {
+        remove(path);
+    }
+}
+
+static bool convert(audio_sample_t* sample, const char* filename, uint32_t frequency)
+{
+    SDL_AudioSpec spec;
+    uint8_t* buffer;
+    uint32_t length;
+    if (!SDL_LoadWAV(filename, &spec, &buffer, &length))
+    {
+        fprintf(stderr, "Couldn't load '%s': %s\n", filename, SDL_GetError());
+        return false;
+    }
+
+    // Anything more precise than 16-bit integers is kept as float.
+    const bool is_s16 = !SDL_AUDIO_ISFLOAT(spec.format) && SDL_AUDIO_BITSIZE(spec.format) <= 16;
+    sample->format = is_s16 ? AUDIO_SAMPLE_S16 : AUDIO_SAMPLE_F32;
+    const SDL_AudioFormat format = is_s16 ? AUDIO_S16SYS : AUDIO_F32SYS;
+
+    SDL_AudioCVT cvt;
+    if (SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq, format, 2, frequency) < 0)
+    {
+        fprintf(stderr, "Couldn't convert '%s': %s\n", filename, SDL_GetError());
+        SDL_FreeWAV(buffer);
+        return false;
+    }
+
+    // SDL converts in place and needs room for the intermediate steps.
+    cvt.len = length;
+    cvt.buf = mem_alloc(MEMORY_TAG_AUDIO, (size_t)length * cvt.len_mult);
+    memcpy(cvt.buf, buffer, length);
+    SDL_FreeWAV(buffer);
+
+    if (cvt.needed && SDL_ConvertAudio(&cvt) < 0)
+    {
+        fprintf(stderr, "Couldn't convert '%s': %s\n", filename, SDL_GetError());
+        mem_free(cvt.buf);
+        return false;
+    }
+
+    const uint32_t converted_length = cvt.needed ? (uint32_t)cvt.len_cvt : length;
+    sample->num_frames = converted_length / frame_sizes[sample->format];
+    if (sample->num_frames == 0)
+    {
+        mem_free(cvt.buf);
+        return false;
+    }
+
+    sample->frames = mem_realloc(MEMORY_TAG_AUDIO, cvt.buf, (size_t)sample->num_frames * frame_sizes[sample->format]);
+    return true;
+}
+
+bool audio_sample_load(audio_sample_t* sample, const char* filename, uint32_t frequency, bool persist)
+{
+    assert(sample && filename);
+
+    sample->frames = NULL;
+    sample->num_frames = 0;
+    sample->format = AUDIO_SAMPLE_F32;
+
+    if (load_converted(sample, filename, frequency))
+    {
+        return true;
+    }
+
+    if (!convert(sample, filename, frequency))
+    {
+        return false;
+    }
+
+    if (persist)
+    {
+        persist_converted(sample, filename, frequency);
+    }
+
+    return true;
+}
+
+void audio_sample_free(audio_sample_t* sample)
+{
+    assert(sample);
+
+    mem_free(sample->frames);
+    sample->frames = NULL;
+    sample->num_frames = 0;
+}
+
+uint32_t audio_sample_frame_size(enum AudioSampleFormat format)
+{
+    assert(format < _AUDIO_SAMPLE_FORMAT_COUNT);
+    return frame_sizes[format];
+}
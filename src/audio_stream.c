@@ -0,0 +1,429 @@
+#include "audio_stream.h"
+
+#include "allocator.h"
+#include "linalg.h"
+#include "spsc_queue.h"
+
+#include <SDL2/SDL.h>
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+// 8 chunks of 4096 float stereo frames: 256 KB per stream and ~683 ms of audio buffered at 48 kHz,
+// ~85 ms per chunk. A chunk is refilled as soon as the callback is done with it, so reading the
+// file may take up to the buffered time minus a chunk before the callback runs out.
+enum
+{
+    CHUNK_FRAMES = 4096,
+    NUM_CHUNKS = 8,
+    READ_BLOCK_BYTES = 16 * 1024,
+};
+
+// Resampling positions are 32.32 fixed point like the mixer ones.
+#define FRAC_BITS 32
+#define FRAC_ONE ((uint64_t)1 << FRAC_BITS)
+
+// How long the streaming thread sleeps when the callback doesn't wake it up.
+static const uint32_t STREAM_THREAD_TIMEOUT_MS = 100;
+
+// Streams not freed yet, closed ones included until their thread exits.
+static _Atomic uint32_t live_streams;
+
+enum
+{
+    WAVE_FORMAT_PCM = 0x0001,
+    WAVE_FORMAT_IEEE_FLOAT = 0x0003,
+    WAVE_FORMAT_EXTENSIBLE = 0xFFFE,
+};
+
+struct audio_stream_o
+{
+    SDL_RWops* file;
+
+    // File format.
+    uint16_t channels;
+    uint16_t bits;
+    uint32_t frame_size;
+    int64_t data_offset;
+    uint32_t num_frames;
+    // Frames [loop_start, loop_end) are repeated forever.
+    uint32_t loop_start;
+    uint32_t loop_end;
+
+    // Streaming thread side: raw frames read from the file and resampler state.
+    uint8_t* block;
+    uint32_t block_frames;
+    uint32_t block_position;
+    uint32_t file_frame;
+    uint64_t step;
+    uint64_t frac;
+    float previous[2];
+    float next[2];
+
+    // Chunks go from the streaming thread to the callback through `filled` and back through
+    // `consumed`.
+    float* chunks;
+    /* thread -> callback */ spsc_queue_t filled;
+    /* callback -> thread */ spsc_queue_t consumed;
+
+    // Audio callback side.
+    uint32_t current_chunk;
+    uint32_t chunk_position;
+    bool has_chunk;
+    _Atomic uint32_t underruns;
+
+    SDL_Thread* thread;
+    SDL_sem* wake;
+    _Atomic bool running;
+    // The game thread and the streaming thread each hold a reference, the last one to let go frees
+    // the stream so that closing never waits for the thread.
+    _Atomic uint32_t references;
+};
+
+//
+// WAV parsing.
+//
+
+static bool read_fourcc(SDL_RWops* file, char fourcc[4])
+{
+    return SDL_RWread(file, fourcc, 1, 4) == 4;
+}
+
+static bool parse_wav(struct audio_stream_o* stream, uint32_t* frequency, const char* filename)
+{
+    SDL_RWops* file = stream->file;
+
+    char id[4];
+    if (!read_fourcc(file, id) || SDL_memcmp(id, "RIFF", 4) != 0
+        || SDL_RWseek(file, 4, RW_SEEK_CUR) < 0
+        || !read_fourcc(file, id) || SDL_memcmp(id, "WAVE", 4) != 0)
+    {
+        fprintf(stderr, "'%s' isn't a WAV file.\n", filename);
+        return false;
+    }
+
+    uint16_t format = 0;
+    uint32_t data_size = 0;
+    uint32_t smpl_loop_start = 0;
+    uint32_t smpl_loop_end = 0;
+    bool has_data = false;
+
+    while (read_fourcc(file, id))
+    {
+        const uint32_t size = SDL_ReadLE32(file);
+        const int64_t next_chunk = SDL_RWtell(file) + size + (size & 1);
+
+        if (SDL_memcmp(id, "fmt ", 4) == 0)
+        {
+            format = SDL_ReadLE16(file);
+            stream->channels = SDL_ReadLE16(file);
+            *frequency = SDL_ReadLE32(file);
+            SDL_RWseek(file, 6, RW_SEEK_CUR); // Byte rate and block align.
+            stream->bits = SDL_ReadLE16(file);
+
+            if (format == WAVE_FORMAT_EXTENSIBLE && size >= 40)
+            {
+                // The actual format is the first two bytes of the sub-format GUID.
+                SDL_RWseek(file, 8, RW_SEEK_CUR);
+                format = SDL_ReadLE16(file);
+            }
+        }
+        else if (SDL_memcmp(id, "data", 4) == 0)
+        {
+            stream->data_offset = SDL_RWtell(file);
+            data_size = size;
+            has_data = true;
+        }
+        else if (SDL_memcmp(id, "smpl", 4) == 0 && size >= 60)
+        {
+            // Only the first loop is used, its end is inclusive.
+            SDL_RWseek(file, 28, RW_SEEK_CUR);
+            const uint32_t num_loops = SDL_ReadLE32(file);
+            SDL_RWseek(file, 4 + 8, RW_SEEK_CUR); // Sampler data, cue point id and type.
+            if (num_loops > 0)
+            {
+                smpl_loop_start = SDL_ReadLE32(file);
+                smpl_loop_end = SDL_ReadLE32(file) + 1;
+            }
+        }
+
+        if (SDL_RWseek(file, next_chunk, RW_SEEK_SET) < 0)
+        {
+            break;
+        }
+    }
+
+    const bool supported = stream->channels > 0 && *frequency > 0
+        && stream->channels * stream->bits / 8 <= READ_BLOCK_BYTES
+        && ((format == WAVE_FORMAT_PCM && (stream->bits == 8 || stream->bits == 16))
+            || (format == WAVE_FORMAT_IEEE_FLOAT && stream->bits == 32));
+    if (!has_data || !supported)
+    {
+        fprintf(stderr, "'%s' isn't a supported WAV file.\n", filename);
+        return false;
+    }
+
+    stream->frame_size = stream->channels * stream->bits / 8;
+    stream->num_frames = data_size / stream->frame_size;
+    stream->loop_start = 0;
+    stream->loop_end = stream->num_frames;
+    if (smpl_loop_start < smpl_loop_end && smpl_loop_end <= stream->num_frames)
+    {
+        stream->loop_start = smpl_loop_start;
+        stream->loop_end = smpl_loop_end;
+    }
+
+    return stream->num_frames > 0;
+}
+
+//
+// Streaming thread.
+//
+
+// Reads the next block of frames, going back to the loop start once the loop end is reached.
+static void read_block(struct audio_stream_o* stream)
+{
+    if (stream->file_frame >= stream->loop_end)
+    {
+        SDL_RWseek(stream->file, stream->data_offset + (int64_t)stream->loop_start * stream->frame_size, RW_SEEK_SET);
+        stream->file_frame = stream->loop_start;
+    }
+
+    const uint32_t max_frames = READ_BLOCK_BYTES / stream->frame_size;
+    const uint32_t left = stream->loop_end - stream->file_frame;
+    const uint32_t wanted = left < max_frames ? left : max_frames;
+    const uint32_t frames = (uint32_t)SDL_RWread(stream->file, stream->block, stream->frame_size, wanted);
+
+    // A truncated file plays silence rather than stopping the stream.
+    if (frames < wanted)
+    {
+        SDL_memset(stream->block + frames * stream->frame_size, 0, (wanted - frames) * stream->frame_size);
+    }
+
+    stream->file_frame += wanted;
+    stream->block_frames = wanted;
+    stream->block_position = 0;
+}
+
+static inline float decode_sample(const struct audio_stream_o* stream, const uint8_t* frame, uint32_t channel)
+{
+    switch (stream->bits)
+    {
+        case 8: return (frame[channel] - 128) * (1.0f / 128);
+        case 16:
+        {
+            int16_t sample;
+            SDL_memcpy(&sample, frame + 2*channel, 2);
+            return (int16_t)SDL_SwapLE16(sample) * (1.0f / 32768);
+        }
+        case 32:
+        {
+            float sample;
+            SDL_memcpy(&sample, frame + 4*channel, 4);
+            return SDL_SwapFloatLE(sample);
+        }
+        default: return 0;
+    }
+}
+
+static void pull_frame(struct audio_stream_o* stream, float out[2])
+{
+    if (stream->block_position == stream->block_frames)
+    {
+        read_block(stream);
+    }
+
+    const uint8_t* frame = stream->block + stream->block_position * stream->frame_size;
+    out[0] = decode_sample(stream, frame, 0);
+    out[1] = decode_sample(stream, frame, stream->channels > 1 ? 1 : 0);
+    stream->block_position++;
+}
+
+static void fill_chunk(struct audio_stream_o* stream, float* chunk)
+{
+    for (uint32_t i = 0; i < CHUNK_FRAMES; ++i)
+    {
+        while (stream->frac >= FRAC_ONE)
+        {
+            stream->previous[0] = stream->next[0];
+            stream->previous[1] = stream->next[1];
+            pull_frame(stream, stream->next);
+            stream->frac -= FRAC_ONE;
+        }
+
+        const float t = stream->frac * (1.0f / FRAC_ONE);
+        chunk[2*i + 0] = lerp(stream->previous[0], stream->next[0], t);
+        chunk[2*i + 1] = lerp(stream->previous[1], stream->next[1], t);
+        stream->frac += stream->step;
+    }
+}
+
+static void fill_consumed_chunks(struct audio_stream_o* stream)
+{
+    uint32_t chunk;
+    while (spsc_queue_pop(&stream->consumed, &chunk))
+    {
+        fill_chunk(stream, stream->chunks + chunk * CHUNK_FRAMES * 2);
+        const bool pushed = spsc_queue_push(&stream->filled, &chunk);
+        assert(pushed && "There are never more chunks than the queue capacity.");
+        (void)pushed;
+    }
+}
+
+static void free_stream(struct audio_stream_o* stream)
+{
+    if (stream->wake)
+    {
+        SDL_DestroySemaphore(stream->wake);
+    }
+
+    SDL_RWclose(stream->file);
+    spsc_queue_free(&stream->filled);
+    spsc_queue_free(&stream->consumed);
+    mem_free(stream->chunks);
+    mem_free(stream->block);
+    mem_free(stream);
+    atomic_fetch_sub_explicit(&live_streams, 1, memory_order_release);
+}
+
+static void release_stream(struct audio_stream_o* stream)
+{
+    if (atomic_fetch_sub_explicit(&stream->references, 1, memory_order_acq_rel) == 1)
+    {
+        free_stream(stream);
+    }
+}
+
+static int stream_thread(void* data)
+{
+    struct audio_stream_o* stream = data;
+
+    while (atomic_load_explicit(&stream->running, memory_order_acquire))
+    {
+        fill_consumed_chunks(stream);
+        SDL_SemWaitTimeout(stream->wake, STREAM_THREAD_TIMEOUT_MS);
+    }
+
+    release_stream(stream);
+    return 0;
+}
+
+//
+// Public API.
+//
+
+struct audio_stream_o* audio_stream_open(const char* filename, uint32_t frequency)
+{
+    SDL_RWops* file = SDL_RWFromFile(filename, "rb");
+    if (!file)
+    {
+        fprintf(stderr, "Couldn't open '%s': %s\n", filename, SDL_GetError());
+        return NULL;
+    }
+
+    struct audio_stream_o* stream = mem_alloc(MEMORY_TAG_AUDIO, sizeof(struct audio_stream_o));
+    SDL_memset(stream, 0, sizeof(struct audio_stream_o));
+    stream->file = file;
+
+    uint32_t file_frequency = 0;
+    if (!parse_wav(stream, &file_frequency, filename))
+    {
+        SDL_RWclose(file);
+        mem_free(stream);
+        return NULL;
+    }
+    atomic_fetch_add_explicit(&live_streams, 1, memory_order_relaxed);
+
+    stream->block = mem_alloc(MEMORY_TAG_AUDIO, READ_BLOCK_BYTES);
+    stream->chunks = mem_alloc(MEMORY_TAG_AUDIO, NUM_CHUNKS * CHUNK_FRAMES * 2 * sizeof(float));
+    spsc_queue_init(&stream->filled, sizeof(uint32_t), NUM_CHUNKS, MEMORY_TAG_AUDIO);
+    spsc_queue_init(&stream->consumed, sizeof(uint32_t), NUM_CHUNKS, MEMORY_TAG_AUDIO);
+
+    // Start reading at the beginning of the data, the intro before the loop start plays once.
+    SDL_RWseek(file, stream->data_offset, RW_SEEK_SET);
+    stream->file_frame = 0;
+    stream->step = ((uint64_t)file_frequency << FRAC_BITS) / frequency;
+    pull_frame(stream, stream->previous);
+    pull_frame(stream, stream->next);
+
+    // Prefill everything on this thread, nothing is shared yet.
+    for (uint32_t i = 0; i < NUM_CHUNKS; ++i)
+    {
+        spsc_queue_push(&stream->consumed, &i);
+    }
+    fill_consumed_chunks(stream);
+
+    atomic_init(&stream->underruns, 0);
+    atomic_init(&stream->running, true);
+    atomic_init(&stream->references, 2);
+    stream->wake = SDL_CreateSemaphore(0);
+    stream->thread = stream->wake ? SDL_CreateThread(stream_thread, "audio stream", stream) : NULL;
+    if (!stream->thread)
+    {
+        fprintf(stderr, "Couldn't start streaming '%s': %s\n", filename, SDL_GetError());
+        free_stream(stream);
+        return NULL;
+    }
+
+    // Nobody waits for the thread, it frees the stream when it is the last one to release it.
+    SDL_DetachThread(stream->thread);
+    return stream;
+}
+
+void audio_stream_close(struct audio_stream_o* stream)
+{
+    assert(stream);
+
+    // The reference of the game thread keeps the semaphore alive until it is posted.
+    atomic_store_explicit(&stream->running, false, memory_order_release);
+    SDL_SemPost(stream->wake);
+    release_stream(stream);
+}
+
+void audio_stream_mix(struct audio_stream_o* stream, float* bus, uint32_t num_frames, audio_gain_ramp_t ramp)
+{
+    uint32_t done = 0;
+    while (done < num_frames)
+    {
+        if (!stream->has_chunk)
+        {
+            if (!spsc_queue_pop(&stream->filled, &stream->current_chunk))
+            {
+                atomic_fetch_add_explicit(&stream->underruns, 1, memory_order_relaxed);
+                return;
+            }
+            stream->has_chunk = true;
+            stream->chunk_position = 0;
+        }
+
+        const float* chunk = stream->chunks + (stream->current_chunk * CHUNK_FRAMES + stream->chunk_position) * 2;
+        const uint32_t left = CHUNK_FRAMES - stream->chunk_position;
+        const uint32_t n = num_frames - done < left ? num_frames - done : left;
+
+        audio_mix_f32(bus + 2 * done, chunk, n, audio_gain_ramp_skip(ramp, done));
+
+        done += n;
+        stream->chunk_position += n;
+
+        if (stream->chunk_position == CHUNK_FRAMES)
+        {
+            spsc_queue_push(&stream->consumed, &stream->current_chunk);
+            stream->has_chunk = false;
+            SDL_SemPost(stream->wake);
+        }
+    }
+}
+
+uint32_t audio_stream_underruns(const struct audio_stream_o* stream)
+{
+    return atomic_load_explicit(&stream->underruns, memory_order_relaxed);
+}
+
+void audio_stream_wait_all_closed(void)
+{
+    while (atomic_load_explicit(&live_streams, memory_order_acquire) > 0)
+    {
+        SDL_Delay(1);
+    }
+}
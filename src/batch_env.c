@@ -0,0 +1,397 @@
+#include "batch_env.h"
+
+#include "allocator.h"
+#include "array.h"
+#include "atom.h"
+#include "camera.h"
+#include "camera_scrolling.h"
+#include "cpu_dispatch.h"
+#include "linalg.h"
+#include "linalg_batch.h"
+#include "player.h"
+#include "thread_pool.h"
+#include "tuning.h"
+
+#include <assert.h>
+#include <string.h>
+
+// Instances stepped by a thread before taking another block. Small enough to balance instances
+// with more neutrons than others, large enough for the blocks to be taken rarely.
+static const uint32_t STEP_BLOCK_SIZE = 8;
+// Steps of an instance after which its simulation must not allocate anymore (checked in debug
+// builds), as in the game.
+static const uint32_t ALLOCATION_WARMUP_STEPS = 60;
+
+typedef struct instance_t instance_t;
+typedef struct thread_scratch_t thread_scratch_t;
+typedef struct batch_env_o batch_env_o;
+
+struct instance_t
+{
+    struct atom_system_o* atoms;
+    struct player_o* player;
+    struct camera_o* camera;
+    struct camera_scrolling_system_o* scroll;
+
+    uint32_t episode;
+    uint32_t episode_steps;
+    uint32_t num_stabilized; // At the end of the previous step.
+    bool button;
+
+    // Only summed when the stats are asked for so that threads don't share counters.
+    batch_env_stats_t stats;
+};
+
+// Neutrons of the instance being observed.
+struct thread_scratch_t
+{
+    /* array */ float* x;
+    /* array */ float* y;
+    /* array */ float* vel_x;
+    /* array */ float* vel_y;
+    /* array */ float* dist_sq;
+};
+
+struct batch_env_o
+{
+    batch_env_config_t config;
+    struct thread_pool_o* pool;
+    instance_t* instances;
+    // One per thread, see `thread_pool_fn_t`.
+    thread_scratch_t* scratches;
+    uint32_t num_threads;
+
+    // Actions of the step being run.
+    batch_env_actions_t actions;
+
+    // Results, parallel to `instances`.
+    float* observations;
+    float* rewards;
+    uint8_t* dones;
+};
+
+static void start_episode(batch_env_o* env, uint32_t index)
+{
+    instance_t* instance = &env->instances[index];
+
+    // Seeds only depend on the instance and the episode, never on which thread runs them.
+    uint64_t state = env->config.seed ^ ((uint64_t)index << 32) ^ instance->episode;
+    const world_t world = tuning_world(&env->config.tuning, world_random_next(&state));
+
+    atom_system_reset(instance->atoms, world);
+    atom_system_set_chain_reaction(instance->atoms, tuning_chain_reaction(&env->config.tuning));
+    player_reset(instance->player);
+    camera_look_at(instance->camera, (vec2_t){0, 0});
+    // The first observation already sees the atoms around the player.
+    atom_system_stream(instance->atoms, (vec2_t){0, 0});
+    instance->episode_steps = 0;
+    instance->num_stabilized = 0;
+    instance->button = false;
+}
+
+// Same input handling as the game with the cursor moving every step.
+static void apply_action(batch_env_o* env, instance_t* instance, uint32_t index)
+{
+    const vec2_t cursor = {env->actions.cursor_x[index], env->actions.cursor_y[index]};
+    const bool button = env->actions.button[index] != 0;
+    const vec2_t target = camera_screen_to_world(instance->camera, cursor);
+
+    if (button && !instance->button)
+    {
+        player_start_move(instance->player, target);
+    }
+    else if (!button && instance->button)
+    {
+        player_stop_move(instance->player);
+    }
+    else
+    {
+        player_move_to(instance->player, target);
+    }
+    instance->button = button;
+}
+
+// Keeps the `k` smallest keys sorted in `keys`, with their index in `indices`. `num` entries are
+// already there.
+static uint32_t insert_nearest(float* keys, uint32_t* indices, uint32_t num, uint32_t k, float key, uint32_t index)
+{
+    if (num == k && key >= keys[k - 1])
+    {
+        return num;
+    }
+
+    uint32_t i = num < k ? num++ : k - 1;
+    for (; i > 0 && keys[i - 1] > key; --i)
+    {
+        keys[i] = keys[i - 1];
+        indices[i] = indices[i - 1];
+    }
+    keys[i] = key;
+    indices[i] = index;
+    return num;
+}
+
+static void observe(batch_env_o* env, instance_t* instance, thread_scratch_t* scratch, float* out)
+{
+    const vec2_t pos = player_position(instance->player);
+    const vec2_t move = vec2_sub(pos, player_previous_position(instance->player));
+    const vec2_t camera = vec2_sub(camera_position(instance->camera), pos);
+
+    *out++ = move.x / env->config.step_ms;
+    *out++ = move.y / env->config.step_ms;
+    *out++ = camera.x;
+    *out++ = camera.y;
+
+    // Every neutron is looked at, a handful of them is kept.
+    const uint32_t num_neutrons = atom_system_num_neutrons(instance->atoms);
+    mem_push_tag(MEMORY_TAG_MISC);
+    array_resize(scratch->x, num_neutrons);
+    array_resize(scratch->y, num_neutrons);
+    array_resize(scratch->vel_x, num_neutrons);
+    array_resize(scratch->vel_y, num_neutrons);
+    array_resize(scratch->dist_sq, num_neutrons);
+    mem_pop_tag();
+    atom_system_neutron_positions(instance->atoms, scratch->x, scratch->y);
+    atom_system_neutron_velocities(instance->atoms, scratch->vel_x, scratch->vel_y);
+    batch_dist_sq(scratch->dist_sq, scratch->x, scratch->y, pos, num_neutrons);
+
+    float keys[BATCH_ENV_NEAREST_NEUTRONS];
+    uint32_t nearest[BATCH_ENV_NEAREST_NEUTRONS];
+    uint32_t num_nearest = 0;
+    for (uint32_t i = 0; i < num_neutrons; ++i)
+    {
+        num_nearest = insert_nearest(keys, nearest, num_nearest, BATCH_ENV_NEAREST_NEUTRONS, scratch->dist_sq[i], i);
+    }
+    for (uint32_t i = 0; i < BATCH_ENV_NEAREST_NEUTRONS; ++i)
+    {
+        const bool present = i < num_nearest;
+        const uint32_t n = present ? nearest[i] : 0;
+        *out++ = present ? scratch->x[n] - pos.x : BATCH_ENV_ABSENT_DISTANCE;
+        *out++ = present ? scratch->y[n] - pos.y : BATCH_ENV_ABSENT_DISTANCE;
+        *out++ = present ? scratch->vel_x[n] : 0;
+        *out++ = present ? scratch->vel_y[n] : 0;
+    }
+
+    // There are few atoms, they are read one by one.
+    num_nearest = 0;
+    for (uint32_t i = 0; i < atom_system_num_atoms(instance->atoms); ++i)
+    {
+        const atom_info_t atom = atom_system_atom(instance->atoms, i);
+        if (atom.num_left > 0)
+        {
+            num_nearest = insert_nearest(keys, nearest, num_nearest, BATCH_ENV_NEAREST_ATOMS, vec2_dist_sq(atom.pos, pos), i);
+        }
+    }
+    for (uint32_t i = 0; i < BATCH_ENV_NEAREST_ATOMS; ++i)
+    {
+        if (i < num_nearest)
+        {
+            const atom_info_t atom = atom_system_atom(instance->atoms, nearest[i]);
+            *out++ = atom.pos.x - pos.x;
+            *out++ = atom.pos.y - pos.y;
+            *out++ = (float)atom.num_left / atom.num_exceeding_neutrons;
+        }
+        else
+        {
+            *out++ = BATCH_ENV_ABSENT_DISTANCE;
+            *out++ = BATCH_ENV_ABSENT_DISTANCE;
+            *out++ = 0;
+        }
+    }
+}
+
+// Same order as the update loop of the game.
+static void step_instance(batch_env_o* env, uint32_t index, thread_scratch_t* scratch)
+{
+    instance_t* instance = &env->instances[index];
+    const float step_ms = env->config.step_ms;
+
+    apply_action(env, instance, index);
+
+    // Streaming allocates the dormant state of the chunks it evicts.
+    atom_system_stream(instance->atoms, camera_position(instance->camera));
+
+    const bool check_allocations = instance->stats.steps >= ALLOCATION_WARMUP_STEPS;
+    if (check_allocations) mem_forbid_begin("batch env step");
+
+    camera_update(instance->camera);
+    player_update(instance->player, step_ms);
+    camera_scrolling_system_update(instance->scroll, instance->camera, instance->player);
+    atom_system_update(instance->atoms, instance->player, step_ms);
+
+    if (check_allocations) mem_forbid_end();
+
+    const uint32_t num_stabilized = atom_system_num_stabilized(instance->atoms);
+    float reward = (float)(num_stabilized - instance->num_stabilized);
+    instance->num_stabilized = num_stabilized;
+    instance->episode_steps++;
+    instance->stats.steps++;
+
+    const bool dead = player_is_dead(instance->player);
+    const bool won = env->config.tuning.stable_atoms_to_win > 0 && num_stabilized >= env->config.tuning.stable_atoms_to_win;
+    const bool timeout = env->config.max_episode_steps > 0 && instance->episode_steps >= env->config.max_episode_steps;
+    if (dead)
+    {
+        reward -= 1;
+        instance->stats.deaths++;
+    }
+    else if (won)
+    {
+        instance->stats.wins++;
+    }
+    else if (timeout)
+    {
+        instance->stats.timeouts++;
+    }
+
+    const bool done = dead || won || timeout;
+    if (done)
+    {
+        instance->stats.episodes++;
+        instance->episode++;
+        start_episode(env, index);
+    }
+
+    env->rewards[index] = reward;
+    env->dones[index] = done;
+    observe(env, instance, scratch, &env->observations[index * BATCH_ENV_OBSERVATION_SIZE]);
+}
+
+static void step_block(void* user, uint32_t begin, uint32_t end, uint32_t thread)
+{
+    batch_env_o* env = user;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        step_instance(env, i, &env->scratches[thread]);
+    }
+}
+
+static void reset_block(void* user, uint32_t begin, uint32_t end, uint32_t thread)
+{
+    batch_env_o* env = user;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        env->instances[i].episode = 0;
+        start_episode(env, i);
+        env->rewards[i] = 0;
+        env->dones[i] = 0;
+        observe(env, &env->instances[i], &env->scratches[thread], &env->observations[i * BATCH_ENV_OBSERVATION_SIZE]);
+    }
+}
+
+static batch_env_results_t results(const batch_env_o* env)
+{
+    return (batch_env_results_t){
+        .observations = env->observations,
+        .rewards = env->rewards,
+        .dones = env->dones,
+    };
+}
+
+batch_env_o* batch_env_create(batch_env_config_t config)
+{
+    assert(config.num_instances > 0 && config.step_ms > 0);
+
+    // Headless users don't go through the startup of the game.
+    cpu_dispatch_init();
+
+    batch_env_o* env = mem_alloc(MEMORY_TAG_MISC, sizeof(struct batch_env_o));
+    env->config = config;
+    env->pool = thread_pool_create(config.num_workers);
+    env->num_threads = 1 + thread_pool_num_workers(env->pool);
+    env->actions = (batch_env_actions_t){0};
+
+    const uint32_t n = config.num_instances;
+    env->instances = mem_alloc(MEMORY_TAG_MISC, n * sizeof(instance_t));
+    env->scratches = mem_alloc(MEMORY_TAG_MISC, env->num_threads * sizeof(thread_scratch_t));
+    env->observations = mem_alloc(MEMORY_TAG_MISC, n * BATCH_ENV_OBSERVATION_SIZE * sizeof(float));
+    env->rewards = mem_alloc(MEMORY_TAG_MISC, n * sizeof(float));
+    env->dones = mem_alloc(MEMORY_TAG_MISC, n * sizeof(uint8_t));
+    memset(env->scratches, 0, env->num_threads * sizeof(thread_scratch_t));
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        env->instances[i] = (instance_t){
+            .atoms = atom_system_create(),
+            .player = player_create(),
+            .camera = camera_create((vec2_t){0, 0}, config.viewport),
+            .scroll = camera_scrolling_system_create(),
+        };
+        atom_system_set_tuning(env->instances[i].atoms, &config.tuning);
+        player_set_tuning(env->instances[i].player, &config.tuning);
+        camera_scrolling_system_set_tuning(env->instances[i].scroll, &config.tuning);
+    }
+
+    batch_env_reset(env);
+    return env;
+}
+
+void batch_env_destroy(batch_env_o* env)
+{
+    assert(env);
+
+    thread_pool_destroy(env->pool);
+
+    for (uint32_t i = 0; i < env->config.num_instances; ++i)
+    {
+        camera_scrolling_system_destroy(env->instances[i].scroll);
+        camera_destroy(env->instances[i].camera);
+        player_destroy(env->instances[i].player);
+        atom_system_destroy(env->instances[i].atoms);
+    }
+    for (uint32_t i = 0; i < env->num_threads; ++i)
+    {
+        array_free(env->scratches[i].x);
+        array_free(env->scratches[i].y);
+        array_free(env->scratches[i].vel_x);
+        array_free(env->scratches[i].vel_y);
+        array_free(env->scratches[i].dist_sq);
+    }
+
+    mem_free(env->dones);
+    mem_free(env->rewards);
+    mem_free(env->observations);
+    mem_free(env->scratches);
+    mem_free(env->instances);
+    mem_free(env);
+}
+
+batch_env_results_t batch_env_reset(batch_env_o* env)
+{
+    assert(env);
+    thread_pool_for(env->pool, reset_block, env, env->config.num_instances, STEP_BLOCK_SIZE);
+    return results(env);
+}
+
+batch_env_results_t batch_env_step(batch_env_o* env, batch_env_actions_t actions)
+{
+    assert(env && actions.cursor_x && actions.cursor_y && actions.button);
+
+    env->actions = actions;
+    thread_pool_for(env->pool, step_block, env, env->config.num_instances, STEP_BLOCK_SIZE);
+    env->actions = (batch_env_actions_t){0};
+    return results(env);
+}
+
+batch_env_stats_t batch_env_stats(const batch_env_o* env)
+{
+    assert(env);
+
+    batch_env_stats_t total = {0};
+    for (uint32_t i = 0; i < env->config.num_instances; ++i)
+    {
+        const batch_env_stats_t* s = &env->instances[i].stats;
+        total.steps += s->steps;
+        total.episodes += s->episodes;
+        total.deaths += s->deaths;
+        total.wins += s->wins;
+        total.timeouts += s->timeouts;
+    }
+    return total;
+}
+
+uint32_t batch_env_num_threads(const batch_env_o* env)
+{
+    assert(env);
+    return env->num_threads;
+}
@@ -1,4 +1,6 @@
 #include "camera.h"
+
+#include "allocator.h"
 #include "linalg.h"
 
 #include <assert.h>
@@ -16,8 +18,7 @@ struct camera_o
 
 camera_o* camera_create(vec2_t pos, vec2_t viewport)
 {
-    // @Note @Todo: see later about custom allocators.
-    camera_o* camera = malloc(sizeof(struct camera_o));
+    camera_o* camera = mem_alloc(MEMORY_TAG_CAMERA, sizeof(struct camera_o));
     camera->pos = pos;
     camera->viewport = viewport;
     camera->inv_view = mat3_translation(pos.x, pos.y);
@@ -28,12 +29,7 @@ camera_o* camera_create(vec2_t pos, vec2_t viewport)
 void camera_destroy(struct camera_o* camera)
 {
     assert(camera);
-    free(camera);
-}
-
-void camera_handle_event(struct camera_o* camera, SDL_Event event)
-{
-    assert(camera);
+    mem_free(camera);
 }
 
 void camera_update(struct camera_o* camera)
@@ -72,6 +68,19 @@ vec2_t camera_world_to_screen(struct camera_o* camera, vec2_t world)
     return screen;
 }
 
+mat3_t camera_world_to_screen_matrix(struct camera_o* camera)
+{
+    assert(camera);
+
+    // Screen space has its origin at the top-left corner and its y axis going down.
+    const mat3_t to_screen = {
+        .x = {1, 0, 0},
+        .y = {0, -1, 0},
+        .z = {camera->viewport.x / 2, camera->viewport.y / 2, 1},
+    };
+    return mat3_mul(to_screen, camera->view);
+}
+
 mat3_t camera_view(struct camera_o* camera)
 {
     assert(camera);
@@ -83,6 +92,12 @@ vec2_t camera_position(struct camera_o* camera)
     return camera->pos;
 }
 
+vec2_t camera_viewport(struct camera_o* camera)
+{
+    assert(camera);
+    return camera->viewport;
+}
+
 void camera_look_at(struct camera_o* camera, vec2_t pos)
 {
     assert(camera);
@@ -1,8 +1,10 @@
 #include "camera_scrolling.h"
 
+#include "allocator.h"
 #include "camera.h"
 #include "linalg.h"
 #include "player.h"
+#include "tuning.h"
 
 #include <assert.h>
 #include <stdlib.h>
@@ -10,19 +12,27 @@
 struct camera_scrolling_system_o
 {
     vec2_t dir;
+    float follow;
 };
 
 struct camera_scrolling_system_o* camera_scrolling_system_create(void)
 {
-    struct camera_scrolling_system_o* scroll = malloc(sizeof(struct camera_scrolling_system_o));
+    struct camera_scrolling_system_o* scroll = mem_alloc(MEMORY_TAG_CAMERA, sizeof(struct camera_scrolling_system_o));
     scroll->dir = (vec2_t){0, 0};
+    scroll->follow = tuning_default().camera_follow;
     return scroll;
 }
 
 void camera_scrolling_system_destroy(struct camera_scrolling_system_o* scroll)
 {
     assert(scroll);
-    free(scroll);
+    mem_free(scroll);
+}
+
+void camera_scrolling_system_set_tuning(struct camera_scrolling_system_o* scroll, const struct tuning_t* tuning)
+{
+    assert(scroll && tuning);
+    scroll->follow = tuning->camera_follow;
 }
 
 void camera_scrolling_system_update(
@@ -32,14 +42,12 @@ void camera_scrolling_system_update(
 {
     assert(scroll && camera && player);
 
-    static const float DISTANCE_PERCENT = 0.02f;
-
     vec2_t player_pos = player_position(player);
     vec2_t camera_pos = camera_position(camera);
 
     if (player_pos.x == camera_pos.x && player_pos.y == camera_pos.y) return;
 
-    float speed = DISTANCE_PERCENT * vec2_dist(player_pos, camera_pos);
+    float speed = scroll->follow * vec2_dist(player_pos, camera_pos);
 
     // @Todo: this is a bit of a hack.
     // Avoid low float precision creating shaky visuals.
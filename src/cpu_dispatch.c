@@ -0,0 +1,154 @@
+#include "cpu_dispatch.h"
+
+#include "linalg_batch.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* SIMD_OVERRIDE_VARIABLE = "LD49_SIMD";
+
+static const char* level_names[] = {
+    [SIMD_LEVEL_SCALAR] = "scalar",
+    [SIMD_LEVEL_SSE2] = "sse2",
+    [SIMD_LEVEL_SSE41] = "sse4.1",
+    [SIMD_LEVEL_AVX2] = "avx2",
+    [SIMD_LEVEL_NEON] = "neon",
+};
+
+static_assert(sizeof(level_names) / sizeof(level_names[0]) == _SIMD_LEVEL_COUNT,
+    "Every SIMD level must have a name.");
+
+// Next level to try when one isn't supported.
+static const enum SimdLevel fallbacks[] = {
+    [SIMD_LEVEL_SCALAR] = SIMD_LEVEL_SCALAR,
+    [SIMD_LEVEL_SSE2] = SIMD_LEVEL_SCALAR,
+    [SIMD_LEVEL_SSE41] = SIMD_LEVEL_SSE2,
+    [SIMD_LEVEL_AVX2] = SIMD_LEVEL_SSE41,
+    [SIMD_LEVEL_NEON] = SIMD_LEVEL_SCALAR,
+};
+
+static enum SimdLevel current_level = SIMD_LEVEL_SCALAR;
+static bool initialized = false;
+
+// GCC and Clang read the features from cpuid, AVX2 only counts when the OS saves the YMM registers.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CPU_DISPATCH_X86 1
+#endif
+
+// NEON is part of arm64. 32-bit ARM builds only have it when compiled for it, the whole game then
+// requires it.
+#if defined(__aarch64__) || defined(__ARM_NEON)
+#define CPU_DISPATCH_NEON 1
+#endif
+
+static const linalg_batch_kernels_t* batch_kernels_for_level(enum SimdLevel level)
+{
+    switch (level)
+    {
+        case SIMD_LEVEL_SCALAR: return linalg_batch_scalar_kernels();
+        case SIMD_LEVEL_SSE2: return linalg_batch_sse2_kernels();
+        case SIMD_LEVEL_SSE41: return linalg_batch_sse41_kernels();
+        case SIMD_LEVEL_AVX2: return linalg_batch_avx2_kernels();
+        case SIMD_LEVEL_NEON: return linalg_batch_neon_kernels();
+        default: return NULL;
+    }
+}
+
+static bool cpu_has(enum SimdLevel level)
+{
+    switch (level)
+    {
+        case SIMD_LEVEL_SCALAR: return true;
+#if defined(CPU_DISPATCH_X86)
+        case SIMD_LEVEL_SSE2: return __builtin_cpu_supports("sse2");
+        case SIMD_LEVEL_SSE41: return __builtin_cpu_supports("sse4.1");
+        case SIMD_LEVEL_AVX2: return __builtin_cpu_supports("avx2");
+#endif
+#if defined(CPU_DISPATCH_NEON)
+        case SIMD_LEVEL_NEON: return true;
+#endif
+        default: return false;
+    }
+}
+
+bool cpu_dispatch_supported(enum SimdLevel level)
+{
+    assert(level < _SIMD_LEVEL_COUNT);
+    return cpu_has(level) && batch_kernels_for_level(level);
+}
+
+bool cpu_dispatch_select(enum SimdLevel level)
+{
+    if (!cpu_dispatch_supported(level))
+    {
+        return false;
+    }
+
+    current_level = level;
+    linalg_batch_set_kernels(batch_kernels_for_level(level));
+    return true;
+}
+
+void cpu_dispatch_init(void)
+{
+    if (initialized)
+    {
+        return;
+    }
+    initialized = true;
+
+#if defined(CPU_DISPATCH_X86)
+    __builtin_cpu_init();
+#endif
+
+    enum SimdLevel wanted = SIMD_LEVEL_AVX2;
+    if (cpu_dispatch_supported(SIMD_LEVEL_NEON))
+    {
+        wanted = SIMD_LEVEL_NEON;
+    }
+
+    const char* forced = getenv(SIMD_OVERRIDE_VARIABLE);
+    if (forced)
+    {
+        enum SimdLevel level = 0;
+        while (level < _SIMD_LEVEL_COUNT && strcmp(forced, level_names[level]) != 0)
+        {
+            level++;
+        }
+
+        if (level < _SIMD_LEVEL_COUNT)
+        {
+            wanted = level;
+        }
+        else
+        {
+            fprintf(stderr, "Unknown %s value '%s', ignored.\n", SIMD_OVERRIDE_VARIABLE, forced);
+        }
+    }
+
+    enum SimdLevel level = wanted;
+    while (!cpu_dispatch_select(level))
+    {
+        level = fallbacks[level];
+    }
+
+    printf("CPU dispatch: %s", level_names[current_level]);
+    if (forced && level != wanted)
+    {
+        printf(" (%s not supported)", level_names[wanted]);
+    }
+    printf(", batch maths: %s\n", linalg_batch_name());
+}
+
+enum SimdLevel cpu_dispatch_level(void)
+{
+    return current_level;
+}
+
+const char* cpu_dispatch_level_name(enum SimdLevel level)
+{
+    assert(level < _SIMD_LEVEL_COUNT);
+    return level_names[level];
+}
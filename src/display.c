@@ -1,11 +1,26 @@
 #include "display.h"
 
+#include "allocator.h"
+
 #include <SDL2/SDL.h>
 
 #include <assert.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+// Weight of the last frame in the average frame time.
+static const float FRAME_TIME_SMOOTHING = 0.1f;
+// The scale of the world is adjusted every this many frames, a change takes a few frames to show in
+// the average.
+static const uint32_t SCALE_ADJUST_FRAMES = 10;
+// Below this fraction of the target frame time the resolution goes back up.
+static const float FRAME_TIME_HEADROOM = 0.85f;
+// Largest change of the scale per adjustment. It goes down faster than up so a heavy scene is
+// caught quickly and the resolution doesn't oscillate around the target.
+static const float SCALE_MIN_FACTOR = 0.8f;
+static const float SCALE_MAX_FACTOR = 1.05f;
+
 struct display_o
 {
     struct SDL_Window* window;
@@ -13,14 +28,34 @@ struct display_o
 
     uint32_t logical_width;
     uint32_t logical_height;
+
+    bool dynamic;
+    dynamic_resolution_t resolution;
+    // Allocated for the largest scale of the current window size, the world is only drawn to its
+    // top-left corner (`world_rect`) so changing the scale never reallocates it.
+    struct SDL_Texture* world_target;
+    int output_width;
+    int output_height;
+    SDL_Rect world_rect;
+    float world_scale;
+
+    // Start of the world of the current frame, 0 when it isn't drawn.
+    uint64_t frame_start;
+    float average_frame_ms;
+    uint32_t frames_since_adjust;
 };
 
 struct display_o* display_create(uint32_t width, uint32_t height, const char* title)
 {
-    // @Note @Todo: see later about custom allocators.
-    struct display_o* display = malloc(sizeof(struct display_o));
+    struct display_o* display = mem_alloc(MEMORY_TAG_DISPLAY, sizeof(struct display_o));
     display->logical_width = width,
     display->logical_height = height,
+    display->dynamic = false;
+    display->world_target = NULL;
+    display->world_scale = 1;
+    display->frame_start = 0;
+    display->average_frame_ms = 0;
+    display->frames_since_adjust = 0;
 
     display->window = SDL_CreateWindow(
         title,
@@ -53,9 +88,13 @@ void display_destroy(struct display_o* display)
 {
     assert(display);
 
+    if (display->world_target)
+    {
+        SDL_DestroyTexture(display->world_target);
+    }
     SDL_DestroyRenderer(display->render);
     SDL_DestroyWindow(display->window);
-    free(display);
+    mem_free(display);
 }
 
 void display_set_title(struct display_o* display, const char* title)
@@ -71,3 +110,150 @@ struct SDL_Renderer* display_get_renderer(struct display_o* display)
     assert(display);
     return display->render;
 }
+
+bool display_enable_dynamic_resolution(struct display_o* display, const dynamic_resolution_t* resolution)
+{
+    assert(display && resolution);
+    assert(resolution->target_frame_ms > 0);
+    assert(0 < resolution->min_scale && resolution->min_scale <= resolution->max_scale);
+
+    if (!display->render || !SDL_RenderTargetSupported(display->render))
+    {
+        fprintf(stderr, "Dynamic resolution disabled, the renderer can't draw to textures.\n");
+        return false;
+    }
+
+    display->dynamic = true;
+    display->resolution = *resolution;
+    display->world_scale = resolution->max_scale;
+    display->average_frame_ms = 0;
+    display->frames_since_adjust = 0;
+    return true;
+}
+
+// The target follows the size of the window, it is only recreated when the window is resized.
+static bool update_world_target(struct display_o* display)
+{
+    int output_width = 0;
+    int output_height = 0;
+    SDL_GetRendererOutputSize(display->render, &output_width, &output_height);
+
+    if (!display->world_target
+        || output_width != display->output_width
+        || output_height != display->output_height)
+    {
+        if (display->world_target)
+        {
+            SDL_DestroyTexture(display->world_target);
+        }
+
+        display->world_target = SDL_CreateTexture(
+            display->render, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+            ceilf(output_width * display->resolution.max_scale),
+            ceilf(output_height * display->resolution.max_scale));
+        display->output_width = output_width;
+        display->output_height = output_height;
+
+        if (!display->world_target)
+        {
+            fprintf(stderr, "Error creating the world target: %s\n", SDL_GetError());
+            return false;
+        }
+        SDL_SetTextureScaleMode(display->world_target, SDL_ScaleModeLinear);
+    }
+
+    display->world_rect = (SDL_Rect){
+        .x = 0,
+        .y = 0,
+        .w = fmaxf(1, roundf(output_width * display->world_scale)),
+        .h = fmaxf(1, roundf(output_height * display->world_scale)),
+    };
+    return true;
+}
+
+void display_begin_world(struct display_o* display)
+{
+    assert(display);
+
+    display->frame_start = SDL_GetPerformanceCounter();
+
+    if (!display->dynamic || !update_world_target(display))
+    {
+        return;
+    }
+
+    // Switching the target resets the scale and the viewport, the ones of the window come back
+    // when switching back. The scale is set first as the viewport is given in logical coordinates.
+    SDL_SetRenderTarget(display->render, display->world_target);
+    SDL_RenderSetScale(
+        display->render,
+        (float)display->world_rect.w / display->logical_width,
+        (float)display->world_rect.h / display->logical_height);
+    SDL_RenderSetViewport(
+        display->render, &(SDL_Rect){0, 0, display->logical_width, display->logical_height});
+
+    SDL_SetRenderDrawColor(display->render, 0, 0, 0, 255);
+    SDL_RenderFillRect(display->render, NULL);
+}
+
+void display_end_world(struct display_o* display)
+{
+    assert(display);
+
+    if (!display->dynamic || !display->world_target)
+    {
+        return;
+    }
+
+    SDL_SetRenderTarget(display->render, NULL);
+    SDL_RenderCopy(display->render, display->world_target, &display->world_rect, NULL);
+}
+
+// Only the frames drawing the world are measured, from the start of the world to the end of the
+// present. Waiting for input or updating the simulation doesn't depend on the resolution.
+static void adjust_world_scale(struct display_o* display, float frame_ms)
+{
+    const dynamic_resolution_t* resolution = &display->resolution;
+
+    display->average_frame_ms = display->average_frame_ms > 0
+        ? display->average_frame_ms + (frame_ms - display->average_frame_ms) * FRAME_TIME_SMOOTHING
+        : frame_ms;
+
+    display->frames_since_adjust += 1;
+    if (display->frames_since_adjust < SCALE_ADJUST_FRAMES)
+    {
+        return;
+    }
+    display->frames_since_adjust = 0;
+
+    const float average = display->average_frame_ms;
+    if (average > resolution->target_frame_ms
+        || average < resolution->target_frame_ms * FRAME_TIME_HEADROOM)
+    {
+        // The cost of the world grows with its number of pixels, the square of the scale.
+        const float factor = fminf(fmaxf(
+            sqrtf(resolution->target_frame_ms / average), SCALE_MIN_FACTOR), SCALE_MAX_FACTOR);
+        display->world_scale = fminf(fmaxf(
+            display->world_scale * factor, resolution->min_scale), resolution->max_scale);
+    }
+}
+
+void display_present(struct display_o* display)
+{
+    assert(display);
+
+    SDL_RenderPresent(display->render);
+
+    if (display->dynamic && display->frame_start != 0)
+    {
+        const uint64_t elapsed = SDL_GetPerformanceCounter() - display->frame_start;
+        adjust_world_scale(display, 1000.0 * elapsed / SDL_GetPerformanceFrequency());
+    }
+    display->frame_start = 0;
+}
+
+float display_world_scale(struct display_o* display)
+{
+    assert(display);
+    return display->dynamic ? display->world_scale : 1;
+}
@@ -0,0 +1,265 @@
+#include "game.h"
+
+#include "allocator.h"
+#include "array.h"
+#include "display.h"
+#include "hot_reload.h"
+#include "input.h"
+#include "texture_cache.h"
+#include "timeline.h"
+
+#include <SDL2/SDL.h>
+
+#include <assert.h>
+
+// Longest wait for an event while an idle state is on top, the screen is still redrawn this often.
+static const uint32_t IDLE_REDRAW_MS = 100;
+
+struct game_o
+{
+    struct display_o* display;
+    struct audio_system_o* audio;
+    struct texture_cache_o* textures;
+    struct hot_reload_o* hot_reload;
+    struct camera_o* camera;
+    input_t input;
+
+    /* array */ game_state_t** stack;
+    // Set by stack changes so that the loop stops updating the previous top state and the new one
+    // doesn't catch up with the time spent in the previous one.
+    bool stack_changed;
+    bool quit;
+};
+
+struct game_o* game_create(struct display_o* display, struct audio_system_o* audio)
+{
+    struct game_o* game = mem_alloc(MEMORY_TAG_MISC, sizeof(struct game_o));
+    game->display = display;
+    game->audio = audio;
+    game->textures = texture_cache_create(display_get_renderer(display));
+    game->hot_reload = hot_reload_create("assets", game->textures, audio);
+    game->camera = NULL;
+    game->input = (input_t){0};
+    game->stack = NULL;
+    game->stack_changed = false;
+    game->quit = false;
+    return game;
+}
+
+void game_destroy(struct game_o* game)
+{
+    assert(game);
+
+    // States still on the stack are left top first as if they were popped.
+    while (array_size(game->stack) > 0)
+    {
+        game_pop_state(game);
+    }
+
+    array_free(game->stack);
+    hot_reload_destroy(game->hot_reload);
+    texture_cache_destroy(game->textures);
+    mem_free(game);
+}
+
+static game_state_t* top_state(struct game_o* game)
+{
+    const uint32_t size = array_size(game->stack);
+    return size > 0 ? game->stack[size - 1] : NULL;
+}
+
+static bool running(struct game_o* game)
+{
+    return !game->quit && array_size(game->stack) > 0;
+}
+
+static void draw(struct game_o* game)
+{
+    SDL_Renderer* render = display_get_renderer(game->display);
+
+    // Overlays are drawn over the states below them down to the first opaque one.
+    uint32_t first = array_size(game->stack) - 1;
+    while (first > 0 && game->stack[first]->overlay)
+    {
+        first--;
+    }
+
+    SDL_SetRenderDrawColor(render, 0, 0, 0, 0);
+    SDL_RenderClear(render);
+
+    for (uint32_t i = first; i < array_size(game->stack); ++i)
+    {
+        const game_state_t* state = game->stack[i];
+        if (state->draw)
+        {
+            state->draw(state->user, game, render);
+        }
+    }
+
+    display_present(game->display);
+}
+
+void game_run(struct game_o* game)
+{
+    assert(game);
+
+    // @Todo: use SDL_GetPerformanceCounter() coupled with SDL_GetPerformanceFrequency().
+    uint32_t last_time = SDL_GetTicks();
+    uint32_t time_accumulator = 0;
+
+    // The startup ends once the first frame is shown.
+    const uint32_t first_frame_phase = timeline_begin("first frame");
+    bool first_frame = true;
+
+    while (running(game))
+    {
+        // Assets modified on disk are swapped in before anything uses them this frame.
+        hot_reload_apply(game->hot_reload);
+
+        //
+        // Input
+        //
+
+        input_poll(&game->input, top_state(game)->idle ? IDLE_REDRAW_MS : 0, game->camera);
+        if (game->input.quit)
+        {
+            game_quit(game);
+            break;
+        }
+
+        const game_state_t* top = top_state(game);
+        if (top->handle_input)
+        {
+            top->handle_input(top->user, game, &game->input);
+        }
+
+        if (!running(game))
+        {
+            break;
+        }
+
+        //
+        // Logic
+        //
+
+        const uint32_t now = SDL_GetTicks();
+        const uint32_t elapsed = now - last_time;
+
+        // If elapsed is 0 it means the frametime was below the timer precision. In this case we
+        // don't update `last_time`, skip the logic part and only perform the rendering.
+        if (elapsed != 0)
+        {
+            last_time = now;
+        }
+
+        time_accumulator += elapsed;
+        if (game->stack_changed || top_state(game)->idle)
+        {
+            game->stack_changed = false;
+            time_accumulator = 0;
+        }
+
+        while (time_accumulator >= GAME_UPDATE_STEP_MS && running(game) && !game->stack_changed)
+        {
+            const game_state_t* state = top_state(game);
+            if (state->update)
+            {
+                state->update(state->user, game);
+            }
+            time_accumulator -= GAME_UPDATE_STEP_MS;
+        }
+
+        if (!running(game))
+        {
+            break;
+        }
+
+        //
+        // Render
+        //
+
+        draw(game);
+
+        if (first_frame)
+        {
+            timeline_end(first_frame_phase);
+            first_frame = false;
+        }
+    }
+}
+
+void game_quit(struct game_o* game)
+{
+    assert(game);
+    game->quit = true;
+}
+
+void game_push_state(struct game_o* game, game_state_t* state)
+{
+    assert(game && state);
+
+    mem_push_tag(MEMORY_TAG_MISC);
+    array_push(game->stack, state);
+    mem_pop_tag();
+    game->stack_changed = true;
+
+    if (state->enter)
+    {
+        state->enter(state->user, game);
+    }
+}
+
+void game_pop_state(struct game_o* game)
+{
+    assert(game && array_size(game->stack) > 0);
+
+    game_state_t* state = top_state(game);
+    array_pop(game->stack);
+    game->stack_changed = true;
+
+    if (state->exit)
+    {
+        state->exit(state->user, game);
+    }
+}
+
+void game_switch_state(struct game_o* game, game_state_t* state)
+{
+    assert(game && state);
+
+    if (array_size(game->stack) > 0)
+    {
+        game_pop_state(game);
+    }
+    game_push_state(game, state);
+}
+
+bool game_is_top_state(struct game_o* game, const game_state_t* state)
+{
+    assert(game && state);
+    return top_state(game) == state;
+}
+
+void game_set_camera(struct game_o* game, struct camera_o* camera)
+{
+    assert(game);
+    game->camera = camera;
+}
+
+struct display_o* game_display(struct game_o* game)
+{
+    assert(game);
+    return game->display;
+}
+
+struct audio_system_o* game_audio(struct game_o* game)
+{
+    assert(game);
+    return game->audio;
+}
+
+struct texture_cache_o* game_textures(struct game_o* game)
+{
+    assert(game);
+    return game->textures;
+}
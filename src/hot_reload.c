@@ -0,0 +1,316 @@
+#include "hot_reload.h"
+
+#include <stddef.h>
+
+#if !defined(NDEBUG) && defined(__linux__)
+
+#include "allocator.h"
+#include "audio.h"
+#include "audio_sample.h"
+#include "render.h"
+#include "spsc_queue.h"
+#include "texture_cache.h"
+
+#include <SDL2/SDL.h>
+
+#include <assert.h>
+#include <dirent.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+enum { MAX_PATH_LENGTH = 256 };
+enum { MAX_WATCHED_DIRECTORIES = 16 };
+// Loaded assets waiting for the game thread. An asset that doesn't fit is dropped, saving it
+// again reloads it.
+static const uint32_t RELOAD_QUEUE_CAPACITY = 16;
+// The watching thread checks this often whether it must stop.
+static const int WATCH_POLL_MS = 100;
+
+enum ReloadType
+{
+    RELOAD_IMAGE = 0,
+    RELOAD_SOUND,
+};
+
+typedef struct reload_t reload_t;
+
+struct reload_t
+{
+    enum ReloadType type;
+    char path[MAX_PATH_LENGTH];
+    image_t image;
+    audio_sample_t sample;
+};
+
+typedef struct watched_directory_t watched_directory_t;
+
+struct watched_directory_t
+{
+    int watch;
+    char path[MAX_PATH_LENGTH];
+};
+
+struct hot_reload_o
+{
+    struct texture_cache_o* textures;
+    struct audio_system_o* audio;
+
+    int inotify;
+    watched_directory_t directories[MAX_WATCHED_DIRECTORIES];
+    uint32_t num_directories;
+
+    /* watcher -> game */ spsc_queue_t reloads;
+    SDL_Thread* thread;
+    atomic_bool quit;
+};
+
+static bool has_extension(const char* name, const char* extension)
+{
+    const size_t name_length = strlen(name);
+    const size_t extension_length = strlen(extension);
+    return name_length > extension_length
+        && strcmp(name + name_length - extension_length, extension) == 0;
+}
+
+// Subdirectories are watched too, inotify doesn't do it by itself.
+static void watch_directory(struct hot_reload_o* reload, const char* path)
+{
+    if (reload->num_directories == MAX_WATCHED_DIRECTORIES)
+    {
+        fprintf(stderr, "Too many directories, '%s' isn't hot reloaded.\n", path);
+        return;
+    }
+
+    // Editors either write the file or write another one and rename it over.
+    const int watch = inotify_add_watch(reload->inotify, path, IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watch < 0)
+    {
+        fprintf(stderr, "Couldn't watch '%s' for hot reload.\n", path);
+        return;
+    }
+
+    watched_directory_t* directory = &reload->directories[reload->num_directories++];
+    directory->watch = watch;
+    snprintf(directory->path, MAX_PATH_LENGTH, "%s", path);
+
+    DIR* dir = opendir(path);
+    if (!dir)
+    {
+        return;
+    }
+
+    const struct dirent* child;
+    while ((child = readdir(dir)))
+    {
+        char child_path[MAX_PATH_LENGTH];
+        struct stat info;
+        if (child->d_name[0] != '.'
+            && snprintf(child_path, MAX_PATH_LENGTH, "%s/%s", path, child->d_name) < MAX_PATH_LENGTH
+            && stat(child_path, &info) == 0 && S_ISDIR(info.st_mode))
+        {
+            watch_directory(reload, child_path);
+        }
+    }
+    closedir(dir);
+}
+
+static const char* watched_path(const struct hot_reload_o* reload, int watch)
+{
+    for (uint32_t i = 0; i < reload->num_directories; ++i)
+    {
+        if (reload->directories[i].watch == watch)
+        {
+            return reload->directories[i].path;
+        }
+    }
+    return NULL;
+}
+
+static void free_reload(reload_t* r)
+{
+    image_free(&r->image);
+    audio_sample_free(&r->sample);
+}
+
+// Reads the asset on the watching thread, files the game doesn't load are ignored.
+static void decode(struct hot_reload_o* reload, const char* directory, const char* name)
+{
+    reload_t r = {0};
+    if (snprintf(r.path, MAX_PATH_LENGTH, "%s/%s", directory, name) >= MAX_PATH_LENGTH)
+    {
+        return;
+    }
+
+    if (has_extension(name, ".bmp") || has_extension(name, ".qoi"))
+    {
+        // Images are named by their BMP, `load_image` takes the most recent of the two files.
+        memcpy(r.path + strlen(r.path) - 4, ".bmp", 4);
+        r.type = RELOAD_IMAGE;
+        if (!load_image(r.path, &r.image))
+        {
+            return;
+        }
+    }
+    else if (has_extension(name, ".wav"))
+    {
+        r.type = RELOAD_SOUND;
+        if (!audio_system_load_sound(r.path, &r.sample))
+        {
+            return;
+        }
+    }
+    else
+    {
+        return;
+    }
+
+    if (!spsc_queue_push(&reload->reloads, &r))
+    {
+        fprintf(stderr, "Too many reloads at once, '%s' is dropped.\n", r.path);
+        free_reload(&r);
+    }
+}
+
+static int watch_thread(void* data)
+{
+    struct hot_reload_o* reload = data;
+
+    // Buffer aligned for the events, reads only return whole events.
+    _Alignas(struct inotify_event) char buffer[4096];
+
+    while (!atomic_load(&reload->quit))
+    {
+        struct pollfd fd = {.fd = reload->inotify, .events = POLLIN};
+        if (poll(&fd, 1, WATCH_POLL_MS) <= 0)
+        {
+            continue;
+        }
+
+        const ssize_t length = read(reload->inotify, buffer, sizeof(buffer));
+        for (ssize_t offset = 0; offset < length;)
+        {
+            const struct inotify_event* event = (const struct inotify_event*)&buffer[offset];
+            const char* directory = watched_path(reload, event->wd);
+            if (event->len > 0 && directory)
+            {
+                decode(reload, directory, event->name);
+            }
+            offset += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    return 0;
+}
+
+struct hot_reload_o* hot_reload_create(
+    const char* directory,
+    struct texture_cache_o* textures,
+    struct audio_system_o* audio)
+{
+    assert(directory && textures && audio);
+
+    const int inotify = inotify_init();
+    if (inotify < 0)
+    {
+        fprintf(stderr, "Hot reload disabled, inotify isn't available.\n");
+        return NULL;
+    }
+
+    struct hot_reload_o* reload = mem_alloc(MEMORY_TAG_MISC, sizeof(struct hot_reload_o));
+    reload->textures = textures;
+    reload->audio = audio;
+    reload->inotify = inotify;
+    reload->num_directories = 0;
+    spsc_queue_init(&reload->reloads, sizeof(reload_t), RELOAD_QUEUE_CAPACITY, MEMORY_TAG_MISC);
+    atomic_init(&reload->quit, false);
+
+    // The directories are all watched before the thread starts, it reads them without locking.
+    watch_directory(reload, directory);
+    reload->thread = SDL_CreateThread(watch_thread, "hot reload", reload);
+    if (!reload->thread)
+    {
+        fprintf(stderr, "Hot reload disabled, couldn't create its thread: %s\n", SDL_GetError());
+    }
+
+    return reload;
+}
+
+void hot_reload_destroy(struct hot_reload_o* reload)
+{
+    if (!reload)
+    {
+        return;
+    }
+
+    atomic_store(&reload->quit, true);
+    SDL_WaitThread(reload->thread, NULL);
+
+    reload_t r;
+    while (spsc_queue_pop(&reload->reloads, &r))
+    {
+        free_reload(&r);
+    }
+
+    spsc_queue_free(&reload->reloads);
+    close(reload->inotify);
+    mem_free(reload);
+}
+
+void hot_reload_apply(struct hot_reload_o* reload)
+{
+    if (!reload)
+    {
+        return;
+    }
+
+    reload_t r;
+    while (spsc_queue_pop(&reload->reloads, &r))
+    {
+        bool reloaded = true;
+        switch (r.type)
+        {
+            case RELOAD_IMAGE:
+                reloaded = texture_cache_reload(reload->textures, r.path, &r.image);
+                break;
+            case RELOAD_SOUND:
+                audio_system_replace_sound(reload->audio, r.path, &r.sample);
+                break;
+        }
+
+        if (reloaded)
+        {
+            printf("Reloaded '%s'\n", r.path);
+        }
+    }
+}
+
+#else
+
+struct hot_reload_o* hot_reload_create(
+    const char* directory,
+    struct texture_cache_o* textures,
+    struct audio_system_o* audio)
+{
+    (void)directory;
+    (void)textures;
+    (void)audio;
+    return NULL;
+}
+
+void hot_reload_destroy(struct hot_reload_o* reload)
+{
+    (void)reload;
+}
+
+void hot_reload_apply(struct hot_reload_o* reload)
+{
+    (void)reload;
+}
+
+#endif // !NDEBUG && __linux__
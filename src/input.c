@@ -0,0 +1,93 @@
+#include "input.h"
+
+#include "camera.h"
+
+#include <SDL2/SDL.h>
+
+#include <assert.h>
+
+static uint32_t button_bit(uint8_t button)
+{
+    switch (button)
+    {
+        case SDL_BUTTON_LEFT: return INPUT_BUTTON_LEFT;
+        case SDL_BUTTON_MIDDLE: return INPUT_BUTTON_MIDDLE;
+        case SDL_BUTTON_RIGHT: return INPUT_BUTTON_RIGHT;
+        default: return 0;
+    }
+}
+
+static uint32_t key_bit(SDL_Keycode key)
+{
+    switch (key)
+    {
+        case SDLK_ESCAPE: return INPUT_KEY_ESCAPE;
+        default: return 0;
+    }
+}
+
+// The event is only read through the pointer, nothing is copied.
+static void handle_event(input_t* input, const SDL_Event* event)
+{
+    input->num_events++;
+
+    switch (event->type)
+    {
+        case SDL_QUIT:
+            input->quit = true;
+            break;
+        case SDL_MOUSEMOTION:
+            input->cursor = (vec2_t){event->motion.x, event->motion.y};
+            input->num_motions++;
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+            input->cursor = (vec2_t){event->button.x, event->button.y};
+            input->press_cursor = input->cursor;
+            input->buttons_down |= button_bit(event->button.button);
+            input->buttons_pressed |= button_bit(event->button.button);
+            break;
+        case SDL_MOUSEBUTTONUP:
+            input->cursor = (vec2_t){event->button.x, event->button.y};
+            input->buttons_down &= ~button_bit(event->button.button);
+            input->buttons_released |= button_bit(event->button.button);
+            break;
+        case SDL_KEYDOWN:
+            // Key repeats aren't presses.
+            if (!event->key.repeat)
+            {
+                input->keys_down |= key_bit(event->key.keysym.sym);
+                input->keys_pressed |= key_bit(event->key.keysym.sym);
+            }
+            break;
+        case SDL_KEYUP:
+            input->keys_down &= ~key_bit(event->key.keysym.sym);
+            break;
+        default:
+            break;
+    }
+}
+
+void input_poll(input_t* input, uint32_t timeout_ms, struct camera_o* camera)
+{
+    assert(input);
+
+    input->buttons_pressed = 0;
+    input->buttons_released = 0;
+    input->keys_pressed = 0;
+    input->num_events = 0;
+    input->num_motions = 0;
+
+    SDL_Event event;
+    bool has_event = timeout_ms > 0 ? SDL_WaitEventTimeout(&event, timeout_ms) : SDL_PollEvent(&event);
+    while (has_event)
+    {
+        handle_event(input, &event);
+        has_event = SDL_PollEvent(&event);
+    }
+
+    if (camera)
+    {
+        input->cursor_world = camera_screen_to_world(camera, input->cursor);
+        input->press_cursor_world = camera_screen_to_world(camera, input->press_cursor);
+    }
+}
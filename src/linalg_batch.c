@@ -0,0 +1,211 @@
+#include "linalg_batch.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+//
+// Scalar implementation, also used for the tails of the SIMD ones.
+//
+
+static void add_scalar(float* out, const float* a, const float* b, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i) out[i] = a[i] + b[i];
+}
+
+static void scale_scalar(float* out, const float* a, float s, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i) out[i] = a[i] * s;
+}
+
+static void fma_scalar(float* out, const float* a, float s, const float* b, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i) out[i] = a[i] * s + b[i];
+}
+
+static void length_sq_scalar(float* out, const float* x, const float* y, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i) out[i] = x[i]*x[i] + y[i]*y[i];
+}
+
+static void dist_sq_scalar(float* out, const float* x, const float* y, vec2_t p, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        const float dx = x[i] - p.x;
+        const float dy = y[i] - p.y;
+        out[i] = dx*dx + dy*dy;
+    }
+}
+
+static void circle_overlap_scalar(
+    uint8_t* mask, const float* x, const float* y, float radius, circle_t c, uint32_t n)
+{
+    const float r_sq = (radius + c.radius) * (radius + c.radius);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        const float dx = x[i] - c.center.x;
+        const float dy = y[i] - c.center.y;
+        mask[i] = dx*dx + dy*dy <= r_sq;
+    }
+}
+
+static void normalize_scalar(float* out_x, float* out_y, const float* x, const float* y, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        const float inv_length = 1.0f / sqrtf(x[i]*x[i] + y[i]*y[i]);
+        out_x[i] = x[i] * inv_length;
+        out_y[i] = y[i] * inv_length;
+    }
+}
+
+static void bbox_contain_scalar(uint8_t* mask, const float* x, const float* y, bbox2_t b, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        mask[i] = x[i] >= b.min.x && x[i] <= b.max.x && y[i] >= b.min.y && y[i] <= b.max.y;
+    }
+}
+
+static void transform_scalar(
+    float* out_x, float* out_y, const float* x, const float* y, mat3_t m, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        const float tx = m.x.x*x[i] + m.y.x*y[i] + m.z.x;
+        const float ty = m.x.y*x[i] + m.y.y*y[i] + m.z.y;
+        out_x[i] = tx;
+        out_y[i] = ty;
+    }
+}
+
+static void sincos_scalar(float* out_s, float* out_c, const float* x, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        fast_sincosf(x[i], &out_s[i], &out_c[i]);
+    }
+}
+
+// With p and v the relative position and move, the squared distance minus the squared radius along
+// the moves is f(s) = a*s^2 + 2*b*s + c for s in [0, 1], with a = v.v, b = p.v and c = p.p - r^2.
+// The circles touch when f goes down to 0: at the start, at the end, or at the closest approach
+// s = -b/a when it happens during the move (b^2 >= a*c). No division nor square root so that every
+// ISA gives the same results.
+static void sweep_circle_overlap_scalar(
+    uint8_t* mask, const float* x, const float* y, const float* dx, const float* dy,
+    float radius, circle_t c, vec2_t c_delta, uint32_t n)
+{
+    const float r_sq = (radius + c.radius) * (radius + c.radius);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        const float px = x[i] - c.center.x;
+        const float py = y[i] - c.center.y;
+        const float vx = dx[i] - c_delta.x;
+        const float vy = dy[i] - c_delta.y;
+        const float a = vx*vx + vy*vy;
+        const float b = px*vx + py*vy;
+        const float d = px*px + py*py - r_sq;
+
+        const bool start = d <= 0;
+        const bool end = a + (b + b) + d <= 0;
+        const bool closest = b < 0 && -b <= a && b*b - a*d >= 0;
+        mask[i] = start || end || closest;
+    }
+}
+
+static const linalg_batch_kernels_t scalar_kernels = {
+    .name = "scalar",
+    .add = add_scalar,
+    .scale = scale_scalar,
+    .fma = fma_scalar,
+    .length_sq = length_sq_scalar,
+    .dist_sq = dist_sq_scalar,
+    .circle_overlap = circle_overlap_scalar,
+    .normalize = normalize_scalar,
+    .bbox_contain = bbox_contain_scalar,
+    .transform = transform_scalar,
+    .sincos = sincos_scalar,
+    .sweep_circle_overlap = sweep_circle_overlap_scalar,
+};
+
+const linalg_batch_kernels_t* linalg_batch_scalar_kernels(void)
+{
+    return &scalar_kernels;
+}
+
+//
+// Dispatch.
+//
+
+static const linalg_batch_kernels_t* kernels = &scalar_kernels;
+
+void linalg_batch_set_kernels(const linalg_batch_kernels_t* selected)
+{
+    assert(selected);
+    kernels = selected;
+}
+
+const char* linalg_batch_name(void)
+{
+    return kernels->name;
+}
+
+void batch_add(float* out, const float* a, const float* b, uint32_t n)
+{
+    kernels->add(out, a, b, n);
+}
+
+void batch_scale(float* out, const float* a, float s, uint32_t n)
+{
+    kernels->scale(out, a, s, n);
+}
+
+void batch_fma(float* out, const float* a, float s, const float* b, uint32_t n)
+{
+    kernels->fma(out, a, s, b, n);
+}
+
+void batch_length_sq(float* out, const float* x, const float* y, uint32_t n)
+{
+    kernels->length_sq(out, x, y, n);
+}
+
+void batch_dist_sq(float* out, const float* x, const float* y, vec2_t p, uint32_t n)
+{
+    kernels->dist_sq(out, x, y, p, n);
+}
+
+void batch_circle_overlap(
+    uint8_t* mask, const float* x, const float* y, float radius, circle_t c, uint32_t n)
+{
+    kernels->circle_overlap(mask, x, y, radius, c, n);
+}
+
+void batch_normalize(float* out_x, float* out_y, const float* x, const float* y, uint32_t n)
+{
+    kernels->normalize(out_x, out_y, x, y, n);
+}
+
+void batch_bbox_contain(uint8_t* mask, const float* x, const float* y, bbox2_t b, uint32_t n)
+{
+    kernels->bbox_contain(mask, x, y, b, n);
+}
+
+void batch_transform(
+    float* out_x, float* out_y, const float* x, const float* y, mat3_t m, uint32_t n)
+{
+    kernels->transform(out_x, out_y, x, y, m, n);
+}
+
+void batch_sincos(float* out_s, float* out_c, const float* x, uint32_t n)
+{
+    kernels->sincos(out_s, out_c, x, n);
+}
+
+void batch_sweep_circle_overlap(
+    uint8_t* mask, const float* x, const float* y, const float* dx, const float* dy,
+    float radius, circle_t c, vec2_t c_delta, uint32_t n)
+{
+    kernels->sweep_circle_overlap(mask, x, y, dx, dy, radius, c, c_delta, n);
+}
@@ -0,0 +1,258 @@
+#include "linalg_batch.h"
+
+#include <stddef.h>
+
+// This file is compiled with `-mavx2` (see the Makefile). Nothing from it must be called unless
+// the CPU supports AVX2.
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+// Tails are processed by the scalar implementation.
+#define TAIL(N) ((N) & ~7u)
+
+// Store the 8 lanes of a comparison result as 8 bytes of 0 or 1.
+static inline void store_mask8(uint8_t* mask, __m256 cmp)
+{
+    const __m256i bits = _mm256_and_si256(_mm256_castps_si256(cmp), _mm256_set1_epi32(1));
+    __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(bits), _mm256_extracti128_si256(bits, 1));
+    packed = _mm_packus_epi16(packed, packed);
+    _mm_storel_epi64((__m128i*)mask, packed);
+}
+
+static void add_avx2(float* out, const float* a, const float* b, uint32_t n)
+{
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 8)
+    {
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    linalg_batch_scalar_kernels()->add(out + i, a + i, b + i, n - i);
+}
+
+static void scale_avx2(float* out, const float* a, float s, uint32_t n)
+{
+    const __m256 vs = _mm256_set1_ps(s);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 8)
+    {
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), vs));
+    }
+    linalg_batch_scalar_kernels()->scale(out + i, a + i, s, n - i);
+}
+
+// @Note: FMA is a separate CPUID flag from AVX2 that SDL doesn't report, so multiply and add are
+// kept separate. This also keeps the results bit exact with the other implementations.
+static void fma_avx2(float* out, const float* a, float s, const float* b, uint32_t n)
+{
+    const __m256 vs = _mm256_set1_ps(s);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 8)
+    {
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(a + i), vs), _mm256_loadu_ps(b + i)));
+    }
+    linalg_batch_scalar_kernels()->fma(out + i, a + i, s, b + i, n - i);
+}
+
+static void length_sq_avx2(float* out, const float* x, const float* y, uint32_t n)
+{
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 8)
+    {
+        const __m256 vx = _mm256_loadu_ps(x + i);
+        const __m256 vy = _mm256_loadu_ps(y + i);
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)));
+    }
+    linalg_batch_scalar_kernels()->length_sq(out + i, x + i, y + i, n - i);
+}
+
+static void dist_sq_avx2(float* out, const float* x, const float* y, vec2_t p, uint32_t n)
+{
+    const __m256 px = _mm256_set1_ps(p.x);
+    const __m256 py = _mm256_set1_ps(p.y);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 8)
+    {
+        const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + i), px);
+        const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + i), py);
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+    }
+    linalg_batch_scalar_kernels()->dist_sq(out + i, x + i, y + i, p, n - i);
+}
+
+static void circle_overlap_avx2(
+    uint8_t* mask, const float* x, const float* y, float radius, circle_t c, uint32_t n)
+{
+    const __m256 cx = _mm256_set1_ps(c.center.x);
+    const __m256 cy = _mm256_set1_ps(c.center.y);
+    const __m256 r_sq = _mm256_set1_ps((radius + c.radius) * (radius + c.radius));
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 8)
+    {
+        const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + i), cx);
+        const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + i), cy);
+        const __m256 d_sq = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        store_mask8(mask + i, _mm256_cmp_ps(d_sq, r_sq, _CMP_LE_OQ));
+    }
+    linalg_batch_scalar_kernels()->circle_overlap(mask + i, x + i, y + i, radius, c, n - i);
+}
+
+static void normalize_avx2(float* out_x, float* out_y, const float* x, const float* y, uint32_t n)
+{
+    const __m256 one = _mm256_set1_ps(1.0f);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 8)
+    {
+        const __m256 vx = _mm256_loadu_ps(x + i);
+        const __m256 vy = _mm256_loadu_ps(y + i);
+        // Full precision sqrt and division so that results match the scalar implementation.
+        const __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)));
+        const __m256 inv_length = _mm256_div_ps(one, length);
+        _mm256_storeu_ps(out_x + i, _mm256_mul_ps(vx, inv_length));
+        _mm256_storeu_ps(out_y + i, _mm256_mul_ps(vy, inv_length));
+    }
+    linalg_batch_scalar_kernels()->normalize(out_x + i, out_y + i, x + i, y + i, n - i);
+}
+
+static void bbox_contain_avx2(uint8_t* mask, const float* x, const float* y, bbox2_t b, uint32_t n)
+{
+    const __m256 min_x = _mm256_set1_ps(b.min.x);
+    const __m256 min_y = _mm256_set1_ps(b.min.y);
+    const __m256 max_x = _mm256_set1_ps(b.max.x);
+    const __m256 max_y = _mm256_set1_ps(b.max.y);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 8)
+    {
+        const __m256 vx = _mm256_loadu_ps(x + i);
+        const __m256 vy = _mm256_loadu_ps(y + i);
+        const __m256 in_x = _mm256_and_ps(_mm256_cmp_ps(vx, min_x, _CMP_GE_OQ), _mm256_cmp_ps(vx, max_x, _CMP_LE_OQ));
+        const __m256 in_y = _mm256_and_ps(_mm256_cmp_ps(vy, min_y, _CMP_GE_OQ), _mm256_cmp_ps(vy, max_y, _CMP_LE_OQ));
+        store_mask8(mask + i, _mm256_and_ps(in_x, in_y));
+    }
+    linalg_batch_scalar_kernels()->bbox_contain(mask + i, x + i, y + i, b, n - i);
+}
+
+static void transform_avx2(
+    float* out_x, float* out_y, const float* x, const float* y, mat3_t m, uint32_t n)
+{
+    const __m256 xx = _mm256_set1_ps(m.x.x), xy = _mm256_set1_ps(m.x.y);
+    const __m256 yx = _mm256_set1_ps(m.y.x), yy = _mm256_set1_ps(m.y.y);
+    const __m256 zx = _mm256_set1_ps(m.z.x), zy = _mm256_set1_ps(m.z.y);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 8)
+    {
+        const __m256 vx = _mm256_loadu_ps(x + i);
+        const __m256 vy = _mm256_loadu_ps(y + i);
+        const __m256 tx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(xx, vx), _mm256_mul_ps(yx, vy)), zx);
+        const __m256 ty = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(xy, vx), _mm256_mul_ps(yy, vy)), zy);
+        _mm256_storeu_ps(out_x + i, tx);
+        _mm256_storeu_ps(out_y + i, ty);
+    }
+    linalg_batch_scalar_kernels()->transform(out_x + i, out_y + i, x + i, y + i, m, n - i);
+}
+
+// Same operations as `fast_sincosf`, branches are replaced with selects.
+static void sincos_avx2(float* out_s, float* out_c, const float* x, uint32_t n)
+{
+    const __m256 round = _mm256_set1_ps(_SINCOS_ROUND);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i two = _mm256_set1_epi32(2);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 8)
+    {
+        const __m256 vx = _mm256_loadu_ps(x + i);
+        const __m256 k = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(vx, _mm256_set1_ps(_SINCOS_2_PI)), round), round);
+        const __m256i quadrant = _mm256_cvtps_epi32(k);
+
+        __m256 r = _mm256_sub_ps(vx, _mm256_mul_ps(k, _mm256_set1_ps(_SINCOS_PI_2_A)));
+        r = _mm256_sub_ps(r, _mm256_mul_ps(k, _mm256_set1_ps(_SINCOS_PI_2_B)));
+        r = _mm256_sub_ps(r, _mm256_mul_ps(k, _mm256_set1_ps(_SINCOS_PI_2_C)));
+        const __m256 z = _mm256_mul_ps(r, r);
+
+        __m256 sin_p = _mm256_add_ps(_mm256_set1_ps(_SINCOS_S2), _mm256_mul_ps(z, _mm256_set1_ps(_SINCOS_S3)));
+        sin_p = _mm256_add_ps(_mm256_set1_ps(_SINCOS_S1), _mm256_mul_ps(z, sin_p));
+        const __m256 sin_r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, z), sin_p));
+
+        __m256 cos_p = _mm256_add_ps(_mm256_set1_ps(_SINCOS_C2), _mm256_mul_ps(z, _mm256_set1_ps(_SINCOS_C3)));
+        cos_p = _mm256_add_ps(_mm256_set1_ps(_SINCOS_C1), _mm256_mul_ps(z, cos_p));
+        const __m256 cos_r = _mm256_add_ps(
+            _mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(_mm256_set1_ps(0.5f), z)),
+            _mm256_mul_ps(_mm256_mul_ps(z, z), cos_p));
+
+        const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, one), one));
+        const __m256 sin_x = _mm256_blendv_ps(sin_r, cos_r, swap);
+        const __m256 cos_x = _mm256_blendv_ps(cos_r, sin_r, swap);
+        const __m256 sin_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, two), 30));
+        const __m256 cos_sign = _mm256_castsi256_ps(
+            _mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, one), two), 30));
+
+        _mm256_storeu_ps(out_s + i, _mm256_xor_ps(sin_x, sin_sign));
+        _mm256_storeu_ps(out_c + i, _mm256_xor_ps(cos_x, cos_sign));
+    }
+    linalg_batch_scalar_kernels()->sincos(out_s + i, out_c + i, x + i, n - i);
+}
+
+static void sweep_circle_overlap_avx2(
+    uint8_t* mask, const float* x, const float* y, const float* dx, const float* dy,
+    float radius, circle_t c, vec2_t c_delta, uint32_t n)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 cx = _mm256_set1_ps(c.center.x);
+    const __m256 cy = _mm256_set1_ps(c.center.y);
+    const __m256 cdx = _mm256_set1_ps(c_delta.x);
+    const __m256 cdy = _mm256_set1_ps(c_delta.y);
+    const __m256 r_sq = _mm256_set1_ps((radius + c.radius) * (radius + c.radius));
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 8)
+    {
+        const __m256 px = _mm256_sub_ps(_mm256_loadu_ps(x + i), cx);
+        const __m256 py = _mm256_sub_ps(_mm256_loadu_ps(y + i), cy);
+        const __m256 vx = _mm256_sub_ps(_mm256_loadu_ps(dx + i), cdx);
+        const __m256 vy = _mm256_sub_ps(_mm256_loadu_ps(dy + i), cdy);
+        const __m256 a = _mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy));
+        const __m256 b = _mm256_add_ps(_mm256_mul_ps(px, vx), _mm256_mul_ps(py, vy));
+        const __m256 d = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(px, px), _mm256_mul_ps(py, py)), r_sq);
+
+        // Same tests as the scalar implementation.
+        const __m256 start = _mm256_cmp_ps(d, zero, _CMP_LE_OQ);
+        const __m256 end = _mm256_cmp_ps(
+            _mm256_add_ps(_mm256_add_ps(a, _mm256_add_ps(b, b)), d), zero, _CMP_LE_OQ);
+        const __m256 closest = _mm256_and_ps(
+            _mm256_and_ps(
+                _mm256_cmp_ps(b, zero, _CMP_LT_OQ),
+                _mm256_cmp_ps(_mm256_sub_ps(zero, b), a, _CMP_LE_OQ)),
+            _mm256_cmp_ps(_mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(a, d)), zero, _CMP_GE_OQ));
+        store_mask8(mask + i, _mm256_or_ps(_mm256_or_ps(start, end), closest));
+    }
+    linalg_batch_scalar_kernels()->sweep_circle_overlap(
+        mask + i, x + i, y + i, dx + i, dy + i, radius, c, c_delta, n - i);
+}
+
+static const linalg_batch_kernels_t avx2_kernels = {
+    .name = "avx2",
+    .add = add_avx2,
+    .scale = scale_avx2,
+    .fma = fma_avx2,
+    .length_sq = length_sq_avx2,
+    .dist_sq = dist_sq_avx2,
+    .circle_overlap = circle_overlap_avx2,
+    .normalize = normalize_avx2,
+    .bbox_contain = bbox_contain_avx2,
+    .transform = transform_avx2,
+    .sincos = sincos_avx2,
+    .sweep_circle_overlap = sweep_circle_overlap_avx2,
+};
+
+const linalg_batch_kernels_t* linalg_batch_avx2_kernels(void)
+{
+    return &avx2_kernels;
+}
+
+#else
+
+const linalg_batch_kernels_t* linalg_batch_avx2_kernels(void)
+{
+    return NULL;
+}
+
+#endif // __AVX2__
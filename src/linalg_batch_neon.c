@@ -0,0 +1,198 @@
+#include "linalg_batch.h"
+
+#include <stddef.h>
+
+#if defined(__ARM_NEON)
+
+#include <arm_neon.h>
+#include <string.h>
+
+// Tails are processed by the scalar implementation.
+#define TAIL(N) ((N) & ~3u)
+
+// Multiplications and additions are kept separate (no `vmlaq_f32`/`vfmaq_f32`) so that results
+// are the same as the scalar and x86 implementations.
+
+// Store the 4 lanes of a comparison result as 4 bytes of 0 or 1.
+static inline void store_mask4(uint8_t* mask, uint32x4_t cmp)
+{
+    const uint16x4_t half = vmovn_u32(vandq_u32(cmp, vdupq_n_u32(1)));
+    const uint8x8_t bytes = vmovn_u16(vcombine_u16(half, half));
+    const uint32_t packed = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+    memcpy(mask, &packed, 4);
+}
+
+static void add_neon(float* out, const float* a, const float* b, uint32_t n)
+{
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        vst1q_f32(out + i, vaddq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+    }
+    linalg_batch_scalar_kernels()->add(out + i, a + i, b + i, n - i);
+}
+
+static void scale_neon(float* out, const float* a, float s, uint32_t n)
+{
+    const float32x4_t vs = vdupq_n_f32(s);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        vst1q_f32(out + i, vmulq_f32(vld1q_f32(a + i), vs));
+    }
+    linalg_batch_scalar_kernels()->scale(out + i, a + i, s, n - i);
+}
+
+static void fma_neon(float* out, const float* a, float s, const float* b, uint32_t n)
+{
+    const float32x4_t vs = vdupq_n_f32(s);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        vst1q_f32(out + i, vaddq_f32(vmulq_f32(vld1q_f32(a + i), vs), vld1q_f32(b + i)));
+    }
+    linalg_batch_scalar_kernels()->fma(out + i, a + i, s, b + i, n - i);
+}
+
+static void length_sq_neon(float* out, const float* x, const float* y, uint32_t n)
+{
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        const float32x4_t vx = vld1q_f32(x + i);
+        const float32x4_t vy = vld1q_f32(y + i);
+        vst1q_f32(out + i, vaddq_f32(vmulq_f32(vx, vx), vmulq_f32(vy, vy)));
+    }
+    linalg_batch_scalar_kernels()->length_sq(out + i, x + i, y + i, n - i);
+}
+
+static void dist_sq_neon(float* out, const float* x, const float* y, vec2_t p, uint32_t n)
+{
+    const float32x4_t px = vdupq_n_f32(p.x);
+    const float32x4_t py = vdupq_n_f32(p.y);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        const float32x4_t dx = vsubq_f32(vld1q_f32(x + i), px);
+        const float32x4_t dy = vsubq_f32(vld1q_f32(y + i), py);
+        vst1q_f32(out + i, vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy)));
+    }
+    linalg_batch_scalar_kernels()->dist_sq(out + i, x + i, y + i, p, n - i);
+}
+
+static void circle_overlap_neon(
+    uint8_t* mask, const float* x, const float* y, float radius, circle_t c, uint32_t n)
+{
+    const float32x4_t cx = vdupq_n_f32(c.center.x);
+    const float32x4_t cy = vdupq_n_f32(c.center.y);
+    const float32x4_t r_sq = vdupq_n_f32((radius + c.radius) * (radius + c.radius));
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        const float32x4_t dx = vsubq_f32(vld1q_f32(x + i), cx);
+        const float32x4_t dy = vsubq_f32(vld1q_f32(y + i), cy);
+        const float32x4_t d_sq = vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy));
+        store_mask4(mask + i, vcleq_f32(d_sq, r_sq));
+    }
+    linalg_batch_scalar_kernels()->circle_overlap(mask + i, x + i, y + i, radius, c, n - i);
+}
+
+static void bbox_contain_neon(uint8_t* mask, const float* x, const float* y, bbox2_t b, uint32_t n)
+{
+    const float32x4_t min_x = vdupq_n_f32(b.min.x);
+    const float32x4_t min_y = vdupq_n_f32(b.min.y);
+    const float32x4_t max_x = vdupq_n_f32(b.max.x);
+    const float32x4_t max_y = vdupq_n_f32(b.max.y);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        const float32x4_t vx = vld1q_f32(x + i);
+        const float32x4_t vy = vld1q_f32(y + i);
+        const uint32x4_t in_x = vandq_u32(vcgeq_f32(vx, min_x), vcleq_f32(vx, max_x));
+        const uint32x4_t in_y = vandq_u32(vcgeq_f32(vy, min_y), vcleq_f32(vy, max_y));
+        store_mask4(mask + i, vandq_u32(in_x, in_y));
+    }
+    linalg_batch_scalar_kernels()->bbox_contain(mask + i, x + i, y + i, b, n - i);
+}
+
+static void transform_neon(
+    float* out_x, float* out_y, const float* x, const float* y, mat3_t m, uint32_t n)
+{
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        const float32x4_t vx = vld1q_f32(x + i);
+        const float32x4_t vy = vld1q_f32(y + i);
+        const float32x4_t tx = vaddq_f32(
+            vaddq_f32(vmulq_n_f32(vx, m.x.x), vmulq_n_f32(vy, m.y.x)), vdupq_n_f32(m.z.x));
+        const float32x4_t ty = vaddq_f32(
+            vaddq_f32(vmulq_n_f32(vx, m.x.y), vmulq_n_f32(vy, m.y.y)), vdupq_n_f32(m.z.y));
+        vst1q_f32(out_x + i, tx);
+        vst1q_f32(out_y + i, ty);
+    }
+    linalg_batch_scalar_kernels()->transform(out_x + i, out_y + i, x + i, y + i, m, n - i);
+}
+
+static void sweep_circle_overlap_neon(
+    uint8_t* mask, const float* x, const float* y, const float* dx, const float* dy,
+    float radius, circle_t c, vec2_t c_delta, uint32_t n)
+{
+    const float32x4_t zero = vdupq_n_f32(0);
+    const float32x4_t cx = vdupq_n_f32(c.center.x);
+    const float32x4_t cy = vdupq_n_f32(c.center.y);
+    const float32x4_t cdx = vdupq_n_f32(c_delta.x);
+    const float32x4_t cdy = vdupq_n_f32(c_delta.y);
+    const float32x4_t r_sq = vdupq_n_f32((radius + c.radius) * (radius + c.radius));
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        const float32x4_t px = vsubq_f32(vld1q_f32(x + i), cx);
+        const float32x4_t py = vsubq_f32(vld1q_f32(y + i), cy);
+        const float32x4_t vx = vsubq_f32(vld1q_f32(dx + i), cdx);
+        const float32x4_t vy = vsubq_f32(vld1q_f32(dy + i), cdy);
+        const float32x4_t a = vaddq_f32(vmulq_f32(vx, vx), vmulq_f32(vy, vy));
+        const float32x4_t b = vaddq_f32(vmulq_f32(px, vx), vmulq_f32(py, vy));
+        const float32x4_t d = vsubq_f32(vaddq_f32(vmulq_f32(px, px), vmulq_f32(py, py)), r_sq);
+
+        // Same tests as the scalar implementation.
+        const uint32x4_t start = vcleq_f32(d, zero);
+        const uint32x4_t end = vcleq_f32(vaddq_f32(vaddq_f32(a, vaddq_f32(b, b)), d), zero);
+        const uint32x4_t closest = vandq_u32(
+            vandq_u32(vcltq_f32(b, zero), vcleq_f32(vnegq_f32(b), a)),
+            vcgeq_f32(vsubq_f32(vmulq_f32(b, b), vmulq_f32(a, d)), zero));
+        store_mask4(mask + i, vorrq_u32(vorrq_u32(start, end), closest));
+    }
+    linalg_batch_scalar_kernels()->sweep_circle_overlap(
+        mask + i, x + i, y + i, dx + i, dy + i, radius, c, c_delta, n - i);
+}
+
+const linalg_batch_kernels_t* linalg_batch_neon_kernels(void)
+{
+    // @Todo: normalize and sincos. 32-bit ARM has no vector square root nor division so they stay
+    // scalar for now.
+    static linalg_batch_kernels_t neon_kernels = {0};
+    if (!neon_kernels.name)
+    {
+        neon_kernels = *linalg_batch_scalar_kernels();
+        neon_kernels.name = "neon";
+        neon_kernels.add = add_neon;
+        neon_kernels.scale = scale_neon;
+        neon_kernels.fma = fma_neon;
+        neon_kernels.length_sq = length_sq_neon;
+        neon_kernels.dist_sq = dist_sq_neon;
+        neon_kernels.circle_overlap = circle_overlap_neon;
+        neon_kernels.bbox_contain = bbox_contain_neon;
+        neon_kernels.transform = transform_neon;
+        neon_kernels.sweep_circle_overlap = sweep_circle_overlap_neon;
+    }
+    return &neon_kernels;
+}
+
+#else
+
+const linalg_batch_kernels_t* linalg_batch_neon_kernels(void)
+{
+    return NULL;
+}
+
+#endif // __ARM_NEON
@@ -0,0 +1,253 @@
+#include "linalg_batch.h"
+
+#include <stddef.h>
+
+#if defined(__SSE2__)
+
+#include <emmintrin.h>
+#include <string.h>
+
+// Tails are processed by the scalar implementation.
+#define TAIL(N) ((N) & ~3u)
+
+// Store the 4 lanes of a comparison result as 4 bytes of 0 or 1.
+static inline void store_mask4(uint8_t* mask, __m128 cmp)
+{
+    __m128i bits = _mm_and_si128(_mm_castps_si128(cmp), _mm_set1_epi32(1));
+    bits = _mm_packs_epi32(bits, bits);
+    bits = _mm_packus_epi16(bits, bits);
+    const int32_t packed = _mm_cvtsi128_si32(bits);
+    memcpy(mask, &packed, 4);
+}
+
+static void add_sse2(float* out, const float* a, const float* b, uint32_t n)
+{
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    linalg_batch_scalar_kernels()->add(out + i, a + i, b + i, n - i);
+}
+
+static void scale_sse2(float* out, const float* a, float s, uint32_t n)
+{
+    const __m128 vs = _mm_set1_ps(s);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), vs));
+    }
+    linalg_batch_scalar_kernels()->scale(out + i, a + i, s, n - i);
+}
+
+static void fma_sse2(float* out, const float* a, float s, const float* b, uint32_t n)
+{
+    const __m128 vs = _mm_set1_ps(s);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a + i), vs), _mm_loadu_ps(b + i)));
+    }
+    linalg_batch_scalar_kernels()->fma(out + i, a + i, s, b + i, n - i);
+}
+
+static void length_sq_sse2(float* out, const float* x, const float* y, uint32_t n)
+{
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        const __m128 vx = _mm_loadu_ps(x + i);
+        const __m128 vy = _mm_loadu_ps(y + i);
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)));
+    }
+    linalg_batch_scalar_kernels()->length_sq(out + i, x + i, y + i, n - i);
+}
+
+static void dist_sq_sse2(float* out, const float* x, const float* y, vec2_t p, uint32_t n)
+{
+    const __m128 px = _mm_set1_ps(p.x);
+    const __m128 py = _mm_set1_ps(p.y);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        const __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), px);
+        const __m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), py);
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+    }
+    linalg_batch_scalar_kernels()->dist_sq(out + i, x + i, y + i, p, n - i);
+}
+
+static void circle_overlap_sse2(
+    uint8_t* mask, const float* x, const float* y, float radius, circle_t c, uint32_t n)
+{
+    const __m128 cx = _mm_set1_ps(c.center.x);
+    const __m128 cy = _mm_set1_ps(c.center.y);
+    const __m128 r_sq = _mm_set1_ps((radius + c.radius) * (radius + c.radius));
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        const __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), cx);
+        const __m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), cy);
+        const __m128 d_sq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        store_mask4(mask + i, _mm_cmple_ps(d_sq, r_sq));
+    }
+    linalg_batch_scalar_kernels()->circle_overlap(mask + i, x + i, y + i, radius, c, n - i);
+}
+
+static void normalize_sse2(float* out_x, float* out_y, const float* x, const float* y, uint32_t n)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        const __m128 vx = _mm_loadu_ps(x + i);
+        const __m128 vy = _mm_loadu_ps(y + i);
+        // Full precision sqrt and division so that results match the scalar implementation.
+        const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)));
+        const __m128 inv_length = _mm_div_ps(one, length);
+        _mm_storeu_ps(out_x + i, _mm_mul_ps(vx, inv_length));
+        _mm_storeu_ps(out_y + i, _mm_mul_ps(vy, inv_length));
+    }
+    linalg_batch_scalar_kernels()->normalize(out_x + i, out_y + i, x + i, y + i, n - i);
+}
+
+static void bbox_contain_sse2(uint8_t* mask, const float* x, const float* y, bbox2_t b, uint32_t n)
+{
+    const __m128 min_x = _mm_set1_ps(b.min.x);
+    const __m128 min_y = _mm_set1_ps(b.min.y);
+    const __m128 max_x = _mm_set1_ps(b.max.x);
+    const __m128 max_y = _mm_set1_ps(b.max.y);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        const __m128 vx = _mm_loadu_ps(x + i);
+        const __m128 vy = _mm_loadu_ps(y + i);
+        const __m128 in_x = _mm_and_ps(_mm_cmpge_ps(vx, min_x), _mm_cmple_ps(vx, max_x));
+        const __m128 in_y = _mm_and_ps(_mm_cmpge_ps(vy, min_y), _mm_cmple_ps(vy, max_y));
+        store_mask4(mask + i, _mm_and_ps(in_x, in_y));
+    }
+    linalg_batch_scalar_kernels()->bbox_contain(mask + i, x + i, y + i, b, n - i);
+}
+
+static void transform_sse2(
+    float* out_x, float* out_y, const float* x, const float* y, mat3_t m, uint32_t n)
+{
+    const __m128 xx = _mm_set1_ps(m.x.x), xy = _mm_set1_ps(m.x.y);
+    const __m128 yx = _mm_set1_ps(m.y.x), yy = _mm_set1_ps(m.y.y);
+    const __m128 zx = _mm_set1_ps(m.z.x), zy = _mm_set1_ps(m.z.y);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        const __m128 vx = _mm_loadu_ps(x + i);
+        const __m128 vy = _mm_loadu_ps(y + i);
+        const __m128 tx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xx, vx), _mm_mul_ps(yx, vy)), zx);
+        const __m128 ty = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xy, vx), _mm_mul_ps(yy, vy)), zy);
+        _mm_storeu_ps(out_x + i, tx);
+        _mm_storeu_ps(out_y + i, ty);
+    }
+    linalg_batch_scalar_kernels()->transform(out_x + i, out_y + i, x + i, y + i, m, n - i);
+}
+
+// Same operations as `fast_sincosf`, branches are replaced with selects.
+static void sincos_sse2(float* out_s, float* out_c, const float* x, uint32_t n)
+{
+    const __m128 round = _mm_set1_ps(_SINCOS_ROUND);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i two = _mm_set1_epi32(2);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        const __m128 vx = _mm_loadu_ps(x + i);
+        const __m128 k = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(vx, _mm_set1_ps(_SINCOS_2_PI)), round), round);
+        const __m128i quadrant = _mm_cvtps_epi32(k);
+
+        __m128 r = _mm_sub_ps(vx, _mm_mul_ps(k, _mm_set1_ps(_SINCOS_PI_2_A)));
+        r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(_SINCOS_PI_2_B)));
+        r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(_SINCOS_PI_2_C)));
+        const __m128 z = _mm_mul_ps(r, r);
+
+        __m128 sin_p = _mm_add_ps(_mm_set1_ps(_SINCOS_S2), _mm_mul_ps(z, _mm_set1_ps(_SINCOS_S3)));
+        sin_p = _mm_add_ps(_mm_set1_ps(_SINCOS_S1), _mm_mul_ps(z, sin_p));
+        const __m128 sin_r = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, z), sin_p));
+
+        __m128 cos_p = _mm_add_ps(_mm_set1_ps(_SINCOS_C2), _mm_mul_ps(z, _mm_set1_ps(_SINCOS_C3)));
+        cos_p = _mm_add_ps(_mm_set1_ps(_SINCOS_C1), _mm_mul_ps(z, cos_p));
+        const __m128 cos_r = _mm_add_ps(
+            _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), z)),
+            _mm_mul_ps(_mm_mul_ps(z, z), cos_p));
+
+        const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+        const __m128 sin_x = _mm_or_ps(_mm_and_ps(swap, cos_r), _mm_andnot_ps(swap, sin_r));
+        const __m128 cos_x = _mm_or_ps(_mm_and_ps(swap, sin_r), _mm_andnot_ps(swap, cos_r));
+        const __m128 sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+        const __m128 cos_sign = _mm_castsi128_ps(
+            _mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+
+        _mm_storeu_ps(out_s + i, _mm_xor_ps(sin_x, sin_sign));
+        _mm_storeu_ps(out_c + i, _mm_xor_ps(cos_x, cos_sign));
+    }
+    linalg_batch_scalar_kernels()->sincos(out_s + i, out_c + i, x + i, n - i);
+}
+
+static void sweep_circle_overlap_sse2(
+    uint8_t* mask, const float* x, const float* y, const float* dx, const float* dy,
+    float radius, circle_t c, vec2_t c_delta, uint32_t n)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 cx = _mm_set1_ps(c.center.x);
+    const __m128 cy = _mm_set1_ps(c.center.y);
+    const __m128 cdx = _mm_set1_ps(c_delta.x);
+    const __m128 cdy = _mm_set1_ps(c_delta.y);
+    const __m128 r_sq = _mm_set1_ps((radius + c.radius) * (radius + c.radius));
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        const __m128 px = _mm_sub_ps(_mm_loadu_ps(x + i), cx);
+        const __m128 py = _mm_sub_ps(_mm_loadu_ps(y + i), cy);
+        const __m128 vx = _mm_sub_ps(_mm_loadu_ps(dx + i), cdx);
+        const __m128 vy = _mm_sub_ps(_mm_loadu_ps(dy + i), cdy);
+        const __m128 a = _mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy));
+        const __m128 b = _mm_add_ps(_mm_mul_ps(px, vx), _mm_mul_ps(py, vy));
+        const __m128 d = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py)), r_sq);
+
+        // Same tests as the scalar implementation.
+        const __m128 start = _mm_cmple_ps(d, zero);
+        const __m128 end = _mm_cmple_ps(_mm_add_ps(_mm_add_ps(a, _mm_add_ps(b, b)), d), zero);
+        const __m128 closest = _mm_and_ps(
+            _mm_and_ps(_mm_cmplt_ps(b, zero), _mm_cmple_ps(_mm_sub_ps(zero, b), a)),
+            _mm_cmpge_ps(_mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(a, d)), zero));
+        store_mask4(mask + i, _mm_or_ps(_mm_or_ps(start, end), closest));
+    }
+    linalg_batch_scalar_kernels()->sweep_circle_overlap(
+        mask + i, x + i, y + i, dx + i, dy + i, radius, c, c_delta, n - i);
+}
+
+static const linalg_batch_kernels_t sse2_kernels = {
+    .name = "sse2",
+    .add = add_sse2,
+    .scale = scale_sse2,
+    .fma = fma_sse2,
+    .length_sq = length_sq_sse2,
+    .dist_sq = dist_sq_sse2,
+    .circle_overlap = circle_overlap_sse2,
+    .normalize = normalize_sse2,
+    .bbox_contain = bbox_contain_sse2,
+    .transform = transform_sse2,
+    .sincos = sincos_sse2,
+    .sweep_circle_overlap = sweep_circle_overlap_sse2,
+};
+
+const linalg_batch_kernels_t* linalg_batch_sse2_kernels(void)
+{
+    return &sse2_kernels;
+}
+
+#else
+
+const linalg_batch_kernels_t* linalg_batch_sse2_kernels(void)
+{
+    return NULL;
+}
+
+#endif // __SSE2__
@@ -0,0 +1,74 @@
+#include "linalg_batch.h"
+
+#include <stddef.h>
+
+#if defined(__SSE4_1__)
+
+#include <smmintrin.h>
+
+// Tails are processed by the scalar implementation.
+#define TAIL(N) ((N) & ~3u)
+
+// SSE4.1 only brings blends to the kernels, everything else is shared with the SSE2 version.
+static void sincos_sse41(float* out_s, float* out_c, const float* x, uint32_t n)
+{
+    const __m128 round = _mm_set1_ps(_SINCOS_ROUND);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i two = _mm_set1_epi32(2);
+    uint32_t i = 0;
+    for (; i < TAIL(n); i += 4)
+    {
+        const __m128 vx = _mm_loadu_ps(x + i);
+        const __m128 k = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(vx, _mm_set1_ps(_SINCOS_2_PI)), round), round);
+        const __m128i quadrant = _mm_cvtps_epi32(k);
+
+        __m128 r = _mm_sub_ps(vx, _mm_mul_ps(k, _mm_set1_ps(_SINCOS_PI_2_A)));
+        r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(_SINCOS_PI_2_B)));
+        r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(_SINCOS_PI_2_C)));
+        const __m128 z = _mm_mul_ps(r, r);
+
+        __m128 sin_p = _mm_add_ps(_mm_set1_ps(_SINCOS_S2), _mm_mul_ps(z, _mm_set1_ps(_SINCOS_S3)));
+        sin_p = _mm_add_ps(_mm_set1_ps(_SINCOS_S1), _mm_mul_ps(z, sin_p));
+        const __m128 sin_r = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, z), sin_p));
+
+        __m128 cos_p = _mm_add_ps(_mm_set1_ps(_SINCOS_C2), _mm_mul_ps(z, _mm_set1_ps(_SINCOS_C3)));
+        cos_p = _mm_add_ps(_mm_set1_ps(_SINCOS_C1), _mm_mul_ps(z, cos_p));
+        const __m128 cos_r = _mm_add_ps(
+            _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), z)),
+            _mm_mul_ps(_mm_mul_ps(z, z), cos_p));
+
+        // Odd quadrants swap sin and cos. Only the sign bit of the blend mask matters.
+        const __m128 swap = _mm_castsi128_ps(_mm_slli_epi32(quadrant, 31));
+        const __m128 sin_x = _mm_blendv_ps(sin_r, cos_r, swap);
+        const __m128 cos_x = _mm_blendv_ps(cos_r, sin_r, swap);
+        const __m128 sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+        const __m128 cos_sign = _mm_castsi128_ps(
+            _mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+
+        _mm_storeu_ps(out_s + i, _mm_xor_ps(sin_x, sin_sign));
+        _mm_storeu_ps(out_c + i, _mm_xor_ps(cos_x, cos_sign));
+    }
+    linalg_batch_scalar_kernels()->sincos(out_s + i, out_c + i, x + i, n - i);
+}
+
+const linalg_batch_kernels_t* linalg_batch_sse41_kernels(void)
+{
+    // SSE4.1 implies SSE2 so the SSE2 kernels are always there to start from.
+    static linalg_batch_kernels_t sse41_kernels = {0};
+    if (!sse41_kernels.name)
+    {
+        sse41_kernels = *linalg_batch_sse2_kernels();
+        sse41_kernels.name = "sse4.1";
+        sse41_kernels.sincos = sincos_sse41;
+    }
+    return &sse41_kernels;
+}
+
+#else
+
+const linalg_batch_kernels_t* linalg_batch_sse41_kernels(void)
+{
+    return NULL;
+}
+
+#endif // __SSE4_1__
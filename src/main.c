@@ -1,12 +1,20 @@
+#include "allocator.h"
 #include "array.h"
 #include "atom.h"
 #include "audio.h"
 #include "camera.h"
 #include "camera_scrolling.h"
+#include "cpu_dispatch.h"
 #include "display.h"
+#include "game.h"
+#include "input.h"
 #include "linalg.h"
 #include "player.h"
+#include "presentation.h"
 #include "render.h"
+#include "texture_cache.h"
+#include "timeline.h"
+#include "tuning.h"
 #include "world.h"
 
 #include <SDL2/SDL.h>
@@ -21,20 +29,25 @@
 static const char* GAME_TITLE = "LD49 - Death?Box";
 static const uint32_t DISPLAY_WIDTH = 1280;
 static const uint32_t DISPLAY_HEIGHT = 720;
-
-// @Todo: the way game states are managed is crap. :(
-enum game_state
+// Target frame rate of the optional dynamic resolution of the world, unset to always draw it at the
+// resolution of the window.
+static const char* DYNAMIC_RESOLUTION_VARIABLE = "LD49_DYNAMIC_RESOLUTION";
+// Prints the startup timeline on exit when set.
+static const char* STARTUP_TIMELINE_VARIABLE = "LD49_STARTUP_TIMELINE";
+// Gameplay constants, reloaded during the game when modified.
+static const char* TUNING_FILE = "assets/tuning.txt";
+// Plays from the title screen on and loops for as long as the game runs, under the sound effects.
+static const char* MUSIC_FILE = "assets/music/background.wav";
+static const float MUSIC_GAIN = 0.4f;
+
+// Every screen of the game, created once at startup and pushed on the game state stack.
+typedef struct screens_t
 {
-    GAME_STATE_TITLESCREEN,
-    GAME_STATE_PLAYING,
-    GAME_STATE_CREDITS,
-    GAME_STATE_QUIT,
-};
-
-typedef struct game_t
-{
-    enum game_state state;
-} game_t;
+    game_state_t title;
+    game_state_t credits;
+    game_state_t play;
+    game_state_t pause;
+} screens_t;
 
 static inline SDL_Rect bbox2_to_sdl_rect(bbox2_t bbox)
 {
@@ -47,393 +60,626 @@ static inline SDL_Rect bbox2_to_sdl_rect(bbox2_t bbox)
     };
 }
 
-static void start_credit_loop(struct display_o* display, game_t* game_ctx)
+// Menu buttons are centered horizontally, `vertical_offset` below the center of the screen.
+static bbox2_t menu_button_bbox(float vertical_offset)
 {
-    assert(game_ctx->state == GAME_STATE_CREDITS);
-
-    SDL_Renderer* render = display_get_renderer(display);
-    SDL_Texture* credit_texture = load_bmp_to_texture(render, "assets/images/credits.bmp");
-    SDL_Texture* back_texture = load_bmp_to_texture(render, "assets/images/back.bmp");
+    const vec2_t center = {DISPLAY_WIDTH / 2.0f, DISPLAY_HEIGHT / 2.0f};
+    const vec2_t button_size = {400, 100};
 
-    vec2_t center = {DISPLAY_WIDTH / 2.0f, DISPLAY_HEIGHT / 2.0f};
-    vec2_t button_size = {400, 100};
-
-    float vertical_offset = 250;
-
-    bbox2_t back_bbox = {
+    return (bbox2_t){
         {center.x - button_size.x/2, center.y - button_size.y/2 + vertical_offset},
         {center.x + button_size.x/2, center.y + button_size.y/2 + vertical_offset}};
+}
 
-    SDL_Rect credits_rect = {
-        DISPLAY_WIDTH / 2 - 200,
-        100,
-        640,
-        360,
-    };
+static void draw_texture(SDL_Renderer* render, SDL_Texture* texture, bbox2_t bbox)
+{
+    const SDL_Rect rect = bbox2_to_sdl_rect(bbox);
+    SDL_RenderCopy(render, texture, NULL, &rect);
+}
 
-    bool running = true;
-    while (running)
-    {
-        //
-        // Events
-        //
+//
+// Credits
+//
+
+typedef struct credits_screen_t
+{
+    screens_t* screens;
+    SDL_Texture* credit_texture;
+    SDL_Texture* back_texture;
+    bbox2_t back_bbox;
+    SDL_Rect credits_rect;
+} credits_screen_t;
+
+static void credits_handle_input(void* user, struct game_o* game, const input_t* input)
+{
+    credits_screen_t* credits = user;
 
-        SDL_Event event;
-        while (SDL_PollEvent(&event))
+    if (input->keys_pressed & INPUT_KEY_ESCAPE)
+    {
+        game_quit(game);
+    }
+    else if (input->buttons_pressed)
+    {
+        if (bbox2_contain(credits->back_bbox, input->press_cursor))
         {
-            if (event.type == SDL_QUIT)
-            {
-                game_ctx->state = GAME_STATE_QUIT;
-                running = false;
-                break;
-            }
-            else if (event.type == SDL_KEYDOWN)
-            {
-                switch (event.key.keysym.sym)
-                {
-                    case SDLK_ESCAPE:
-                        game_ctx->state = GAME_STATE_QUIT;
-                        running = false;
-                        break;
-                    default: break;
-                }
-            }
-            else if (event.type == SDL_MOUSEBUTTONDOWN)
-            {
-                vec2_t mouse_pos = {event.button.x, event.button.y};
-
-                if (bbox2_contain(back_bbox, mouse_pos))
-                {
-                    game_ctx->state = GAME_STATE_TITLESCREEN;
-                    return;
-                }
-            }
+            game_switch_state(game, &credits->screens->title);
         }
-
-        //
-        // Render
-        //
-
-        SDL_SetRenderDrawColor(render, 0, 0, 0, 0);
-        SDL_RenderClear(render);
-        SDL_Rect back_rect = bbox2_to_sdl_rect(back_bbox);
-        SDL_RenderCopy(render, back_texture, NULL, &back_rect);
-        SDL_RenderCopy(render, credit_texture, NULL, &credits_rect);
-        SDL_RenderPresent(render);
-
-        SDL_Delay(100); // Static menu so we can delay quit a lot.
     }
+}
+
+static void credits_draw(void* user, struct game_o* game, SDL_Renderer* render)
+{
+    credits_screen_t* credits = user;
+    (void)game;
 
-    SDL_DestroyTexture(credit_texture);
-    SDL_DestroyTexture(back_texture);
+    draw_texture(render, credits->back_texture, credits->back_bbox);
+    SDL_RenderCopy(render, credits->credit_texture, NULL, &credits->credits_rect);
 }
 
-static void start_titlescreen_loop(struct display_o* display, game_t* game_ctx)
+static void credits_screen_init(credits_screen_t* credits, struct game_o* game, screens_t* screens)
 {
-    assert(game_ctx->state == GAME_STATE_TITLESCREEN);
+    struct texture_cache_o* textures = game_textures(game);
+
+    *credits = (credits_screen_t){
+        .screens = screens,
+        .credit_texture = texture_cache_get(textures, "assets/images/credits.bmp"),
+        .back_texture = texture_cache_get(textures, "assets/images/back.bmp"),
+        .back_bbox = menu_button_bbox(250),
+        .credits_rect = {DISPLAY_WIDTH / 2 - 200, 100, 640, 360},
+    };
+}
 
-    SDL_Renderer* render = display_get_renderer(display);
-    SDL_Texture* play_texture = load_bmp_to_texture(render, "assets/images/play_button.bmp");
-    SDL_Texture* quit_texture = load_bmp_to_texture(render, "assets/images/quit_button.bmp");
-    SDL_Texture* to_credits_texture = load_bmp_to_texture(render, "assets/images/to_credits.bmp");
-    SDL_Texture* title_texture = load_bmp_to_texture(render, "assets/images/title.bmp");
+//
+// Title screen
+//
 
-    vec2_t center = {DISPLAY_WIDTH / 2.0f, DISPLAY_HEIGHT / 2.0f};
-    vec2_t button_size = {400, 100};
+typedef struct title_screen_t
+{
+    screens_t* screens;
+    SDL_Texture* play_texture;
+    SDL_Texture* quit_texture;
+    SDL_Texture* to_credits_texture;
+    SDL_Texture* title_texture;
+    bbox2_t play_bbox;
+    bbox2_t quit_bbox;
+    bbox2_t credit_bbox;
+    SDL_Rect title_rect;
+} title_screen_t;
+
+static void title_handle_input(void* user, struct game_o* game, const input_t* input)
+{
+    title_screen_t* title = user;
 
-    float play_vertical_offset = 100;
-    float quit_vertical_offset = 250;
+    if (input->keys_pressed & INPUT_KEY_ESCAPE)
+    {
+        game_quit(game);
+    }
+    else if (input->buttons_pressed)
+    {
+        const vec2_t mouse_pos = input->press_cursor;
 
-    bbox2_t play_bbox = {
-        {center.x - button_size.x/2, center.y - button_size.y/2 + play_vertical_offset},
-        {center.x + button_size.x/2, center.y + button_size.y/2 + play_vertical_offset}};
-    bbox2_t quit_bbox = {
-        {center.x - button_size.x/2, center.y - button_size.y/2 + quit_vertical_offset},
-        {center.x + button_size.x/2, center.y + button_size.y/2 + quit_vertical_offset}};
+        if (bbox2_contain(title->play_bbox, mouse_pos))
+        {
+            game_switch_state(game, &title->screens->play);
+        }
+        else if (bbox2_contain(title->quit_bbox, mouse_pos))
+        {
+            game_quit(game);
+        }
+        else if (bbox2_contain(title->credit_bbox, mouse_pos))
+        {
+            game_switch_state(game, &title->screens->credits);
+        }
+    }
+}
 
-    vec2_t credit_size = {50, 50};
-    vec2_t credit_center = {DISPLAY_WIDTH - credit_size.x / 2 - 20, credit_size.y / 2 + 20};
-    bbox2_t credit_bbox = {
-        {credit_center.x - credit_size.x/2, credit_center.y - credit_size.y/2},
-        {credit_center.x + credit_size.x/2, credit_center.y + credit_size.y/2}};
+static void title_draw(void* user, struct game_o* game, SDL_Renderer* render)
+{
+    title_screen_t* title = user;
+    (void)game;
 
-    SDL_Rect title_rect = {
-        DISPLAY_WIDTH / 2 - 200,
-        100,
-        400,
-        200,
+    draw_texture(render, title->play_texture, title->play_bbox);
+    draw_texture(render, title->quit_texture, title->quit_bbox);
+    draw_texture(render, title->to_credits_texture, title->credit_bbox);
+    SDL_RenderCopy(render, title->title_texture, NULL, &title->title_rect);
+}
+
+static void title_screen_init(title_screen_t* title, struct game_o* game, screens_t* screens)
+{
+    struct texture_cache_o* textures = game_textures(game);
+
+    const vec2_t credit_size = {50, 50};
+    const vec2_t credit_center = {DISPLAY_WIDTH - credit_size.x / 2 - 20, credit_size.y / 2 + 20};
+
+    *title = (title_screen_t){
+        .screens = screens,
+        .play_texture = texture_cache_get(textures, "assets/images/play_button.bmp"),
+        .quit_texture = texture_cache_get(textures, "assets/images/quit_button.bmp"),
+        .to_credits_texture = texture_cache_get(textures, "assets/images/to_credits.bmp"),
+        .title_texture = texture_cache_get(textures, "assets/images/title.bmp"),
+        .play_bbox = menu_button_bbox(100),
+        .quit_bbox = menu_button_bbox(250),
+        .credit_bbox = {
+            {credit_center.x - credit_size.x/2, credit_center.y - credit_size.y/2},
+            {credit_center.x + credit_size.x/2, credit_center.y + credit_size.y/2}},
+        .title_rect = {DISPLAY_WIDTH / 2 - 200, 100, 400, 200},
     };
+}
+
+//
+// Pause menu, drawn over the frozen game.
+//
+
+typedef struct pause_screen_t
+{
+    screens_t* screens;
+    SDL_Texture* resume_texture;
+    SDL_Texture* quit_texture;
+    bbox2_t resume_bbox;
+    bbox2_t quit_bbox;
+} pause_screen_t;
+
+static void pause_handle_input(void* user, struct game_o* game, const input_t* input)
+{
+    pause_screen_t* pause = user;
 
-    while (1)
+    if (input->keys_pressed & INPUT_KEY_ESCAPE)
     {
-        //
-        // Events
-        //
+        game_pop_state(game);
+    }
+    else if (input->buttons_pressed)
+    {
+        const vec2_t mouse_pos = input->press_cursor;
 
-        SDL_Event event;
-        while (SDL_PollEvent(&event))
+        if (bbox2_contain(pause->resume_bbox, mouse_pos))
         {
-            if (event.type == SDL_QUIT)
-            {
-                game_ctx->state = GAME_STATE_QUIT;
-                return;
-            }
-            else if (event.type == SDL_KEYDOWN)
-            {
-                switch (event.key.keysym.sym)
-                {
-                    case SDLK_ESCAPE:
-                        game_ctx->state = GAME_STATE_QUIT;
-                        return;
-                    default: break;
-                }
-            }
-            else if (event.type == SDL_MOUSEBUTTONDOWN)
-            {
-                vec2_t mouse_pos = {event.button.x, event.button.y};
-
-                if (bbox2_contain(play_bbox, mouse_pos))
-                {
-                    game_ctx->state = GAME_STATE_PLAYING;
-                    return;
-                }
-                else if (bbox2_contain(quit_bbox, mouse_pos))
-                {
-                    game_ctx->state = GAME_STATE_QUIT;
-                    return;
-                }
-                else if (bbox2_contain(credit_bbox, mouse_pos))
-                {
-                    game_ctx->state = GAME_STATE_CREDITS;
-                    return;
-                }
-            }
+            game_pop_state(game);
         }
+        else if (bbox2_contain(pause->quit_bbox, mouse_pos))
+        {
+            // Gives the game up, back to the title screen.
+            game_pop_state(game);
+            game_switch_state(game, &pause->screens->title);
+        }
+    }
+}
 
-        //
-        // Render
-        //
+static void pause_draw(void* user, struct game_o* game, SDL_Renderer* render)
+{
+    pause_screen_t* pause = user;
+    (void)game;
 
-        SDL_SetRenderDrawColor(render, 0, 0, 0, 0);
-        SDL_RenderClear(render);
+    SDL_SetRenderDrawBlendMode(render, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(render, 0, 0, 0, 160);
+    SDL_RenderFillRect(render, NULL);
+    SDL_SetRenderDrawBlendMode(render, SDL_BLENDMODE_NONE);
 
-        SDL_Rect play_rect = bbox2_to_sdl_rect(play_bbox);
-        SDL_Rect quit_rect = bbox2_to_sdl_rect(quit_bbox);
-        SDL_Rect credit_rect = bbox2_to_sdl_rect(credit_bbox);
+    draw_texture(render, pause->resume_texture, pause->resume_bbox);
+    draw_texture(render, pause->quit_texture, pause->quit_bbox);
+}
 
-        SDL_RenderCopy(render, play_texture, NULL, &play_rect);
-        SDL_RenderCopy(render, quit_texture, NULL, &quit_rect);
-        SDL_RenderCopy(render, to_credits_texture, NULL, &credit_rect);
-        SDL_RenderCopy(render, title_texture, NULL, &title_rect);
+static void pause_screen_init(pause_screen_t* pause, struct game_o* game, screens_t* screens)
+{
+    struct texture_cache_o* textures = game_textures(game);
+
+    // @Todo: dedicated resume and give up buttons.
+    *pause = (pause_screen_t){
+        .screens = screens,
+        .resume_texture = texture_cache_get(textures, "assets/images/play_button.bmp"),
+        .quit_texture = texture_cache_get(textures, "assets/images/quit_button.bmp"),
+        .resume_bbox = menu_button_bbox(-75),
+        .quit_bbox = menu_button_bbox(75),
+    };
+}
 
-        SDL_RenderPresent(render);
+//
+// Game
+//
 
-        SDL_Delay(100); // Static menu so we can delay quit a lot.
+typedef struct play_screen_t
+{
+    screens_t* screens;
+    struct presentation_o* presentation;
+    struct camera_o* camera;
+    struct player_o* player;
+    struct atom_system_o* atom_system;
+    struct camera_scrolling_system_o* scroll;
+
+    tuning_t tuning;
+    tuning_stamp_t tuning_stamp;
+
+    uint32_t total_updates;
+
+    // Statistics of the last second.
+    uint32_t timer_ms;
+    uint32_t update_frames;
+    uint32_t render_frames;
+    uint64_t atom_update_ticks;
+    uint32_t atom_fissions;
+    uint32_t atom_interaction_tests;
+} play_screen_t;
+
+// Mouse input steers the player towards the cursor while a button is held. Only the last cursor
+// position of the frame matters, the updates happen after.
+static void player_handle_input(struct player_o* player, const input_t* input)
+{
+    if (input->buttons_pressed)
+    {
+        player_start_move(player, input->press_cursor_world);
     }
 
-    SDL_DestroyTexture(play_texture);
-    SDL_DestroyTexture(quit_texture);
-    SDL_DestroyTexture(to_credits_texture);
-    SDL_DestroyTexture(title_texture);
+    if (input->buttons_down)
+    {
+        player_move_to(player, input->cursor_world);
+    }
+    else if (input->buttons_released)
+    {
+        player_stop_move(player);
+    }
 }
 
-static void start_game_loop(
-    struct display_o* display,
-    struct audio_system_o* audio_system,
-    game_t* game_ctx)
+// The world is only read by `play_enter`, the rest takes effect during the current game.
+static void play_apply_tuning(play_screen_t* play)
 {
-    assert(game_ctx->state == GAME_STATE_PLAYING);
+    atom_system_set_tuning(play->atom_system, &play->tuning);
+    atom_system_set_chain_reaction(play->atom_system, tuning_chain_reaction(&play->tuning));
+    player_set_tuning(play->player, &play->tuning);
+    camera_scrolling_system_set_tuning(play->scroll, &play->tuning);
+    presentation_set_tuning(play->presentation, &play->tuning);
+}
 
-    // Run the update loop at a fixed timestep at about 60 UPS (Update Per Second).
-    static const uint32_t UPDATE_STEP_MS = 1000 / 60;
+static void play_reset_stats(play_screen_t* play)
+{
+    play->timer_ms = SDL_GetTicks();
+    play->update_frames = 0;
+    play->render_frames = 0;
+    play->atom_update_ticks = 0;
+    play->atom_fissions = 0;
+    play->atom_interaction_tests = 0;
+}
 
-    SDL_Renderer* render = display_get_renderer(display);
-    SDL_Texture* background = load_bmp_to_texture(render, "assets/images/background.bmp");
+// Starts a new game, the systems are reused from one game to the next.
+static void play_enter(void* user, struct game_o* game)
+{
+    play_screen_t* play = user;
+
+    const uint64_t seed = ((uint64_t)rand() << 32) ^ (uint64_t)rand();
+    atom_system_reset(play->atom_system, tuning_world(&play->tuning, seed));
+    // The chain reaction is clamped to the atoms of the new game.
+    atom_system_set_chain_reaction(play->atom_system, tuning_chain_reaction(&play->tuning));
+    player_reset(play->player);
+    camera_look_at(play->camera, (vec2_t){0, 0});
+    game_set_camera(game, play->camera);
+
+    play->total_updates = 0;
+    play_reset_stats(play);
+}
 
-    struct camera_o* camera = camera_create((vec2_t){0, 0}, (vec2_t){DISPLAY_WIDTH, DISPLAY_HEIGHT});
-    struct player_o* player = player_create(render);
-    struct atom_system_o* atom_system = atom_system_create(render);
-    struct camera_scrolling_system_o* scroll = camera_scrolling_system_create();
+static void play_exit(void* user, struct game_o* game)
+{
+    (void)user;
+    game_set_camera(game, NULL);
+}
 
-    world_t world = {
-        .bounds = {
-            .north = 600,
-            .south = -600,
-            .east = 800,
-            .west = -800,
-        },
-    };
+static void play_handle_input(void* user, struct game_o* game, const input_t* input)
+{
+    play_screen_t* play = user;
 
-    atom_system_generate_atoms(atom_system, player, world, 5);
+    player_handle_input(play->player, input);
 
-    // @Todo: use SDL_GetPerformanceCounter() coupled with SDL_GetPerformanceFrequency().
-    uint32_t last_time = SDL_GetTicks();
-    uint32_t time_accumulator = 0;
-    uint32_t update_frames = 0;
-    uint32_t render_frames = 0;
-    uint32_t timer_ms = SDL_GetTicks();
+    if (input->keys_pressed & INPUT_KEY_ESCAPE)
+    {
+        // The button may be released while paused, the player stops and waits for a new click.
+        player_stop_move(play->player);
+        game_push_state(game, &play->screens->pause);
+    }
+}
+
+static void play_update(void* user, struct game_o* game)
+{
+    play_screen_t* play = user;
+    struct audio_system_o* audio_system = game_audio(game);
 
-    uint32_t win_count = 0;
+    // Updates after which the simulation must not allocate anymore (checked in debug builds).
+    static const uint32_t ALLOCATION_WARMUP_UPDATES = 60;
+    // About once a second, it only costs a `stat`.
+    static const uint32_t TUNING_CHECK_UPDATES = 60;
 
-    bool running = true;
-    while (running)
+    const uint32_t stable_atoms_to_win = play->tuning.stable_atoms_to_win;
+    if (stable_atoms_to_win > 0 && atom_system_num_stabilized(play->atom_system) >= stable_atoms_to_win)
     {
-        //
-        // Events
-        //
+        printf("Win!\n");
+        game_switch_state(game, &play->screens->credits);
+        return;
+    }
 
-        SDL_Event event;
-        while (SDL_PollEvent(&event))
+    if (play->total_updates % TUNING_CHECK_UPDATES == 0 && tuning_changed(TUNING_FILE, play->tuning_stamp))
+    {
+        if (tuning_load(TUNING_FILE, &play->tuning, &play->tuning_stamp))
         {
-            camera_handle_event(camera, event);
-            player_handle_event(player, camera, event);
-
-            if (event.type == SDL_QUIT)
-            {
-                game_ctx->state = GAME_STATE_QUIT;
-                running = false;
-                break;
-            }
-            else if (event.type == SDL_KEYDOWN)
-            {
-                switch (event.key.keysym.sym)
-                {
-                    case SDLK_ESCAPE:
-                        game_ctx->state = GAME_STATE_QUIT;
-                        running = false;
-                        break;
-                    default: break;
-                }
-            }
+            play_apply_tuning(play);
+            printf("Reloaded '%s'\n", TUNING_FILE);
         }
+    }
 
-        //
-        // Logic
-        //
+    // Streaming allocates the dormant state of the chunks it evicts.
+    atom_system_stream(play->atom_system, camera_position(play->camera));
 
-        const uint32_t now = SDL_GetTicks();
-        const uint32_t elapsed = now - last_time;
-        const uint32_t timer_elapsed = now - timer_ms;
+    const bool check_allocations = play->total_updates >= ALLOCATION_WARMUP_UPDATES;
+    if (check_allocations) mem_forbid_begin("simulation update");
+
+    camera_update(play->camera);
+    player_update(play->player, GAME_UPDATE_STEP_MS);
+    camera_scrolling_system_update(play->scroll, play->camera, play->player);
+    audio_system_set_listener(audio_system, camera_position(play->camera), DISPLAY_WIDTH / 2.0f);
+    const uint64_t atom_update_start = SDL_GetPerformanceCounter();
+    atom_system_update(play->atom_system, play->player, GAME_UPDATE_STEP_MS);
+    play->atom_update_ticks += SDL_GetPerformanceCounter() - atom_update_start;
+    play->atom_fissions += atom_system_metrics(play->atom_system).fissions;
+    play->atom_interaction_tests += atom_system_metrics(play->atom_system).interaction_tests;
+    presentation_play_sounds(audio_system, play->atom_system);
+
+    if (check_allocations) mem_forbid_end();
+
+    play->update_frames += 1;
+    play->total_updates += 1;
+
+    if (player_is_dead(play->player))
+    {
+        printf("Dead!\n");
+        game_switch_state(game, &play->screens->title);
+    }
+}
+
+static void play_report_stats(play_screen_t* play, struct game_o* game)
+{
+    // The game is still drawn under the pause menu but not updated, the statistics start over once
+    // it resumes and the title keeps the last ones meanwhile.
+    if (!game_is_top_state(game, &play->screens->play))
+    {
+        play_reset_stats(play);
+        return;
+    }
+
+    const uint32_t now = SDL_GetTicks();
+    const uint32_t timer_elapsed = now - play->timer_ms;
+    if (timer_elapsed < 1000)
+    {
+        return;
+    }
 
-        if (timer_elapsed >= 1000)
-        {
 #ifndef DNDEBUG
-            char title[256];
-            sprintf(title, "Render: %d FPS (%.3f ms/frame) - Update: %d UPS (%.3f ms/update)\n",
-                render_frames, 1000.0f / render_frames, update_frames, 1000.0f / update_frames);
-            display_set_title(display, &title[0]);
+    const audio_mix_stats_t mix_stats = audio_system_mix_stats(game_audio(game));
+    const atom_metrics_t atom_metrics = atom_system_metrics(play->atom_system);
+    // A frame taking over a second may have no update yet.
+    const uint32_t updates = play->update_frames > 0 ? play->update_frames : 1;
+    char title[512];
+    snprintf(title, sizeof(title), "Render: %d FPS (%.3f ms/frame) - Update: %d UPS (%.3f ms/update) - Memory: %.1f KB"
+        " - Audio: %.1f voices (%.0f voices/ms, %.2f%% load) - Chunks: %u active, %u dormant"
+        " - Atoms: %.3f ms/update, %u fissions/s, %u tests/s, largest cascade %u - World: %.0f%%\n",
+        play->render_frames, 1000.0f / play->render_frames, play->update_frames, 1000.0f / updates,
+        mem_stats_total().live_bytes / 1024.0f,
+        mix_stats.voices, mix_stats.voices_per_ms, 100.0f * mix_stats.load,
+        atom_system_num_active_chunks(play->atom_system), atom_system_num_dormant_chunks(play->atom_system),
+        1000.0 * play->atom_update_ticks / SDL_GetPerformanceFrequency() / updates,
+        play->atom_fissions, play->atom_interaction_tests, atom_metrics.largest_cascade,
+        100.0f * display_world_scale(game_display(game)));
+    display_set_title(game_display(game), &title[0]);
 #endif
 
-            timer_ms = now + 1000 - timer_elapsed;
-            render_frames = 0;
-            update_frames = 0;
-        }
+    play->timer_ms = now + 1000 - timer_elapsed;
+    play->render_frames = 0;
+    play->update_frames = 0;
+    play->atom_update_ticks = 0;
+    play->atom_fissions = 0;
+    play->atom_interaction_tests = 0;
+}
 
-        // If elapsed is 0 it means the frametime was below the timer precision. In this case we
-        // don't update `last_time`, skip the logic part and only perform the rendering.
-        if (elapsed != 0)
-        {
-            last_time = now;
-        }
+static void play_draw(void* user, struct game_o* game, SDL_Renderer* render)
+{
+    play_screen_t* play = user;
 
-        time_accumulator += elapsed;
+    display_begin_world(game_display(game));
+    presentation_draw(play->presentation, render, play->camera, play->player, play->atom_system);
+    display_end_world(game_display(game));
+    play->render_frames += 1;
 
-        while (time_accumulator >= UPDATE_STEP_MS)
-        {
-            if (atom_system_all_stable(atom_system))
-            {
-                atom_system_generate_atoms(atom_system, player, world, 2*win_count + 5);
-                win_count++;
-            }
-
-            if (win_count == 3)
-            {
-                printf("Win!\n");
-                game_ctx->state = GAME_STATE_CREDITS;
-                running = false;
-            }
-
-            camera_update(camera);
-            player_update(player, world, UPDATE_STEP_MS);
-            camera_scrolling_system_update(scroll, camera, player);
-            atom_system_update(atom_system, audio_system, player, world, UPDATE_STEP_MS);
-
-            if (player_is_dead(player))
-            {
-                printf("Dead!\n");
-                game_ctx->state = GAME_STATE_TITLESCREEN;
-                running = false;
-            }
-
-            time_accumulator -= UPDATE_STEP_MS;
-            update_frames += 1;
-        }
+    play_report_stats(play, game);
+}
 
-        //
-        // Render
-        //
+static void play_screen_init(play_screen_t* play, struct game_o* game, screens_t* screens)
+{
+    *play = (play_screen_t){
+        .screens = screens,
+        .presentation = presentation_create(game_textures(game)),
+        .camera = camera_create((vec2_t){0, 0}, (vec2_t){DISPLAY_WIDTH, DISPLAY_HEIGHT}),
+        .player = player_create(),
+        .atom_system = atom_system_create(),
+        .scroll = camera_scrolling_system_create(),
+        .tuning = tuning_default(),
+    };
 
-        SDL_SetRenderDrawColor(render, 0, 0, 0, 0);
-        SDL_RenderClear(render);
+    // The game can still be played without its tuning file.
+    if (!tuning_load(TUNING_FILE, &play->tuning, &play->tuning_stamp))
+    {
+        printf("Playing with the default tuning.\n");
+    }
+    play_apply_tuning(play);
+}
 
-        SDL_Rect background_rect = sdl_rect_from_pos_and_size(camera, (vec2_t){0, 0}, (vec2_t){world.bounds.east, world.bounds.north});
-        SDL_RenderCopy(render, background, NULL, NULL);
-        SDL_SetRenderDrawColor(render, 81, 64, 32, 255);
-        SDL_RenderDrawRect(render, &background_rect);
+static void play_screen_shutdown(play_screen_t* play)
+{
+    presentation_destroy(play->presentation);
+    camera_scrolling_system_destroy(play->scroll);
+    atom_system_destroy(play->atom_system);
+    player_destroy(play->player);
+    camera_destroy(play->camera);
+}
 
-        player_draw(player, camera, render);
-        atom_system_draw(atom_system, camera, render);
+static void enable_dynamic_resolution(struct display_o* display)
+{
+    const char* target = getenv(DYNAMIC_RESOLUTION_VARIABLE);
+    if (!target)
+    {
+        return;
+    }
+
+    const float target_fps = strtof(target, NULL);
+    if (target_fps <= 0)
+    {
+        fprintf(stderr, "Invalid %s value '%s', ignored.\n", DYNAMIC_RESOLUTION_VARIABLE, target);
+        return;
+    }
 
-        SDL_RenderPresent(render);
-        render_frames += 1;
+    // Down to a quarter of the pixels of the window, below that the sprites are a blur.
+    const dynamic_resolution_t resolution = {
+        .target_frame_ms = 1000 / target_fps,
+        .min_scale = 0.5f,
+        .max_scale = 1,
+    };
+    if (display_enable_dynamic_resolution(display, &resolution))
+    {
+        printf("Dynamic resolution: %.0f FPS target\n", target_fps);
+    }
+}
+
+//
+// Startup
+//
+
+// Images of the screens, read while the window is created. An image missing from the list is
+// still loaded by the texture cache when a screen asks for it, only not in parallel.
+static const char* STARTUP_IMAGES[] = {
+    "assets/images/atom.bmp",
+    "assets/images/back.bmp",
+    "assets/images/background.bmp",
+    "assets/images/cat.bmp",
+    "assets/images/credits.bmp",
+    "assets/images/neutron.bmp",
+    "assets/images/play_button.bmp",
+    "assets/images/quit_button.bmp",
+    "assets/images/title.bmp",
+    "assets/images/to_credits.bmp",
+};
+
+enum { NUM_STARTUP_IMAGES = sizeof(STARTUP_IMAGES) / sizeof(STARTUP_IMAGES[0]) };
+
+// What doesn't need the window nor the renderer is loaded on a thread of its own while they are
+// created: reading the images, loading the sounds, opening the audio device and starting the
+// music. QOI images are decoded when uploaded, straight into their texture.
+typedef struct startup_loading_t
+{
+    image_t images[NUM_STARTUP_IMAGES];
+    struct audio_system_o* audio_system;
+} startup_loading_t;
+
+static int startup_load(void* data)
+{
+    startup_loading_t* loading = data;
+
+    const uint32_t images_phase = timeline_begin("read images");
+    for (uint32_t i = 0; i < NUM_STARTUP_IMAGES; ++i)
+    {
+        load_image(STARTUP_IMAGES[i], &loading->images[i]);
     }
+    timeline_end(images_phase);
 
-    // Cleanup
+    loading->audio_system = audio_system_create();
 
-    SDL_DestroyTexture(background);
+    const uint32_t music_phase = timeline_begin("music stream");
+    audio_system_play_music(loading->audio_system, MUSIC_FILE, MUSIC_GAIN);
+    timeline_end(music_phase);
 
-    atom_system_destroy(atom_system);
-    player_destroy(player);
-    camera_destroy(camera);
+    return 0;
 }
 
 int main(int argc, char* argv[])
 {
+    timeline_start();
     srand(time(NULL));
 
+    // @Note: the audio subsystem isn't initialized on the loading thread, SDL doesn't protect its
+    // subsystem reference counts and both subsystems count on the events one.
+    const uint32_t init_phase = timeline_begin("SDL init");
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0)
     {
         printf("Error initializing the SDL: %s\n", SDL_GetError());
         return 1;
     }
+    timeline_end(init_phase);
+
+    cpu_dispatch_init();
+
+    startup_loading_t loading = {0};
+    SDL_Thread* loading_thread = SDL_CreateThread(startup_load, "startup loading", &loading);
+    if (!loading_thread)
+    {
+        fprintf(stderr, "Couldn't create the loading thread, loading serially: %s\n", SDL_GetError());
+        startup_load(&loading);
+    }
 
+    const uint32_t display_phase = timeline_begin("window and renderer");
     struct display_o* display = display_create(DISPLAY_WIDTH, DISPLAY_HEIGHT, GAME_TITLE);
-    struct audio_system_o* audio_system = audio_system_create();
+    enable_dynamic_resolution(display);
+    timeline_end(display_phase);
 
-    // Init + main loop
-    game_t game_ctx = {
-        .state = GAME_STATE_TITLESCREEN,
-    };
+    const uint32_t wait_phase = timeline_begin("wait for loading");
+    SDL_WaitThread(loading_thread, NULL);
+    timeline_end(wait_phase);
+
+    struct audio_system_o* audio_system = loading.audio_system;
+    struct game_o* game = game_create(display, audio_system);
 
-    // @Todo: textures shouldn't be reloaded every time but store somewhere else. Kind of like the
-    // audio stuff. But anyway, the game is small so nothing noticeable here :)
-    while (game_ctx.state != GAME_STATE_QUIT)
+    const uint32_t upload_phase = timeline_begin("decode and upload images");
+    for (uint32_t i = 0; i < NUM_STARTUP_IMAGES; ++i)
     {
-        start_titlescreen_loop(display, &game_ctx);
+        texture_cache_add(game_textures(game), STARTUP_IMAGES[i], &loading.images[i]);
+    }
+    timeline_end(upload_phase);
+
+    // Every screen and its resources are created once, moving from one to another is instant.
+    title_screen_t title;
+    credits_screen_t credits;
+    play_screen_t play;
+    pause_screen_t pause;
+
+    screens_t screens = {
+        .title = {
+            .name = "title", .user = &title, .idle = true,
+            .handle_input = title_handle_input, .draw = title_draw},
+        .credits = {
+            .name = "credits", .user = &credits, .idle = true,
+            .handle_input = credits_handle_input, .draw = credits_draw},
+        .play = {
+            .name = "play", .user = &play,
+            .enter = play_enter, .exit = play_exit, .handle_input = play_handle_input,
+            .update = play_update, .draw = play_draw},
+        .pause = {
+            .name = "pause", .user = &pause, .overlay = true, .idle = true,
+            .handle_input = pause_handle_input, .draw = pause_draw},
+    };
 
-        if (game_ctx.state == GAME_STATE_PLAYING)
-        {
-            start_game_loop(display, audio_system, &game_ctx);
-        }
+    const uint32_t screens_phase = timeline_begin("screens");
+    title_screen_init(&title, game, &screens);
+    credits_screen_init(&credits, game, &screens);
+    play_screen_init(&play, game, &screens);
+    pause_screen_init(&pause, game, &screens);
+    timeline_end(screens_phase);
 
-        if (game_ctx.state == GAME_STATE_CREDITS)
-        {
-            start_credit_loop(display, &game_ctx);
-        }
-    }
+    game_push_state(game, &screens.title);
+    game_run(game);
+
+    game_destroy(game);
+    play_screen_shutdown(&play);
 
     audio_system_destroy(audio_system);
     display_destroy(display);
     SDL_Quit();
+
+    if (getenv(STARTUP_TIMELINE_VARIABLE))
+    {
+        timeline_report(stdout);
+    }
+    mem_report(stdout);
     return 0;
 }
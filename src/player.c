@@ -1,22 +1,19 @@
 #include "player.h"
 
-#include "camera.h"
+#include "allocator.h"
 #include "linalg.h"
-#include "render.h"
-
-#include <SDL2/SDL.h>
+#include "tuning.h"
 
 #include <assert.h>
+#include <math.h>
 #include <stdlib.h>
 
 typedef struct player_o player_o;
 
-// @Todo: move this somewhere else.
-static const vec2_t PLAYER_SIZE = {60, 40};
-
 struct player_o
 {
     vec2_t pos;
+    vec2_t previous_pos;
     vec2_t dir;
     float bounding_circle_radius;
 
@@ -26,98 +23,99 @@ struct player_o
 
     bool is_dead;
 
-    SDL_Texture* texture;
+    // Size, slowdown and follow factor.
+    tuning_t tuning;
 };
 
-player_o* player_create(struct SDL_Renderer* render)
+player_o* player_create(void)
 {
-    // @Note @Todo: see later about custom allocators.
-    player_o* player = malloc(sizeof(struct player_o));
-    player->pos = (vec2_t){0, 0};
-    player->bounding_circle_radius = PLAYER_SIZE.x;
-    player->is_dead = false;
-    player->texture = load_bmp_to_texture(render, "assets/images/cat.bmp");
-
-    assert(player->texture);
-
+    player_o* player = mem_alloc(MEMORY_TAG_PLAYER, sizeof(struct player_o));
+    player->tuning = tuning_default();
+    player_reset(player);
     return player;
 }
 
 void player_destroy(struct player_o* player)
 {
-    SDL_DestroyTexture(player->texture);
     assert(player);
-    free(player);
+    mem_free(player);
 }
 
-void player_update(struct player_o* player, world_t world, float dt)
+void player_reset(struct player_o* player)
 {
     assert(player);
+    player->pos = (vec2_t){0, 0};
+    player->previous_pos = player->pos;
+    player->dir = (vec2_t){1, 0};
+    player->target = player->pos;
+    player->move = false;
+    player->speed = 0;
+    player->bounding_circle_radius = player->tuning.player_size.x;
+    player->is_dead = false;
+}
 
-    static const float SLOWDOWN_FACTOR = 0.9f;
-    static const float DISTANCE_PERCENT = 0.005f;
+void player_set_tuning(struct player_o* player, const struct tuning_t* tuning)
+{
+    assert(player && tuning);
+    player->tuning = *tuning;
+    player->bounding_circle_radius = tuning->player_size.x;
+}
+
+void player_update(struct player_o* player, float dt)
+{
+    assert(player);
 
     // Slowdown.
     if (!player->move)
     {
-        player->speed *= SLOWDOWN_FACTOR;
+        player->speed *= player->tuning.player_slowdown;
     }
 
-    // Update the target point for this update taking boundaries into account.
-    // This has the nice property of offering slowdown when close to world borders.
-    vec2_t target = player->target;
-    if (target.x > world.bounds.east) { target.x = world.bounds.east; }
-    else if (target.x < world.bounds.west) { target.x = world.bounds.west; }
-    if (target.y < world.bounds.south) { target.y = world.bounds.south; }
-    else if (target.y > world.bounds.north) { target.y = world.bounds.north; }
-
-    vec2_t to_target = vec2_sub(target, player->pos);
+    // The world is unbounded, the player can always reach its target.
+    vec2_t to_target = vec2_sub(player->target, player->pos);
     if (!(to_target.x < 1e-5 && to_target.y < 1e-5)) // @Todo: this is a bit hacky.
     {
         player->dir = vec2_normalize(to_target);
     }
-    player->speed = DISTANCE_PERCENT * vec2_length(to_target);
+    player->speed = fminf(player->tuning.player_follow * vec2_length(to_target), PLAYER_MAX_SPEED);
+    player->previous_pos = player->pos;
     player->pos = vec2_add(player->pos, vec2_mul_scalar(player->dir, player->speed * dt));
 }
 
-void player_handle_event(struct player_o* player, struct camera_o* camera, SDL_Event event)
+// Keeps the current direction when the target is the player position instead of going NaN.
+static vec2_t direction_to(const player_o* player, vec2_t target)
+{
+    const vec2_t to_target = vec2_sub(target, player->pos);
+    return vec2_length_sq(to_target) > 0 ? vec2_normalize(to_target) : player->dir;
+}
+
+void player_start_move(struct player_o* player, vec2_t target)
 {
-    assert(player && camera);
+    assert(player);
 
     static const float INITIAL_SPEED = 0.01f;
 
-    if (event.type == SDL_MOUSEBUTTONDOWN)
-    {
-        player->move = true;
-        player->speed = INITIAL_SPEED;
+    player->move = true;
+    player->speed = INITIAL_SPEED;
+    player->dir = direction_to(player, target);
+    player->target = target;
+}
 
-        vec2_t mouse = camera_screen_to_world(camera, (vec2_t){event.button.x, event.button.y});
-        player->dir = vec2_normalize(vec2_sub(mouse, player->pos));
-        player->target = mouse;
-    }
-    else if (event.type == SDL_MOUSEBUTTONUP)
-    {
-        player->move = false;
-    }
-    else if (event.type == SDL_MOUSEMOTION && player->move)
+void player_move_to(struct player_o* player, vec2_t target)
+{
+    assert(player);
+
+    if (player->move)
     {
-        vec2_t mouse = camera_screen_to_world(camera, (vec2_t){event.button.x, event.button.y});
-        player->dir = vec2_normalize(vec2_sub(mouse, player->pos));
-        player->target = mouse;
+        player->dir = direction_to(player, target);
+        player->target = target;
     }
 }
 
-void player_draw(struct player_o* player, struct camera_o* camera, struct SDL_Renderer* render)
+void player_stop_move(struct player_o* player)
 {
-    assert(player && camera && render);
-
-    SDL_Rect rect = sdl_rect_from_pos_and_size(
-        camera, player->pos, PLAYER_SIZE);
-
-    SDL_SetRenderDrawColor(render, 255, 0, 0, 255);
-    // SDL_RenderDrawRect(render, &rect);
-    SDL_RendererFlip flip = player->dir.x >= 0 ? SDL_FLIP_NONE : SDL_FLIP_HORIZONTAL;
-    SDL_RenderCopyEx(render, player->texture, NULL, &rect, 0, NULL, flip);
+    assert(player);
+    player->move = false;
 }
 
 bool player_intersect_circle(struct player_o* player, circle_t other)
@@ -126,12 +124,30 @@ bool player_intersect_circle(struct player_o* player, circle_t other)
     return circle_intersect((circle_t){player->pos, player->bounding_circle_radius}, other);
 }
 
+circle_t player_bounding_circle(const struct player_o* player)
+{
+    assert(player);
+    return (circle_t){player->pos, player->bounding_circle_radius};
+}
+
 vec2_t player_position(const struct player_o* player)
 {
     assert(player);
     return player->pos;
 }
 
+vec2_t player_previous_position(const struct player_o* player)
+{
+    assert(player);
+    return player->previous_pos;
+}
+
+vec2_t player_direction(const struct player_o* player)
+{
+    assert(player);
+    return player->dir;
+}
+
 void player_die(struct player_o* player)
 {
     assert(player);
@@ -0,0 +1,244 @@
+#include "presentation.h"
+
+#include "allocator.h"
+#include "array.h"
+#include "atom.h"
+#include "audio.h"
+#include "camera.h"
+#include "linalg.h"
+#include "linalg_batch.h"
+#include "player.h"
+#include "render.h"
+#include "texture_cache.h"
+#include "tuning.h"
+
+#include <SDL2/SDL.h>
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+struct presentation_o
+{
+    // Owned by the texture cache.
+    SDL_Texture* background_texture;
+    SDL_Texture* player_texture;
+    SDL_Texture* atom_texture;
+    SDL_Texture* neutron_texture;
+
+    // Half extents, the atoms have theirs in their info.
+    vec2_t player_size;
+    float neutron_size;
+
+    // Scratch screen positions of the neutrons filled when drawing.
+    /* array */ float* neutron_screen_x;
+    /* array */ float* neutron_screen_y;
+};
+
+static const enum AudioEntry atom_event_sounds[_ATOM_EVENT_TYPE_COUNT] = {
+    [ATOM_EVENT_EMIT_NEUTRON] = AUDIO_ENTRY_EMIT_NEUTRON,
+    [ATOM_EVENT_STABLE] = AUDIO_ENTRY_ATOM_STABLE,
+    [ATOM_EVENT_FISSION] = AUDIO_ENTRY_FISSION,
+};
+
+struct presentation_o* presentation_create(struct texture_cache_o* textures)
+{
+    struct presentation_o* pres = mem_alloc(MEMORY_TAG_DISPLAY, sizeof(struct presentation_o));
+    pres->background_texture = texture_cache_get(textures, "assets/images/background.bmp");
+    pres->player_texture = texture_cache_get(textures, "assets/images/cat.bmp");
+    pres->atom_texture = texture_cache_get(textures, "assets/images/atom.bmp");
+    pres->neutron_texture = texture_cache_get(textures, "assets/images/neutron.bmp");
+    pres->neutron_screen_x = NULL;
+    pres->neutron_screen_y = NULL;
+    const tuning_t tuning = tuning_default();
+    presentation_set_tuning(pres, &tuning);
+
+    assert(pres->player_texture);
+
+    return pres;
+}
+
+void presentation_destroy(struct presentation_o* pres)
+{
+    assert(pres);
+
+    array_free(pres->neutron_screen_x);
+    array_free(pres->neutron_screen_y);
+    mem_free(pres);
+}
+
+void presentation_set_tuning(struct presentation_o* pres, const struct tuning_t* tuning)
+{
+    assert(pres && tuning);
+    pres->player_size = tuning->player_size;
+    pres->neutron_size = tuning->neutron_size;
+}
+
+void presentation_play_sounds(struct audio_system_o* audio, const struct atom_system_o* as)
+{
+    assert(audio && as);
+
+    uint32_t num_events = 0;
+    const atom_event_t* events = atom_system_events(as, &num_events);
+    for (uint32_t i = 0; i < num_events; ++i)
+    {
+        // The audio system coalesces the triggers of atoms emitting at the same time.
+        audio_system_play_at(audio, atom_event_sounds[events[i].type], events[i].pos);
+    }
+}
+
+// Texel of the background at the top-left corner of the screen along one axis, `screens` being
+// the distance to the origin in screen sizes.
+static int background_offset(float screens, int texture_size)
+{
+    const int offset = (int)((screens - floorf(screens)) * texture_size);
+    return offset < texture_size ? offset : 0;
+}
+
+// The background covers the screen at the origin and repeats every screen size in the world. It is
+// drawn in up to 4 parts: the texture from the offset to its end, then its start, on both axes.
+static void draw_world(struct presentation_o* pres, SDL_Renderer* render, struct camera_o* camera)
+{
+    int width = 0;
+    int height = 0;
+    SDL_QueryTexture(pres->background_texture, NULL, NULL, &width, &height);
+    if (width == 0 || height == 0)
+    {
+        return;
+    }
+
+    const vec2_t pos = camera_position(camera);
+    const vec2_t viewport = camera_viewport(camera);
+    // The world y axis goes up, the texture one down.
+    const int offset_x = background_offset(pos.x / viewport.x, width);
+    const int offset_y = background_offset(-pos.y / viewport.y, height);
+    const int split_x = (int)roundf((float)(width - offset_x) * viewport.x / width);
+    const int split_y = (int)roundf((float)(height - offset_y) * viewport.y / height);
+
+    const int src_x[2] = {offset_x, 0};
+    const int src_w[2] = {width - offset_x, offset_x};
+    const int dst_x[2] = {0, split_x};
+    const int dst_w[2] = {split_x, (int)viewport.x - split_x};
+    const int src_y[2] = {offset_y, 0};
+    const int src_h[2] = {height - offset_y, offset_y};
+    const int dst_y[2] = {0, split_y};
+    const int dst_h[2] = {split_y, (int)viewport.y - split_y};
+
+    for (int j = 0; j < 2; ++j)
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            if (src_w[i] == 0 || src_h[j] == 0 || dst_w[i] <= 0 || dst_h[j] <= 0)
+            {
+                continue;
+            }
+
+            const SDL_Rect src = {src_x[i], src_y[j], src_w[i], src_h[j]};
+            const SDL_Rect dst = {dst_x[i], dst_y[j], dst_w[i], dst_h[j]};
+            SDL_RenderCopy(render, pres->background_texture, &src, &dst);
+        }
+    }
+}
+
+static void draw_player(
+    struct presentation_o* pres,
+    SDL_Renderer* render,
+    struct camera_o* camera,
+    const struct player_o* player)
+{
+    SDL_Rect rect = sdl_rect_from_pos_and_size(
+        camera, player_position(player), pres->player_size);
+
+    SDL_SetRenderDrawColor(render, 255, 0, 0, 255);
+    // SDL_RenderDrawRect(render, &rect);
+    SDL_RendererFlip flip = player_direction(player).x >= 0 ? SDL_FLIP_NONE : SDL_FLIP_HORIZONTAL;
+    SDL_RenderCopyEx(render, pres->player_texture, NULL, &rect, 0, NULL, flip);
+}
+
+static void draw_stability_bar(atom_info_t atom, struct camera_o* camera, SDL_Renderer* render)
+{
+    const float offset = atom.size;
+    const vec2_t bar_outline_size = {atom.size, 10};
+
+    vec2_t bar_outline_pos = vec2_add(atom.pos, (vec2_t){0, offset});
+    SDL_Rect rect_outline = sdl_rect_from_pos_and_size(camera, bar_outline_pos, bar_outline_size);
+
+    float fill_percent = (float)atom.num_left / atom.num_exceeding_neutrons;
+    vec2_t bar_size = {bar_outline_size.x * (1 - fill_percent) - 2, bar_outline_size.y - 2};
+    vec2_t bar_pos = {
+        bar_outline_pos.x - bar_outline_size.x / 2 + bar_size.x / 2 + 1,
+        bar_outline_pos.y,
+    };
+    SDL_Rect rect_bar = sdl_rect_from_pos_and_size(camera, bar_pos, bar_size);
+
+    SDL_SetRenderDrawColor(render, 0, 0, 0, 255);
+    SDL_RenderDrawRect(render, &rect_outline);
+    SDL_SetRenderDrawColor(render, 50, 50, 255, 255);
+    SDL_RenderFillRect(render, &rect_bar);
+}
+
+static void draw_atoms(
+    struct presentation_o* pres,
+    SDL_Renderer* render,
+    struct camera_o* camera,
+    const struct atom_system_o* as)
+{
+    // @Todo: culling
+
+    // Only used for the wobbling animation, precision doesn't matter.
+    const float wobble = approx_sinf(atom_system_wobble_angle(as));
+
+    for (uint32_t i = 0; i < atom_system_num_atoms(as); ++i)
+    {
+        const atom_info_t atom = atom_system_atom(as, i);
+
+        if (atom.num_left > 0)
+        {
+            SDL_Rect rect = sdl_rect_from_pos_and_size_with_scale(camera, atom.pos, (vec2_t){atom.size, atom.size}, 1 + wobble*0.3);
+            SDL_RenderCopyEx(render, pres->atom_texture, NULL, &rect, degrees(wobble), NULL, SDL_FLIP_NONE);
+            draw_stability_bar(atom, camera, render);
+        }
+        else
+        {
+            // @Todo: smooth transition instead of stopping directly.
+            SDL_Rect rect = sdl_rect_from_pos_and_size_with_scale(camera, atom.pos, (vec2_t){atom.size, atom.size}, 0.5);
+            SDL_RenderCopy(render, pres->atom_texture, NULL, &rect);
+        }
+    }
+
+    // Neutrons are only translated so their rects can be built from the batch transformed centers.
+    const uint32_t num_neutrons = atom_system_num_neutrons(as);
+    mem_push_tag(MEMORY_TAG_DISPLAY);
+    array_resize(pres->neutron_screen_x, num_neutrons);
+    array_resize(pres->neutron_screen_y, num_neutrons);
+    mem_pop_tag();
+    atom_system_neutron_positions(as, pres->neutron_screen_x, pres->neutron_screen_y);
+    batch_transform(
+        pres->neutron_screen_x, pres->neutron_screen_y, pres->neutron_screen_x, pres->neutron_screen_y,
+        camera_world_to_screen_matrix(camera), num_neutrons);
+
+    for (uint32_t i = 0; i < num_neutrons; ++i)
+    {
+        SDL_Rect rect = {
+            .x = pres->neutron_screen_x[i] - pres->neutron_size,
+            .y = pres->neutron_screen_y[i] - pres->neutron_size,
+            .w = 2 * pres->neutron_size,
+            .h = 2 * pres->neutron_size,
+        };
+        SDL_RenderCopy(render, pres->neutron_texture, NULL, &rect);
+    }
+}
+
+void presentation_draw(
+    struct presentation_o* pres,
+    struct SDL_Renderer* render,
+    struct camera_o* camera,
+    const struct player_o* player,
+    const struct atom_system_o* as)
+{
+    assert(pres && render && camera && player && as);
+
+    draw_world(pres, render, camera);
+    draw_player(pres, render, camera, player);
+    draw_atoms(pres, render, camera, as);
+}
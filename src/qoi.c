@@ -0,0 +1,347 @@
+#include "qoi.h"
+
+#include "allocator.h"
+
+#include <assert.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+enum { QOI_HEADER_SIZE = 14 };
+// The stream ends with 7 zeros and a one, which also lets an operation read a few bytes past the
+// last one without checking.
+enum { QOI_PADDING_SIZE = 8 };
+static const uint8_t QOI_PADDING[QOI_PADDING_SIZE] = {0, 0, 0, 0, 0, 0, 0, 1};
+static const uint32_t QOI_MAGIC = 'q' << 24 | 'o' << 16 | 'i' << 8 | 'f';
+
+// The 2-bit tags are checked after the 8-bit ones, `QOI_OP_RUN` can't encode runs of 63 or 64
+// since they would collide with them.
+enum
+{
+    QOI_OP_INDEX = 0x00,
+    QOI_OP_DIFF = 0x40,
+    QOI_OP_LUMA = 0x80,
+    QOI_OP_RUN = 0xc0,
+    QOI_OP_RGB = 0xfe,
+    QOI_OP_RGBA = 0xff,
+};
+static const uint32_t QOI_MAX_RUN = 62;
+
+// Pixels are `0xAARRGGBB` words.
+static inline uint32_t pixel(uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+{
+    return (a & 0xff) << 24 | (r & 0xff) << 16 | (g & 0xff) << 8 | (b & 0xff);
+}
+
+static inline uint32_t red(uint32_t px) { return (px >> 16) & 0xff; }
+static inline uint32_t green(uint32_t px) { return (px >> 8) & 0xff; }
+static inline uint32_t blue(uint32_t px) { return px & 0xff; }
+static inline uint32_t alpha(uint32_t px) { return px >> 24; }
+
+// (r * 3 + g * 5 + b * 7 + a * 11) % 64 with a single multiply: the channels are spread over 16-bit
+// lanes, the product sums them weighted in the top lane and no lane can carry into the next one.
+static inline uint32_t hash(uint32_t px)
+{
+    const uint64_t lanes = (px & 0x00ff00ffu) | (uint64_t)(px & 0xff00ff00u) << 24;
+    return (uint32_t)((lanes * (7ull << 48 | 3ull << 32 | 5ull << 16 | 11ull)) >> 48) & 63;
+}
+
+static inline uint32_t read_u32(const uint8_t* bytes)
+{
+    return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+}
+
+static inline uint8_t* write_u32(uint8_t* bytes, uint32_t value)
+{
+    bytes[0] = (uint8_t)(value >> 24);
+    bytes[1] = (uint8_t)(value >> 16);
+    bytes[2] = (uint8_t)(value >> 8);
+    bytes[3] = (uint8_t)value;
+    return bytes + 4;
+}
+
+static inline void fill(uint32_t* out, uint32_t px, uint32_t n)
+{
+    uint32_t i = 0;
+#if defined(__SSE2__)
+    const __m128i wide = _mm_set1_epi32((int)px);
+    for (; i + 4 <= n; i += 4)
+    {
+        _mm_storeu_si128((__m128i*)(out + i), wide);
+    }
+#elif defined(__ARM_NEON)
+    const uint32x4_t wide = vdupq_n_u32(px);
+    for (; i + 4 <= n; i += 4)
+    {
+        vst1q_u32(out + i, wide);
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        out[i] = px;
+    }
+}
+
+// Writes whole vectors when there is room past the `n` pixels, the extra ones are overwritten by
+// the next operations. Most runs are short, this saves the scalar tail.
+static inline void fill_run(uint32_t* out, uint32_t px, uint32_t n, size_t room)
+{
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    if (room >= n + 3)
+    {
+#if defined(__SSE2__)
+        const __m128i wide = _mm_set1_epi32((int)px);
+        for (uint32_t i = 0; i < n; i += 4)
+        {
+            _mm_storeu_si128((__m128i*)(out + i), wide);
+        }
+#else
+        const uint32x4_t wide = vdupq_n_u32(px);
+        for (uint32_t i = 0; i < n; i += 4)
+        {
+            vst1q_u32(out + i, wide);
+        }
+#endif
+        return;
+    }
+#else
+    (void)room;
+#endif
+    fill(out, px, n);
+}
+
+bool qoi_read_header(const void* data, size_t size, qoi_desc_t* desc)
+{
+    assert(data && desc);
+
+    const uint8_t* bytes = data;
+    if (size < QOI_HEADER_SIZE + QOI_PADDING_SIZE || read_u32(bytes) != QOI_MAGIC)
+    {
+        return false;
+    }
+
+    *desc = (qoi_desc_t){
+        .width = read_u32(bytes + 4),
+        .height = read_u32(bytes + 8),
+        .channels = bytes[12],
+        .colorspace = bytes[13],
+    };
+
+    return desc->width > 0 && desc->height > 0
+        && desc->height < QOI_MAX_PIXELS / desc->width
+        && (desc->channels == 3 || desc->channels == 4)
+        && desc->colorspace <= 1;
+}
+
+bool qoi_decode(const void* data, size_t size, uint32_t* pixels, uint32_t pitch)
+{
+    assert(data && pixels);
+
+    qoi_desc_t desc;
+    if (!qoi_read_header(data, size, &desc))
+    {
+        return false;
+    }
+    assert(pitch >= 4 * desc.width);
+
+    const uint8_t* bytes = data;
+    // Operations start before the end of the stream, they read at most 4 bytes of the padding.
+    const size_t end = size - QOI_PADDING_SIZE;
+    size_t p = QOI_HEADER_SIZE;
+
+    // Rows without padding are decoded as a single one.
+    const bool packed = pitch == 4 * desc.width;
+    const size_t row_pixels = packed ? (size_t)desc.width * desc.height : desc.width;
+    const uint32_t num_rows = packed ? 1 : desc.height;
+
+    uint32_t index[64] = {0};
+    uint32_t px = pixel(0, 0, 0, 255);
+    // Pixels of a run left for the next row.
+    size_t run = 0;
+
+    for (uint32_t y = 0; y < num_rows; ++y)
+    {
+        uint32_t* out = (uint32_t*)((uint8_t*)pixels + (size_t)y * pitch);
+        uint32_t* const row_end = out + row_pixels;
+
+        const size_t carried = run < row_pixels ? run : row_pixels;
+        fill(out, px, (uint32_t)carried);
+        out += carried;
+        run -= carried;
+
+        while (out < row_end)
+        {
+            if (p >= end)
+            {
+                return false;
+            }
+
+            // Tested in the order of their frequency in the assets rather than switched on the tag,
+            // the indices and the runs write most pixels.
+            const uint8_t op = bytes[p++];
+            if (op < QOI_OP_DIFF)
+            {
+                // The pixel is already in the index unless the slot was never written: it is then
+                // 0, whose hash is 0.
+                px = index[op];
+                if (px == 0)
+                {
+                    index[0] = 0;
+                }
+                *out++ = px;
+                continue;
+            }
+
+            if (op >= QOI_OP_RUN && op < QOI_OP_RGB)
+            {
+                // The only operation writing several pixels, it may go on past the row.
+                run = (op & 0x3f) + 1;
+                const size_t room = (size_t)(row_end - out);
+                const size_t n = run < room ? run : room;
+                index[hash(px)] = px;
+                fill_run(out, px, (uint32_t)n, room);
+                out += n;
+                run -= n;
+                continue;
+            }
+
+            if (op < QOI_OP_LUMA)
+            {
+                px = pixel(
+                    red(px) + ((op >> 4) & 3) - 2,
+                    green(px) + ((op >> 2) & 3) - 2,
+                    blue(px) + (op & 3) - 2,
+                    alpha(px));
+            }
+            else if (op < QOI_OP_RUN)
+            {
+                const uint32_t dg = (op & 0x3f) - 32;
+                const uint8_t rb = bytes[p++];
+                px = pixel(
+                    red(px) + dg - 8 + ((rb >> 4) & 0x0f),
+                    green(px) + dg,
+                    blue(px) + dg - 8 + (rb & 0x0f),
+                    alpha(px));
+            }
+            else if (op == QOI_OP_RGB)
+            {
+                px = pixel(bytes[p], bytes[p + 1], bytes[p + 2], alpha(px));
+                p += 3;
+            }
+            else
+            {
+                px = pixel(bytes[p], bytes[p + 1], bytes[p + 2], bytes[p + 3]);
+                p += 4;
+            }
+
+            index[hash(px)] = px;
+            *out++ = px;
+        }
+    }
+
+    return true;
+}
+
+void* qoi_encode(const uint32_t* pixels, uint32_t pitch, qoi_desc_t desc, size_t* size)
+{
+    assert(pixels && size && desc.width > 0 && desc.height > 0);
+    assert((desc.channels == 3 || desc.channels == 4) && pitch >= 4 * desc.width);
+
+    // An RGBA operation per pixel at worst.
+    const size_t capacity = QOI_HEADER_SIZE + (size_t)desc.width * desc.height * (desc.channels + 1) + QOI_PADDING_SIZE;
+    uint8_t* bytes = mem_alloc(MEMORY_TAG_DISPLAY, capacity);
+
+    uint8_t* out = write_u32(bytes, QOI_MAGIC);
+    out = write_u32(out, desc.width);
+    out = write_u32(out, desc.height);
+    *out++ = desc.channels;
+    *out++ = desc.colorspace;
+
+    uint32_t index[64] = {0};
+    uint32_t previous = pixel(0, 0, 0, 255);
+    uint32_t run = 0;
+    const uint32_t opaque = desc.channels == 3 ? pixel(0, 0, 0, 255) : 0;
+
+    for (uint32_t y = 0; y < desc.height; ++y)
+    {
+        const uint32_t* row = (const uint32_t*)((const uint8_t*)pixels + (size_t)y * pitch);
+        for (uint32_t x = 0; x < desc.width; ++x)
+        {
+            const uint32_t px = desc.channels == 3 ? row[x] | opaque : row[x];
+            const bool last = y == desc.height - 1 && x == desc.width - 1;
+
+            if (px == previous)
+            {
+                run++;
+                if (run == QOI_MAX_RUN || last)
+                {
+                    *out++ = (uint8_t)(QOI_OP_RUN | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+
+            if (run > 0)
+            {
+                *out++ = (uint8_t)(QOI_OP_RUN | (run - 1));
+                run = 0;
+            }
+
+            const uint32_t h = hash(px);
+            if (index[h] == px)
+            {
+                *out++ = (uint8_t)(QOI_OP_INDEX | h);
+            }
+            else
+            {
+                index[h] = px;
+
+                if (alpha(px) == alpha(previous))
+                {
+                    const int32_t dr = (int8_t)(red(px) - red(previous));
+                    const int32_t dg = (int8_t)(green(px) - green(previous));
+                    const int32_t db = (int8_t)(blue(px) - blue(previous));
+                    const int32_t dr_dg = dr - dg;
+                    const int32_t db_dg = db - dg;
+
+                    if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2)
+                    {
+                        *out++ = (uint8_t)(QOI_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+                    }
+                    else if (dr_dg > -9 && dr_dg < 8 && dg > -33 && dg < 32 && db_dg > -9 && db_dg < 8)
+                    {
+                        *out++ = (uint8_t)(QOI_OP_LUMA | (dg + 32));
+                        *out++ = (uint8_t)((dr_dg + 8) << 4 | (db_dg + 8));
+                    }
+                    else
+                    {
+                        *out++ = QOI_OP_RGB;
+                        *out++ = (uint8_t)red(px);
+                        *out++ = (uint8_t)green(px);
+                        *out++ = (uint8_t)blue(px);
+                    }
+                }
+                else
+                {
+                    *out++ = QOI_OP_RGBA;
+                    *out++ = (uint8_t)red(px);
+                    *out++ = (uint8_t)green(px);
+                    *out++ = (uint8_t)blue(px);
+                    *out++ = (uint8_t)alpha(px);
+                }
+            }
+
+            previous = px;
+        }
+    }
+
+    memcpy(out, QOI_PADDING, QOI_PADDING_SIZE);
+    out += QOI_PADDING_SIZE;
+
+    *size = (size_t)(out - bytes);
+    return bytes;
+}
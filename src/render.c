@@ -1,31 +1,221 @@
 #include "render.h"
+
+#include "allocator.h"
 #include "camera.h"
+#include "qoi.h"
 
 #include <SDL2/SDL.h>
 
+#include <stdbool.h>
+#include <string.h>
+#include <sys/stat.h>
+
+enum { MAX_PATH_LENGTH = 512 };
+
 // @Todo: default to an in-memory created texture when loading failed ?
 
-SDL_Texture* load_bmp_to_texture(struct SDL_Renderer* render, const char* file)
+static bool modified_time(const char* file, int64_t* mtime)
 {
-    SDL_Surface* surface = SDL_LoadBMP(file);
-    if (!surface)
+    struct stat info;
+    if (stat(file, &info) != 0)
+    {
+        return false;
+    }
+
+    *mtime = info.st_mtime;
+    return true;
+}
+
+// The converted image of `file`, when there is one at least as recent as the BMP. Shipping only the
+// converted images works too.
+static bool converted_path(const char* file, char path[MAX_PATH_LENGTH])
+{
+    const size_t length = strlen(file);
+    if (length < 4 || length >= MAX_PATH_LENGTH || strcmp(file + length - 4, ".bmp") != 0)
+    {
+        return false;
+    }
+
+    memcpy(path, file, length - 4);
+    memcpy(path + length - 4, ".qoi", 5);
+
+    int64_t converted_mtime, source_mtime;
+    return modified_time(path, &converted_mtime)
+        && (!modified_time(file, &source_mtime) || source_mtime <= converted_mtime);
+}
+
+// The whole file is read at once, it is decoded when uploaded.
+static bool read_qoi(const char* file, image_t* image)
+{
+    SDL_RWops* rw = SDL_RWFromFile(file, "rb");
+    if (!rw)
+    {
+        return false;
+    }
+
+    const Sint64 size = SDL_RWsize(rw);
+    void* data = size > 0 ? mem_alloc(MEMORY_TAG_DISPLAY, (size_t)size) : NULL;
+    const bool read = data && SDL_RWread(rw, data, (size_t)size, 1) == 1;
+    SDL_RWclose(rw);
+
+    if (!read || !qoi_read_header(data, (size_t)size, &image->desc))
+    {
+        mem_free(data);
+        return false;
+    }
+
+    image->qoi = data;
+    image->qoi_size = (size_t)size;
+    return true;
+}
+
+bool load_image(const char* file, image_t* image)
+{
+    *image = (image_t){0};
+
+    char converted[MAX_PATH_LENGTH];
+    if (converted_path(file, converted))
+    {
+        if (read_qoi(converted, image))
+        {
+            return true;
+        }
+        fprintf(stderr, "Couldn't load '%s', falling back to the BMP.\n", converted);
+    }
+
+    image->surface = SDL_LoadBMP(file);
+    if (!image->surface)
     {
         fprintf(stderr, "Couldn't load '%s': %s\n", file, SDL_GetError());
-        return NULL;
+        return false;
     }
+    return true;
+}
 
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(render, surface);
+void image_free(image_t* image)
+{
+    mem_free(image->qoi);
+    SDL_FreeSurface(image->surface);
+    *image = (image_t){0};
+}
+
+// QOI pixels are decoded as `0xAARRGGBB` words, the opaque format ignores their alpha.
+static Uint32 qoi_format(const qoi_desc_t* desc)
+{
+    return desc->channels == 4 ? SDL_PIXELFORMAT_ARGB8888 : SDL_PIXELFORMAT_RGB888;
+}
+
+static SDL_Texture* qoi_to_texture(SDL_Renderer* render, const image_t* image)
+{
+    SDL_Texture* texture = SDL_CreateTexture(render, qoi_format(&image->desc), SDL_TEXTUREACCESS_STREAMING,
+        (int)image->desc.width, (int)image->desc.height);
     if (!texture)
     {
-        fprintf(stderr, "Couldn't convert '%s' to texture: %s\n", file, SDL_GetError());
-        SDL_FreeSurface(surface);
         return NULL;
     }
 
-    SDL_FreeSurface(surface);
+    void* pixels = NULL;
+    int pitch = 0;
+    bool decoded = SDL_LockTexture(texture, NULL, &pixels, &pitch) == 0;
+    if (decoded)
+    {
+        decoded = qoi_decode(image->qoi, image->qoi_size, pixels, (uint32_t)pitch);
+        SDL_UnlockTexture(texture);
+    }
+
+    if (!decoded)
+    {
+        SDL_DestroyTexture(texture);
+        return NULL;
+    }
+
+    // The same blending `SDL_CreateTextureFromSurface` picks for the BMPs.
+    if (image->desc.channels == 4)
+    {
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    }
+    return texture;
+}
+
+SDL_Texture* image_to_texture(SDL_Renderer* render, image_t* image, const char* file)
+{
+    SDL_Texture* texture = NULL;
+    if (image->qoi)
+    {
+        texture = qoi_to_texture(render, image);
+    }
+    else if (image->surface)
+    {
+        texture = SDL_CreateTextureFromSurface(render, image->surface);
+    }
+
+    if (!texture && (image->qoi || image->surface))
+    {
+        fprintf(stderr, "Couldn't convert '%s' to texture: %s\n", file, SDL_GetError());
+    }
+
+    image_free(image);
     return texture;
 }
 
+bool image_update_texture(SDL_Texture* texture, image_t* image, const char* file)
+{
+    // Decoded aside first so that a broken file leaves the texture as it was.
+    if (image->qoi)
+    {
+        image->surface = SDL_CreateRGBSurfaceWithFormat(
+            0, (int)image->desc.width, (int)image->desc.height, 32, qoi_format(&image->desc));
+        if (image->surface
+            && !qoi_decode(image->qoi, image->qoi_size, image->surface->pixels, (uint32_t)image->surface->pitch))
+        {
+            SDL_FreeSurface(image->surface);
+            image->surface = NULL;
+        }
+    }
+
+    SDL_Surface* surface = image->surface;
+    if (!surface)
+    {
+        fprintf(stderr, "Couldn't reload '%s'.\n", file);
+        image_free(image);
+        return false;
+    }
+
+    uint32_t format = 0;
+    int width = 0;
+    int height = 0;
+    SDL_QueryTexture(texture, &format, NULL, &width, &height);
+    if (surface->w != width || surface->h != height)
+    {
+        fprintf(stderr, "'%s' changed size, restart to see it.\n", file);
+        image_free(image);
+        return false;
+    }
+
+    if (surface->format->format != format)
+    {
+        SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, format, 0);
+        SDL_FreeSurface(surface);
+        image->surface = surface = converted;
+    }
+
+    const bool updated = surface && SDL_UpdateTexture(texture, NULL, surface->pixels, surface->pitch) == 0;
+    if (!updated)
+    {
+        fprintf(stderr, "Couldn't reload '%s': %s\n", file, SDL_GetError());
+    }
+
+    image_free(image);
+    return updated;
+}
+
+SDL_Texture* load_image_to_texture(struct SDL_Renderer* render, const char* file)
+{
+    image_t image;
+    load_image(file, &image);
+    return image_to_texture(render, &image, file);
+}
+
 SDL_Rect sdl_rect_from_pos_and_size(struct camera_o* camera, vec2_t pos, vec2_t size)
 {
     vec2_t bl = {pos.x - size.x, pos.y - size.y};
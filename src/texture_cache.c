@@ -0,0 +1,114 @@
+#include "texture_cache.h"
+
+#include "allocator.h"
+#include "array.h"
+#include "render.h"
+
+#include <SDL2/SDL.h>
+
+#include <assert.h>
+#include <string.h>
+
+typedef struct texture_entry_t texture_entry_t;
+
+struct texture_entry_t
+{
+    char* path;
+    SDL_Texture* texture; // NULL when loading failed.
+};
+
+struct texture_cache_o
+{
+    SDL_Renderer* render;
+    // A screen only uses a handful of textures, they are looked up linearly when it is created.
+    /* array */ texture_entry_t* entries;
+};
+
+struct texture_cache_o* texture_cache_create(struct SDL_Renderer* render)
+{
+    struct texture_cache_o* cache = mem_alloc(MEMORY_TAG_DISPLAY, sizeof(struct texture_cache_o));
+    cache->render = render;
+    cache->entries = NULL;
+    return cache;
+}
+
+void texture_cache_destroy(struct texture_cache_o* cache)
+{
+    assert(cache);
+
+    for (uint32_t i = 0; i < array_size(cache->entries); ++i)
+    {
+        SDL_DestroyTexture(cache->entries[i].texture);
+        mem_free(cache->entries[i].path);
+    }
+    array_free(cache->entries);
+    mem_free(cache);
+}
+
+static texture_entry_t* find_entry(struct texture_cache_o* cache, const char* path)
+{
+    for (uint32_t i = 0; i < array_size(cache->entries); ++i)
+    {
+        if (strcmp(cache->entries[i].path, path) == 0)
+        {
+            return &cache->entries[i];
+        }
+    }
+    return NULL;
+}
+
+static SDL_Texture* add_entry(struct texture_cache_o* cache, const char* path, SDL_Texture* texture)
+{
+    const size_t path_size = strlen(path) + 1;
+    texture_entry_t entry = {
+        .path = mem_alloc(MEMORY_TAG_DISPLAY, path_size),
+        .texture = texture,
+    };
+    memcpy(entry.path, path, path_size);
+
+    mem_push_tag(MEMORY_TAG_DISPLAY);
+    array_push(cache->entries, entry);
+    mem_pop_tag();
+
+    return entry.texture;
+}
+
+SDL_Texture* texture_cache_get(struct texture_cache_o* cache, const char* path)
+{
+    assert(cache && path);
+
+    const texture_entry_t* entry = find_entry(cache, path);
+    if (entry)
+    {
+        return entry->texture;
+    }
+
+    return add_entry(cache, path, load_image_to_texture(cache->render, path));
+}
+
+void texture_cache_add(struct texture_cache_o* cache, const char* path, image_t* image)
+{
+    assert(cache && path && image);
+
+    if (find_entry(cache, path))
+    {
+        image_free(image);
+        return;
+    }
+
+    add_entry(cache, path, image_to_texture(cache->render, image, path));
+}
+
+bool texture_cache_reload(struct texture_cache_o* cache, const char* path, image_t* image)
+{
+    assert(cache && path && image);
+
+    const texture_entry_t* entry = find_entry(cache, path);
+    if (!entry || !entry->texture)
+    {
+        image_free(image);
+        return false;
+    }
+
+    return image_update_texture(entry->texture, image, path);
+}
@@ -0,0 +1,184 @@
+#include "thread_pool.h"
+
+#include "allocator.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+typedef struct thread_pool_o thread_pool_o;
+typedef struct worker_t worker_t;
+
+struct worker_t
+{
+    pthread_t thread;
+    thread_pool_o* pool;
+    uint32_t index; // Passed to the loops, the caller is 0.
+};
+
+struct thread_pool_o
+{
+    worker_t* workers;
+    uint32_t num_workers;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t wake; // Workers wait for a new loop or for `quit`.
+    pthread_cond_t done; // The caller waits for the workers to leave the loop.
+    // Incremented for every loop, workers compare it with the last one they ran.
+    uint64_t generation;
+    uint32_t num_busy; // Workers which haven't left the current loop yet.
+    bool quit;
+
+    // Current loop, written under the mutex before `generation` is incremented.
+    thread_pool_fn_t fn;
+    void* user;
+    uint32_t count;
+    uint32_t block_size;
+    _Atomic uint32_t next_begin;
+};
+
+static void run_blocks(thread_pool_o* pool, uint32_t thread)
+{
+    for (;;)
+    {
+        const uint32_t begin = atomic_fetch_add_explicit(&pool->next_begin, pool->block_size, memory_order_relaxed);
+        if (begin >= pool->count)
+        {
+            return;
+        }
+
+        const uint32_t end = pool->count - begin < pool->block_size ? pool->count : begin + pool->block_size;
+        pool->fn(pool->user, begin, end, thread);
+    }
+}
+
+static void* worker_main(void* data)
+{
+    const worker_t* worker = data;
+    thread_pool_o* pool = worker->pool;
+
+    // Not read from the pool, a worker starting after the first loop began must still run it.
+    uint64_t generation = 0;
+    pthread_mutex_lock(&pool->mutex);
+    for (;;)
+    {
+        while (!pool->quit && pool->generation == generation)
+        {
+            pthread_cond_wait(&pool->wake, &pool->mutex);
+        }
+        if (pool->quit)
+        {
+            break;
+        }
+        generation = pool->generation;
+
+        pthread_mutex_unlock(&pool->mutex);
+        run_blocks(pool, worker->index);
+        pthread_mutex_lock(&pool->mutex);
+
+        if (--pool->num_busy == 0)
+        {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+thread_pool_o* thread_pool_create(uint32_t num_workers)
+{
+    thread_pool_o* pool = mem_alloc(MEMORY_TAG_MISC, sizeof(struct thread_pool_o));
+    pool->workers = num_workers ? mem_alloc(MEMORY_TAG_MISC, num_workers * sizeof(worker_t)) : NULL;
+    pool->num_workers = 0;
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->generation = 0;
+    pool->num_busy = 0;
+    pool->quit = false;
+    pool->fn = NULL;
+    pool->user = NULL;
+    pool->count = 0;
+    pool->block_size = 1;
+    atomic_init(&pool->next_begin, 0);
+
+    // The loops still run on the caller with the workers that could be started.
+    for (uint32_t i = 0; i < num_workers; ++i)
+    {
+        worker_t* worker = &pool->workers[pool->num_workers];
+        worker->pool = pool;
+        worker->index = 1 + pool->num_workers;
+        if (pthread_create(&worker->thread, NULL, worker_main, worker) != 0)
+        {
+            break;
+        }
+        pool->num_workers++;
+    }
+
+    return pool;
+}
+
+void thread_pool_destroy(thread_pool_o* pool)
+{
+    assert(pool);
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->quit = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (uint32_t i = 0; i < pool->num_workers; ++i)
+    {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->mutex);
+    mem_free(pool->workers);
+    mem_free(pool);
+}
+
+uint32_t thread_pool_num_workers(const thread_pool_o* pool)
+{
+    assert(pool);
+    return pool->num_workers;
+}
+
+void thread_pool_for(
+    thread_pool_o* pool, thread_pool_fn_t fn, void* user, uint32_t count, uint32_t block_size)
+{
+    assert(pool && fn && block_size > 0);
+
+    if (pool->num_workers == 0 || count <= block_size)
+    {
+        if (count > 0)
+        {
+            fn(user, 0, count, 0);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->fn = fn;
+    pool->user = user;
+    pool->count = count;
+    pool->block_size = block_size;
+    atomic_store_explicit(&pool->next_begin, 0, memory_order_relaxed);
+    pool->num_busy = pool->num_workers;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->mutex);
+
+    run_blocks(pool, 0);
+
+    // Workers may still be running their last block, or not even be awake yet.
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->num_busy > 0)
+    {
+        pthread_cond_wait(&pool->done, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
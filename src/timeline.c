@@ -0,0 +1,105 @@
+#include "timeline.h"
+
+#include <SDL2/SDL.h>
+
+#include <assert.h>
+#include <stdatomic.h>
+
+typedef struct phase_t phase_t;
+
+struct phase_t
+{
+    const char* name;
+    SDL_threadID thread;
+    uint64_t begin;
+    uint64_t end; // 0 while the phase runs.
+};
+
+static uint64_t origin = 0;
+static phase_t phases[TIMELINE_MAX_PHASES];
+static atomic_uint num_phases = 0;
+
+static const uint32_t DROPPED_PHASE = UINT32_MAX;
+
+void timeline_start(void)
+{
+    origin = SDL_GetPerformanceCounter();
+    atomic_store(&num_phases, 0);
+}
+
+uint32_t timeline_begin(const char* name)
+{
+    assert(name);
+
+    const uint32_t phase = atomic_fetch_add(&num_phases, 1);
+    if (phase >= TIMELINE_MAX_PHASES)
+    {
+        return DROPPED_PHASE;
+    }
+
+    phases[phase] = (phase_t){
+        .name = name,
+        .thread = SDL_ThreadID(),
+        .begin = SDL_GetPerformanceCounter(),
+        .end = 0,
+    };
+    return phase;
+}
+
+void timeline_end(uint32_t phase)
+{
+    if (phase == DROPPED_PHASE)
+    {
+        return;
+    }
+
+    assert(phase < TIMELINE_MAX_PHASES && phases[phase].end == 0);
+    phases[phase].end = SDL_GetPerformanceCounter();
+}
+
+static double to_ms(uint64_t ticks)
+{
+    return 1000.0 * ticks / SDL_GetPerformanceFrequency();
+}
+
+void timeline_report(FILE* out)
+{
+    const uint32_t count = SDL_min(atomic_load(&num_phases), TIMELINE_MAX_PHASES);
+
+    // Threads are numbered in the order they first recorded a phase, the thread calling
+    // `timeline_start` is usually the first.
+    SDL_threadID threads[TIMELINE_MAX_PHASES];
+    uint32_t num_threads = 0;
+
+    fprintf(out, "%-28s %8s %10s %10s %7s\n", "phase", "thread", "start (ms)", "end (ms)", "(ms)");
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const phase_t* phase = &phases[i];
+
+        uint32_t thread = 0;
+        while (thread < num_threads && threads[thread] != phase->thread)
+        {
+            thread++;
+        }
+        if (thread == num_threads)
+        {
+            threads[num_threads++] = phase->thread;
+        }
+
+        if (phase->end == 0)
+        {
+            fprintf(out, "%-28s %8u %10.3f %10s %7s\n",
+                phase->name, thread, to_ms(phase->begin - origin), "-", "-");
+        }
+        else
+        {
+            fprintf(out, "%-28s %8u %10.3f %10.3f %7.3f\n",
+                phase->name, thread, to_ms(phase->begin - origin), to_ms(phase->end - origin), to_ms(phase->end - phase->begin));
+        }
+    }
+
+    if (atomic_load(&num_phases) > TIMELINE_MAX_PHASES)
+    {
+        fprintf(out, "%u phases dropped\n", atomic_load(&num_phases) - TIMELINE_MAX_PHASES);
+    }
+}
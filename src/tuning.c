@@ -0,0 +1,375 @@
+#include "tuning.h"
+
+#include "allocator.h"
+
+#include <assert.h>
+#include <ctype.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Longer lines are reported and skipped.
+enum { MAX_LINE_LENGTH = 256 };
+
+enum TuningType
+{
+    TUNING_FLOAT = 0,
+    TUNING_UINT,
+    TUNING_INT,
+    TUNING_BOOL,
+    TUNING_VEC2,
+};
+
+typedef struct tuning_field_t tuning_field_t;
+
+struct tuning_field_t
+{
+    const char* name;
+    enum TuningType type;
+    size_t offset;
+    // Inclusive, for both components of the vectors.
+    float min;
+    float max;
+};
+
+#define FIELD(name, type, min, max) {#name, type, offsetof(tuning_t, name), min, max}
+
+static const tuning_field_t FIELDS[] = {
+    FIELD(atom_size, TUNING_FLOAT, 1, 1000),
+    FIELD(neutron_size, TUNING_FLOAT, 1, 100),
+    // The dormant chunks keep the neutrons left on a byte.
+    FIELD(atom_neutrons, TUNING_UINT, 1, 255),
+    FIELD(atom_wobble_speed, TUNING_FLOAT, 0, 0.01f),
+    FIELD(preparation_ms, TUNING_FLOAT, 0, 60000),
+    FIELD(player_size, TUNING_VEC2, 1, 1000),
+    FIELD(player_slowdown, TUNING_FLOAT, 0, 1),
+    FIELD(player_follow, TUNING_FLOAT, 0, 1),
+    FIELD(camera_follow, TUNING_FLOAT, 0, 1),
+    FIELD(chunk_size, TUNING_FLOAT, 64, 65536),
+    FIELD(active_radius, TUNING_INT, 0, 16),
+    FIELD(chain_reaction, TUNING_BOOL, 0, 1),
+    FIELD(chain_cross_section, TUNING_FLOAT, 0, 1000),
+    FIELD(chain_fission_neutrons, TUNING_UINT, 0, 8),
+    FIELD(chain_max_cascade_fissions, TUNING_UINT, 0, 1 << 20),
+    FIELD(chain_max_cascade_depth, TUNING_UINT, 0, 1024),
+    FIELD(stable_atoms_to_win, TUNING_UINT, 0, 1 << 20),
+};
+
+#undef FIELD
+
+tuning_t tuning_default(void)
+{
+    return (tuning_t){
+        .atom_size = 100,
+        .neutron_size = 8,
+        .atom_neutrons = 10,
+        .atom_wobble_speed = 0.0005f,
+        .preparation_ms = 2000,
+        .player_size = {60, 40},
+        .player_slowdown = 0.9f,
+        .player_follow = 0.005f,
+        .camera_follow = 0.02f,
+        .chunk_size = 1024,
+        .active_radius = 1,
+        .chain_reaction = true,
+        .chain_cross_section = 100,
+        .chain_fission_neutrons = 3,
+        .chain_max_cascade_fissions = 16,
+        .chain_max_cascade_depth = 4,
+        .stable_atoms_to_win = 5 + 7 + 9,
+    };
+}
+
+static const tuning_field_t* find_field(const char* name)
+{
+    for (size_t i = 0; i < sizeof(FIELDS) / sizeof(FIELDS[0]); ++i)
+    {
+        if (strcmp(FIELDS[i].name, name) == 0)
+        {
+            return &FIELDS[i];
+        }
+    }
+    return NULL;
+}
+
+// Reads `count` numbers separated by spaces, nothing else may follow.
+static bool parse_numbers(const char* text, float* numbers, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        char* end;
+        numbers[i] = strtof(text, &end);
+        if (end == text || !isfinite(numbers[i]))
+        {
+            return false;
+        }
+        text = end;
+    }
+
+    while (isspace((unsigned char)*text))
+    {
+        text++;
+    }
+    return *text == '\0';
+}
+
+static bool parse_value(const tuning_field_t* field, const char* text, tuning_t* tuning)
+{
+    char* out = (char*)tuning + field->offset;
+    float numbers[2];
+
+    if (field->type == TUNING_BOOL)
+    {
+        const bool yes = strcmp(text, "true") == 0;
+        if (!yes && strcmp(text, "false") != 0)
+        {
+            return false;
+        }
+        *(bool*)out = yes;
+        return true;
+    }
+
+    const uint32_t count = field->type == TUNING_VEC2 ? 2 : 1;
+    if (!parse_numbers(text, numbers, count))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const bool integer = field->type == TUNING_UINT || field->type == TUNING_INT;
+        if (numbers[i] < field->min || numbers[i] > field->max || (integer && numbers[i] != floorf(numbers[i])))
+        {
+            return false;
+        }
+    }
+
+    switch (field->type)
+    {
+        case TUNING_FLOAT: *(float*)out = numbers[0]; break;
+        case TUNING_UINT: *(uint32_t*)out = (uint32_t)numbers[0]; break;
+        case TUNING_INT: *(int32_t*)out = (int32_t)numbers[0]; break;
+        case TUNING_VEC2: *(vec2_t*)out = (vec2_t){numbers[0], numbers[1]}; break;
+        case TUNING_BOOL: break;
+    }
+    return true;
+}
+
+// Removes the comment and the surrounding spaces in place.
+static char* trim(char* line)
+{
+    char* comment = strchr(line, '#');
+    if (comment)
+    {
+        *comment = '\0';
+    }
+
+    while (isspace((unsigned char)*line))
+    {
+        line++;
+    }
+
+    size_t length = strlen(line);
+    while (length > 0 && isspace((unsigned char)line[length - 1]))
+    {
+        line[--length] = '\0';
+    }
+    return line;
+}
+
+static void parse_line(const char* path, uint32_t number, char* line, tuning_t* tuning)
+{
+    line = trim(line);
+    if (*line == '\0')
+    {
+        return;
+    }
+
+    char* equal = strchr(line, '=');
+    if (!equal)
+    {
+        fprintf(stderr, "%s:%u: expected 'name = value'.\n", path, number);
+        return;
+    }
+
+    *equal = '\0';
+    const char* name = trim(line);
+    const char* value = trim(equal + 1);
+
+    const tuning_field_t* field = find_field(name);
+    if (!field)
+    {
+        fprintf(stderr, "%s:%u: unknown name '%s'.\n", path, number, name);
+    }
+    else if (!parse_value(field, value, tuning))
+    {
+        if (field->type == TUNING_BOOL)
+        {
+            fprintf(stderr, "%s:%u: invalid value '%s' for '%s', expected true or false.\n",
+                path, number, value, name);
+        }
+        else
+        {
+            fprintf(stderr, "%s:%u: invalid value '%s' for '%s', expected %s within [%g, %g].\n",
+                path, number, value, name, field->type == TUNING_VEC2 ? "two numbers" : "a number",
+                field->min, field->max);
+        }
+    }
+}
+
+static void parse(const char* path, const char* data, size_t size, tuning_t* tuning)
+{
+    // The mapping isn't null terminated, lines are copied before being parsed.
+    char line[MAX_LINE_LENGTH];
+    uint32_t number = 0;
+
+    for (size_t begin = 0; begin < size;)
+    {
+        const char* newline = memchr(data + begin, '\n', size - begin);
+        const size_t end = newline ? (size_t)(newline - data) : size;
+        const size_t length = end - begin;
+        number++;
+
+        if (length < MAX_LINE_LENGTH)
+        {
+            memcpy(line, data + begin, length);
+            line[length] = '\0';
+            parse_line(path, number, line, tuning);
+        }
+        else
+        {
+            fprintf(stderr, "%s:%u: line too long.\n", path, number);
+        }
+
+        begin = end + 1;
+    }
+}
+
+static bool valid(const char* path, const tuning_t* tuning)
+{
+    // Atoms are placed a bounding radius away from their chunk borders.
+    if (tuning->chunk_size <= 2*sqrtf(2)*tuning->atom_size)
+    {
+        fprintf(stderr, "%s: chunk_size must be over 2.83 times atom_size.\n", path);
+        return false;
+    }
+    return true;
+}
+
+static bool stat_file(const char* path, tuning_stamp_t* stamp)
+{
+    struct stat info;
+    if (stat(path, &info) != 0)
+    {
+        return false;
+    }
+
+    *stamp = (tuning_stamp_t){.size = (int64_t)info.st_size, .mtime = (int64_t)info.st_mtime};
+    return true;
+}
+
+#if defined(_WIN32)
+
+// The file is about a kilobyte, a single fread costs no more than mapping it.
+static bool read_file(const char* path, tuning_t* tuning)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file)
+    {
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char* data = mem_alloc(MEMORY_TAG_MISC, size > 0 ? (size_t)size : 1);
+    const size_t read = size > 0 ? fread(data, 1, (size_t)size, file) : 0;
+    fclose(file);
+
+    parse(path, data, read, tuning);
+    mem_free(data);
+    return true;
+}
+
+#else
+
+static bool read_file(const char* path, tuning_t* tuning)
+{
+    const int file = open(path, O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(file, &info) != 0)
+    {
+        close(file);
+        return false;
+    }
+
+    // Mapping an empty file fails, there is nothing to parse anyway.
+    const size_t size = (size_t)info.st_size;
+    void* data = size > 0 ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0) : NULL;
+    close(file);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    parse(path, data, size, tuning);
+    if (data)
+    {
+        munmap(data, size);
+    }
+    return true;
+}
+
+#endif // _WIN32
+
+bool tuning_load(const char* path, tuning_t* tuning, tuning_stamp_t* stamp)
+{
+    assert(path && tuning);
+
+    // The stamp is taken first, a write during the parsing is seen by the next `tuning_changed`.
+    tuning_stamp_t new_stamp = {0};
+    stat_file(path, &new_stamp);
+
+    tuning_t parsed = *tuning;
+    if (!read_file(path, &parsed))
+    {
+        fprintf(stderr, "Couldn't read the tuning file '%s'.\n", path);
+        return false;
+    }
+
+    if (stamp)
+    {
+        *stamp = new_stamp;
+    }
+
+    if (!valid(path, &parsed))
+    {
+        return false;
+    }
+
+    *tuning = parsed;
+    return true;
+}
+
+bool tuning_changed(const char* path, tuning_stamp_t stamp)
+{
+    assert(path);
+
+    tuning_stamp_t current;
+    return stat_file(path, &current) && (current.size != stamp.size || current.mtime != stamp.mtime);
+}
@@ -0,0 +1,109 @@
+// Offline converter of the BMP images to QOI, see `qoi.h`.
+//
+// Each `<name>.bmp` given on the command line is written next to it as `<name>.qoi`, which the
+// game then loads instead (see `load_image`). Images are stored with an alpha channel only when
+// one of their pixels isn't opaque.
+
+#include "allocator.h"
+#include "qoi.h"
+
+#include <SDL2/SDL.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+enum { MAX_PATH_LENGTH = 512 };
+
+static bool opaque(const SDL_Surface* surface)
+{
+    for (int y = 0; y < surface->h; ++y)
+    {
+        const uint32_t* row = (const uint32_t*)((const uint8_t*)surface->pixels + y * surface->pitch);
+        for (int x = 0; x < surface->w; ++x)
+        {
+            if (row[x] >> 24 != 0xff)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool convert(const char* source)
+{
+    const size_t length = strlen(source);
+    if (length < 4 || length >= MAX_PATH_LENGTH || strcmp(source + length - 4, ".bmp") != 0)
+    {
+        fprintf(stderr, "'%s' isn't a BMP.\n", source);
+        return false;
+    }
+
+    char destination[MAX_PATH_LENGTH];
+    memcpy(destination, source, length - 4);
+    memcpy(destination + length - 4, ".qoi", 5);
+
+    SDL_Surface* loaded = SDL_LoadBMP(source);
+    SDL_Surface* surface = loaded ? SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0) : NULL;
+    SDL_FreeSurface(loaded);
+    if (!surface)
+    {
+        fprintf(stderr, "Couldn't load '%s': %s\n", source, SDL_GetError());
+        return false;
+    }
+
+    const qoi_desc_t desc = {
+        .width = (uint32_t)surface->w,
+        .height = (uint32_t)surface->h,
+        .channels = opaque(surface) ? 3 : 4,
+        .colorspace = 0,
+    };
+
+    size_t size = 0;
+    void* data = qoi_encode(surface->pixels, (uint32_t)surface->pitch, desc, &size);
+    SDL_FreeSurface(surface);
+
+    FILE* file = fopen(destination, "wb");
+    const bool written = file && fwrite(data, size, 1, file) == 1;
+    if (file)
+    {
+        fclose(file);
+    }
+    mem_free(data);
+
+    if (!written)
+    {
+        fprintf(stderr, "Couldn't write '%s'.\n", destination);
+        remove(destination);
+        return false;
+    }
+
+    SDL_RWops* rw = SDL_RWFromFile(source, "rb");
+    const Sint64 source_size = rw ? SDL_RWsize(rw) : 0;
+    if (rw)
+    {
+        SDL_RWclose(rw);
+    }
+
+    printf("%s: %lld -> %zu bytes (%.1f%%)\n", destination, (long long)source_size, size,
+        source_size > 0 ? 100.0 * (double)size / (double)source_size : 0.0);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <image.bmp>...\n", argv[0]);
+        return 1;
+    }
+
+    bool converted = true;
+    for (int i = 1; i < argc; ++i)
+    {
+        converted &= convert(argv[i]);
+    }
+
+    return converted ? 0 : 1;
+}